@@ -15,14 +15,19 @@ list(APPEND YOURGAME_SRC_FILES
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/init.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/lightsource.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/loading.cpp
+  ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/meshdata.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/particles.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/shader.cpp
+  ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/shadervariants.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/shape.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/spritegrid.cpp
+  ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/streambuffer.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/texture.cpp
+  ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/gl/texturedata.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/math/camera.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/math/particles.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/math/trafo.cpp
+  ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/util/assetloader.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/util/assets.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/util/image.cpp
   ${CMAKE_CURRENT_SOURCE_DIR}/src/toolbox/util/motion.cpp
@@ -32,36 +32,33 @@ namespace mygame
             g_assets.insert("licenseStr", licStr);
         }
 
-        g_assets.insert("geoCube", yg::gl::loadGeometry("a//yg_cube_outside.obj"));
-        g_assets.insert("geoGrid", yg::gl::loadGeometry("a//yg_grid.obj"));
-        g_assets.insert("geoCross", yg::gl::loadGeometry("a//yg_cross.obj"));
-        g_assets.insert("geoBlaster", yg::gl::loadGeometry("a//blasterD.obj", "a//blasterD.mtl"));
+        // geometries, shaders and textures are read and decoded in parallel
+        {
+            yg::util::AssetLoader loader(g_assets);
+            loader.addGeometry("geoCube", "a//yg_cube_outside.obj");
+            loader.addGeometry("geoGrid", "a//yg_grid.obj");
+            loader.addGeometry("geoCross", "a//yg_cross.obj");
+            loader.addGeometry("geoBlaster", "a//blasterD.obj", "a//blasterD.mtl");
 
-        g_assets.insert("shaderDiffuseColor", yg::gl::loadShader({{GL_VERTEX_SHADER, "a//yg_default.vert"},
-                                                                  {GL_FRAGMENT_SHADER, "a//yg_diffusecolor.frag"}}));
+            loader.addShader("shaderDiffuseColor", {{GL_VERTEX_SHADER, "a//yg_default.vert"},
+                                                    {GL_FRAGMENT_SHADER, "a//yg_diffusecolor.frag"}});
 
-        g_assets.insert("shaderSimpleColor", yg::gl::loadShader({{GL_VERTEX_SHADER, "a//yg_default.vert"},
-                                                                 {GL_FRAGMENT_SHADER, "a//yg_simplecolor.frag"}}));
+            loader.addShader("shaderSimpleColor", {{GL_VERTEX_SHADER, "a//yg_default.vert"},
+                                                   {GL_FRAGMENT_SHADER, "a//yg_simplecolor.frag"}});
 
-        g_assets.insert("shaderDiffuseTex", yg::gl::loadShader({{GL_VERTEX_SHADER, "a//default_instanced.vert"},
-                                                                {GL_FRAGMENT_SHADER, "a//yg_diffusetex.frag"}}));
+            loader.addShader("shaderDiffuseTex", {{GL_VERTEX_SHADER, "a//default_instanced.vert"},
+                                                  {GL_FRAGMENT_SHADER, "a//yg_diffusetex.frag"}});
 
-        {
             yg::gl::TextureConfig cfg;
             cfg.minMagFilter = GL_NEAREST;
-            g_assets.insert("texCube", yg::gl::loadTexture("a//cube.png", "", cfg));
+            loader.addTexture("texCube", "a//cube.png", "", cfg);
+
+            loader.wait();
         }
 
-        // for instanced drawing of the cube, add and configure a buffer for per-cube (per draw instance) matrixes:
-        GLsizei vec4Size = static_cast<GLsizei>(sizeof(glm::vec4));
-        g_assets.get<yg::gl::Geometry>("geoCube")->addBuffer("instModelMat", GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-        g_assets.get<yg::gl::Geometry>("geoCube")
-            ->addBufferToShape("main",
-                               {{yg::gl::attrLocInstModelMatCol0, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)0, 1},
-                                {yg::gl::attrLocInstModelMatCol1, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(vec4Size), 1},
-                                {yg::gl::attrLocInstModelMatCol2, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(2 * vec4Size), 1},
-                                {yg::gl::attrLocInstModelMatCol3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(3 * vec4Size), 1}},
-                               "instModelMat");
+        // for instanced drawing of the cube, add a buffer for per-cube (per draw instance) matrixes
+        // (streamed every frame, the attribute pointers are set when drawing)
+        g_assets.get<yg::gl::Geometry>("geoCube")->addStreamBuffer("instModelMat", GL_ARRAY_BUFFER, 64 * 1024);
 
         glClearColor(0.275f, 0.275f, 0.275f, 1.0f);
         glEnable(GL_DEPTH_TEST);
@@ -257,13 +254,29 @@ namespace mygame
             }
 
             auto geoCube = g_assets.get<yg::gl::Geometry>("geoCube");
-            geoCube->bufferData("instModelMat", trafos.size() * sizeof(trafos[0]), trafos.data());
-            yg::gl::DrawConfig cfg;
-            cfg.shader = shdrTex;
-            cfg.textures = {g_assets.get<yg::gl::Texture>("texCube")};
-            cfg.camera = &g_camera;
-            cfg.instancecount = bodies.size();
-            yg::gl::drawGeo(geoCube, cfg);
+            auto instStream = geoCube->getStreamBuffer("instModelMat");
+            GLsizeiptr trafosSize = trafos.size() * sizeof(trafos[0]);
+            if (instStream && !trafos.empty())
+            {
+                instStream->nextFrame();
+                GLintptr instOffset = instStream->reserve(trafosSize) ? instStream->upload(trafos.data(), trafosSize) : -1;
+                if (instOffset >= 0)
+                {
+                    GLsizei vec4Size = static_cast<GLsizei>(sizeof(glm::vec4));
+                    geoCube->addBufferToShape("main",
+                                              {{yg::gl::attrLocInstModelMatCol0, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(instOffset), 1},
+                                               {yg::gl::attrLocInstModelMatCol1, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(instOffset + vec4Size), 1},
+                                               {yg::gl::attrLocInstModelMatCol2, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(instOffset + 2 * vec4Size), 1},
+                                               {yg::gl::attrLocInstModelMatCol3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(instOffset + 3 * vec4Size), 1}},
+                                              "instModelMat");
+                    yg::gl::DrawConfig cfg;
+                    cfg.shader = shdrTex;
+                    cfg.textures = {g_assets.get<yg::gl::Texture>("texCube")};
+                    cfg.camera = &g_camera;
+                    cfg.instancecount = bodies.size();
+                    yg::gl::drawGeo(geoCube, cfg);
+                }
+            }
         }
 
         // draw blaster
@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_ASSETID_H
+#define YOURGAME_ASSETID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace yourgame
+{
+    /**
+    \brief hashed name (64 bit FNV-1a) of an asset, a file, a sprite etc., to be used as a cheap lookup key
+
+    - at compile time, from string literals: <code>AssetId("ship")</code> or <code>"ship"_id</code>
+    - at run time, from strings: <code>AssetId(std::string("ship"))</code>
+    - AssetId("ship") == "ship"_id == AssetId(std::string("ship"))
+
+    functions taking an AssetId (yourgame::util::AssetManager, yourgame::gl::Texture, ...)
+    accept strings and string literals as well. in debug builds (NDEBUG not defined), the names
+    of ids created from strings at run time are recorded, see name()
+    */
+    class AssetId
+    {
+    public:
+        constexpr AssetId() : m_hash(0) {}
+
+        /** \brief from a (zero-terminated) string. constexpr for string literals */
+        constexpr AssetId(const char *name) : m_hash(hashZeroTerminated(name, FNV_OFFSET)) {}
+
+        /** \brief from a string, at run time. records the name in debug builds */
+        AssetId(const std::string &name);
+
+        /** \brief from a hash value, see value() */
+        static constexpr AssetId fromValue(uint64_t value) { return AssetId(value, 0); }
+
+        /** \brief hash of the name of numBytes bytes. same result as AssetId(name) */
+        static constexpr uint64_t hash(const char *name, size_t numBytes)
+        {
+            return hashBytes(name, numBytes, FNV_OFFSET);
+        }
+
+        constexpr uint64_t value() const { return m_hash; }
+
+        constexpr bool operator==(const AssetId &other) const { return m_hash == other.m_hash; }
+        constexpr bool operator!=(const AssetId &other) const { return m_hash != other.m_hash; }
+        constexpr bool operator<(const AssetId &other) const { return m_hash < other.m_hash; }
+
+        /**
+        \brief returns the name of the id, if it was recorded (see above), the hash value
+        as hexadecimal string (like "#a430d84680aabd0b") otherwise
+        */
+        std::string name() const;
+
+    private:
+        static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+        static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        constexpr AssetId(uint64_t value, int) : m_hash(value) {}
+
+        // recursive, to be constexpr in C++11
+        static constexpr uint64_t hashZeroTerminated(const char *name, uint64_t h)
+        {
+            return (*name == '\0') ? h : hashZeroTerminated(name + 1, (h ^ static_cast<uint8_t>(*name)) * FNV_PRIME);
+        }
+
+        static constexpr uint64_t hashBytes(const char *name, size_t numBytes, uint64_t h)
+        {
+            return (numBytes == 0) ? h : hashBytes(name + 1, numBytes - 1, (h ^ static_cast<uint8_t>(*name)) * FNV_PRIME);
+        }
+
+        uint64_t m_hash;
+    };
+
+    inline namespace literals
+    {
+        /** \brief compile-time AssetId: <code>"ship"_id</code> */
+        constexpr AssetId operator"" _id(const char *name, size_t numBytes)
+        {
+            return AssetId::fromValue(AssetId::hash(name, numBytes));
+        }
+    } // namespace literals
+} // namespace yourgame
+
+namespace std
+{
+    template <>
+    struct hash<yourgame::AssetId>
+    {
+        size_t operator()(const yourgame::AssetId &id) const
+        {
+            // the id is a hash already
+            return static_cast<size_t>(id.value());
+        }
+    };
+} // namespace std
+
+#endif
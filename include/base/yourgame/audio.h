@@ -56,6 +56,17 @@ namespace yourgame
          */
         int play(const std::string &filename, bool loop = false);
 
+        /**
+        \brief play audio file, streamed (and decoded) from the file while playing,
+        see yourgame::file::Stream. does not require storeFile(). intended for large files (music).
+        the file is decoded ahead (about one second) on worker threads, not on the audio thread
+
+        \param filename
+        \param loop
+        \return int audio source id
+         */
+        int playStream(const std::string &filename, bool loop = false);
+
         /**
         \brief stop audio source
 
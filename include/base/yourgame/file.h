@@ -21,6 +21,8 @@ freely, subject to the following restrictions:
 #define YOURGAME_FILE_H
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +30,121 @@ namespace yourgame
 {
     namespace file
     {
+        /** \brief counters of accesses to the project archive (see setProjectPath())
+        - opens: number of times an archive was opened and indexed
+        - lookups: number of entry lookups (one per file read from an archive)
+        - misses: number of lookups of entries not present in the archive
+        */
+        struct ArchiveStats
+        {
+            uint64_t opens = 0;
+            uint64_t lookups = 0;
+            uint64_t misses = 0;
+        };
+
+        /** \brief counters of asynchronous writes (see writeFileAsync())
+        - pending: number of files queued or being written (queue depth)
+        - written: number of files written successfully
+        - failed: number of files that failed to write
+        - coalesced: number of writes superseded by a later write of the same file, before being started
+        - lastLatency, maxLatency, meanLatency: seconds from request until the file is written
+        */
+        struct WriteStats
+        {
+            size_t pending = 0;
+            uint64_t written = 0;
+            uint64_t failed = 0;
+            uint64_t coalesced = 0;
+            double lastLatency = 0.0;
+            double maxLatency = 0.0;
+            double meanLatency = 0.0;
+        };
+
+        /** \brief read-only view of the content of an entire file, see mapFile().
+        the content is either mapped into memory (released on destruction), or owned by the view.
+        FileView can be moved, but not copied. */
+        class FileView
+        {
+        public:
+            FileView() {}
+
+            /** \brief view of numBytes bytes at data. release is called on destruction */
+            FileView(const uint8_t *data, size_t numBytes, std::function<void()> release);
+
+            /** \brief view that owns buffer */
+            explicit FileView(std::vector<uint8_t> &&buffer);
+
+            ~FileView();
+
+            FileView(FileView &&other);
+            FileView &operator=(FileView &&other);
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying of the object. */
+            FileView(FileView const &) = delete;
+            FileView &operator=(FileView const &) = delete;
+
+            const uint8_t *data() const;
+
+            size_t size() const;
+
+            bool empty() const;
+
+        private:
+            void release();
+            const uint8_t *m_data = nullptr;
+            size_t m_size = 0;
+            std::vector<uint8_t> m_buffer;
+            std::function<void()> m_release;
+        };
+
+        /** \brief sequential reader of a file, reading it in chunks instead of as a whole.
+        see Stream::open() for the supported files. peak memory is bounded by the
+        chunk size of the caller (and a small internal buffer), not by the file size */
+        class Stream
+        {
+        public:
+            /** \brief opens a stream of filename (\c a//, \c p// prefixes, see readFile()).
+            archive and bundle entries are decompressed incrementally. returns nullptr on failure */
+            static Stream *open(const std::string &filename);
+
+            virtual ~Stream() {}
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying of the object. */
+            Stream(Stream const &) = delete;
+            Stream &operator=(Stream const &) = delete;
+
+            /** \brief reads up to numBytes bytes to dst, returns the number of bytes read.
+            less than numBytes are returned at the end of the file or on error */
+            virtual size_t read(void *dst, size_t numBytes) = 0;
+
+            /** \brief sets the read position to pos (from the beginning).
+            seeking backwards in archive entries restarts decompression of the entry */
+            virtual int seek(uint64_t pos) = 0;
+
+            /** \brief current read position */
+            virtual uint64_t tell() const = 0;
+
+            /** \brief size of the (uncompressed) file */
+            virtual uint64_t size() const = 0;
+
+            bool eof() const;
+
+        protected:
+            Stream() {}
+        };
+
+        /** \brief state and result of an asynchronous file read, see readFileAsync().
+        result (see readFile()) and data are valid, as soon as done is true */
+        struct AsyncRead
+        {
+            std::string filename;
+            int result = -1;
+            std::vector<uint8_t> data;
+            bool done = false;
+        };
+
         /** \brief reads an entire file and returns it as a vector of bytes
         - prepend \c a// to load a file from asset file location
         - prepend \c p// to load a file from project file location
@@ -44,8 +161,51 @@ namespace yourgame
         /** \brief reads an entire file (from project file location) and returns it as a vector of bytes */
         int readProjectFile(const std::string &filename, std::vector<uint8_t> &dst);
 
+        /** \brief reads multiple entire files at once. accepts prefixes like readFile() does.
+        entries of a project archive are looked up at once and decompressed in parallel,
+        other files are read in parallel. dst receives the file contents in input order.
+        optionally, results receives the return value (see readFile()) per file.
+        returns the number of files that failed to read (0: all files read successfully).
+        blocks until all files are read, the calling thread reads files as well. so it can be called from
+        worker jobs (like AssetLoader work stages). on the main thread, it stalls the frame meanwhile */
+        int readFiles(const std::vector<std::string> &filenames,
+                      std::vector<std::vector<uint8_t>> &dst,
+                      std::vector<int> *results = nullptr);
+
+        /** \brief provides the entire content of a file as a read-only view, without copying it, if possible.
+        plain files and stored bundle entries are memory-mapped (if supported by the platform),
+        files from archives are extracted into a buffer owned by the view. accepts prefixes like readFile() does. */
+        int mapFile(const std::string &filename, FileView &dst);
+
+        /** \brief provides the entire content of a file (from asset file location) as a read-only view */
+        int mapAssetFile(const std::string &filename, FileView &dst);
+
+        /** \brief provides the entire content of a file (from project file location) as a read-only view */
+        int mapProjectFile(const std::string &filename, FileView &dst);
+
+        /** \brief reads an entire file asynchronously, on a worker thread. accepts prefixes like readFile() does.
+        - callback is called on the main thread, before mygame::tick(). GL objects can safely be created there
+        - reads with higher priority are started first, reads with equal priority in request order
+        - at most setAsyncReadLimit() reads are in flight (reading, or waiting for delivery), further reads are queued
+        - the returned handle can be polled (AsyncRead::done) instead of using a callback
+        \attention call from the main thread only. do not change the project path while reads are pending */
+        std::shared_ptr<AsyncRead> readFileAsync(const std::string &filename,
+                                                 std::function<void(AsyncRead &)> callback = nullptr,
+                                                 int priority = 0);
+
+        /** \brief sets the maximum number of asynchronous reads in flight (default: 16) */
+        void setAsyncReadLimit(size_t maxInFlight);
+
+        /** \brief returns the number of asynchronous reads that are queued or in flight */
+        size_t getNumAsyncReadsPending();
+
+        /** \brief blocks until all asynchronous reads are done and their callbacks are called.
+        runs the callbacks of asynchronous reads and writes only, not other functions queued for the main thread */
+        void waitAsyncReads();
+
         /** \brief writes numBytes bytes from data to a file called filename, destination path determined
-        by prefix ("a//", etc.), see readFile(). overwrites the file if it exists.
+        by prefix ("a//", etc.), see readFile(). overwrites the file if it exists. the data is written to a
+        temporary file first, which replaces the file on success (the file is never partially written).
         \attention filename requires a prefix, such as "a//". otherwise, writing is omitted. */
         int writeFile(const std::string &filename, const void *data, size_t numBytes);
 
@@ -57,9 +217,59 @@ namespace yourgame
         overwrites the file if it exists */
         int writeProjectFile(const std::string &filename, const void *data, size_t numBytes);
 
-        /** \brief sets path as current project directory */
+        /** \brief writes a file asynchronously (write-behind), on a worker thread, like writeFile() does.
+        takes ownership of data
+        - repeated writes of the same file, which are not started yet, are coalesced: only the latest data is written
+        - callback (optional) receives the result (see writeFile()), on the main thread, before mygame::tick()
+        - pending writes are finished on shutdown, after mygame::shutdown(), without calling their callbacks.
+          call flushWrites() in mygame::shutdown() to have them called */
+        void writeFileAsync(const std::string &filename,
+                            std::vector<uint8_t> &&data,
+                            std::function<void(int)> callback = nullptr);
+
+        /** \brief writes a file asynchronously, see above. copies numBytes bytes from data */
+        void writeFileAsync(const std::string &filename,
+                            const void *data,
+                            size_t numBytes,
+                            std::function<void(int)> callback = nullptr);
+
+        /** \brief blocks until all asynchronous writes are done and their callbacks are called.
+        runs the callbacks of asynchronous reads and writes only, not other functions queued for the main thread */
+        void flushWrites();
+
+        /** \brief a file to be written to a bundle, see writeBundle() */
+        struct BundleFile
+        {
+            std::string name;     // name of the file in the bundle
+            std::string source;   // file to read the data from, see readFile()
+            bool deflate = false; // false: stored (mapped without copying on access)
+        };
+
+        /** \brief writes a bundle (.ygb): an alternative to archives (.zip), with a hashed table of contents,
+        which is used in place when the bundle is opened. stored files are page-aligned, and mapped
+        without decompression or copying (see mapFile()). deflated files are kept stored, if deflating
+        does not save space. names are case-insensitive and must be unique
+        - example: <code>writeBundle("project.ygb", {{"level1.json", "p//level1.json"}, {"music.ogg", "p//music.ogg"}});</code>
+        */
+        int writeBundle(const std::string &bundlePath, const std::vector<BundleFile> &files);
+
+        /** \brief sets path as current project directory. if path points to an archive
+        (.zip) or a bundle (.ygb, see writeBundle()), it is opened and indexed once, and kept
+        open until the project path changes. overlays mounted to p// (see mount()) are kept */
         void setProjectPath(const std::string &path);
 
+        /** \brief mounts a directory, an archive (.zip) or a bundle (.ygb) as an overlay of a file location (\c a// or \c p//).
+        files are looked up in the overlay mounted last first, then in the other overlays, and finally in the
+        base location (asset directory, project path). example: base assets + DLC + patch:
+        <code>mount("dlc1.zip", "a//"); mount("patch1/", "a//");</code>
+        - the result of the look-up is cached per file, until the mounts of the location change
+        - on platform web, directory overlays take precedence unconditionally, as files can not be checked remotely
+        */
+        int mount(const std::string &path, const std::string &location = "p//");
+
+        /** \brief removes an overlay, that was mounted via mount() */
+        int unmount(const std::string &path, const std::string &location = "p//");
+
         /** \brief returns the full (absolut) path to the executable (base), extended by pathRelative */
         std::string getBasePath(const std::string &pathRelative = "");
 
@@ -103,9 +313,26 @@ namespace yourgame
         */
         std::string getFileExtension(const std::string &filepath);
 
-        /** \brief returns list of directory content. accepts prefixes like readFile() does. accepts wildcard "*" for
-        files (after last / in pattern) */
-        std::vector<std::string> ls(const std::string &pattern);
+        /** \brief returns list of directory content. accepts prefixes like readFile() does. accepts wildcards "*" and "?"
+        for files (after last / in pattern). directories are listed with a trailing "/"
+        - with prefixes, the content of all mounts of the location is listed, including archives and bundles (see mount())
+        - recursive: content of subdirectories is included, as paths relative to the directory
+        - directories are read once, and again only if changed (inotify on linux, modification time otherwise)
+        - example: <code>ls("a//levels/" "*.json")</code> lists the json files in directory levels of the assets
+        */
+        std::vector<std::string> ls(const std::string &pattern, bool recursive = false);
+
+        /** \brief returns the project archive access counters */
+        ArchiveStats getArchiveStats();
+
+        /** \brief resets the project archive access counters to zero */
+        void resetArchiveStats();
+
+        /** \brief returns the asynchronous write counters (see writeFileAsync()) */
+        WriteStats getWriteStats();
+
+        /** \brief resets the asynchronous write counters to zero (except pending) */
+        void resetWriteStats();
     } // namespace file
 } // namespace yourgame
 
@@ -24,6 +24,7 @@ freely, subject to the following restrictions:
 #include "yourgame/gl_include.h"
 
 // the following includes are part of the yourgame (base) API
+#include "yourgame/assetid.h"
 #include "yourgame/audio.h"
 #include "yourgame/control.h"
 #include "yourgame/file.h"
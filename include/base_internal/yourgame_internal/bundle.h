@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_INTERNAL_BUNDLE_H
+#define YOURGAME_INTERNAL_BUNDLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "yourgame/file.h"
+
+namespace yourgame_internal
+{
+    namespace file
+    {
+        struct BundleEntry; // toc entry, see bundle.cpp
+
+        /** a bundle (.ygb), see yourgame::file::writeBundle(). the bundle file is mapped as a whole
+        (see mapFileFromPath()), and its table of contents is used in place, so opening is cheap,
+        independent of the number of entries. stored entries are page-aligned and handed out as
+        views into the mapping, deflated entries are decompressed on access */
+        class Bundle
+        {
+        public:
+            /** returns nullptr on failure */
+            static Bundle *open(const std::string &path);
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying of the object. */
+            Bundle(Bundle const &) = delete;
+            Bundle &operator=(Bundle const &) = delete;
+
+            bool contains(const std::string &filename) const;
+
+            int read(const std::string &filename, std::vector<uint8_t> &dst) const;
+
+            /** views of stored entries keep the mapping alive, even if the bundle is closed meanwhile */
+            int map(const std::string &filename, yourgame::file::FileView &dst) const;
+
+            /** view of the data of an entry as stored in the bundle, for incremental decompression of
+            deflated (raw) entries. size and crc32 are of the uncompressed data. keeps the mapping alive */
+            int mapStored(const std::string &filename, yourgame::file::FileView &dst,
+                          bool &deflated, uint64_t &size, uint32_t &crc32) const;
+
+            size_t getNumEntries() const;
+
+            /** names of all entries */
+            std::vector<std::string> getNames() const;
+
+        private:
+            Bundle() {}
+            const BundleEntry *find(const std::string &filename) const; // nullptr: not found
+            std::shared_ptr<yourgame::file::FileView> m_file;
+            const BundleEntry *m_entries = nullptr;
+            const uint32_t *m_buckets = nullptr;
+            const char *m_names = nullptr;
+            uint32_t m_numEntries = 0;
+            uint32_t m_numBuckets = 0;
+            uint64_t m_namesSize = 0;
+        };
+    } // namespace file
+} // namespace yourgame_internal
+
+#endif
@@ -21,18 +21,78 @@ freely, subject to the following restrictions:
 #define YOURGAME_INTERNAL_FILE_H
 
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include "yourgame/file.h"
 
 namespace yourgame_internal
 {
     namespace file
     {
         const std::string ARCHIVE_FILE_EXTENSION = "zip";
+        const std::string BUNDLE_FILE_EXTENSION = "ygb";
+
+        /** kinds of mounts, providing the files of a location (a//, p//)
+        - DIRECTORY: directory in the file system
+        - ARCHIVE: archive (.zip), opened and indexed once
+        - BUNDLE: bundle (.ygb), mapped once, see Bundle
+        - PLATFORM: platform specific file access (android assets, downloads on web), see readFileFromPlatform() */
+        enum class MountType
+        {
+            DIRECTORY,
+            ARCHIVE,
+            BUNDLE,
+            PLATFORM
+        };
+
+        /** sets the base mount of a location ('a', 'p'). overlays (see yourgame::file::mount()) are kept */
+        int setBaseMount(char location, const std::string &path, MountType type);
+
+        /** releases all mounts (and closes all archives) */
+        void unmountAll();
 
         int readFileFromPath(const std::string &filepath, std::vector<uint8_t> &dst);
 
-        int readFileFromArchive(const std::string &archivepath, const std::string &filename, std::vector<uint8_t> &dst);
+        /** memory-maps the file at filepath (read-only). falls back to reading the file into
+        a buffer owned by dst, if memory-mapping is not supported by the platform */
+        int mapFileFromPath(const std::string &filepath, yourgame::file::FileView &dst);
+
+        /** reads a file via platform specific file access. implemented per platform */
+        int readFileFromPlatform(const std::string &filepath, std::vector<uint8_t> &dst);
+
+        /** maps a file via platform specific file access. implemented per platform */
+        int mapFileFromPlatform(const std::string &filepath, yourgame::file::FileView &dst);
+
+        /** makes the archive at archivepath available to be opened, and adjusts archivepath
+        if required (on web: downloads the archive). implemented per platform */
+        int fetchArchive(std::string &archivepath);
+
+        /** entry of a directory listing, see yourgame::file::ls() */
+        struct DirEntry
+        {
+            std::string name;
+            char suffix; // '\0': file, '/': directory, '@': link, '*': other
+        };
+
+        /** directory tree of the files of an archive: directory (lower case, with trailing '/', "" for
+        the root) -> sorted entries of the directory. see buildDirTree() */
+        using DirTree = std::unordered_map<std::string, std::vector<DirEntry>>;
+
+        /** matches name against pattern with wildcards "*" (any characters) and "?" (one character) */
+        bool globMatch(const char *pattern, const char *name);
+
+        /** calls fn for all entries (sorted by name) of the directory at path. the entries are taken from a
+        snapshot of the directory, which is refreshed when the directory changes (inotify on linux, modification
+        time otherwise). returns false, if the directory can not be read. \attention fn must not call forEachDirEntry() */
+        bool forEachDirEntry(const std::string &path, const std::function<void(const DirEntry &)> &fn);
+
+        /** releases all directory snapshots (and stops watching the directories) */
+        void clearDirIndex();
+
+        /** builds the directory tree of filenames (paths, separated by '/') */
+        void buildDirTree(const std::vector<std::string> &filenames, DirTree &dst);
 
         int writeFileToPath(const std::string &filepath, const void *data, size_t numBytes);
 
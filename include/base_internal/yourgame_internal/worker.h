@@ -0,0 +1,64 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_INTERNAL_WORKER_H
+#define YOURGAME_INTERNAL_WORKER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace yourgame_internal
+{
+    namespace worker
+    {
+        /** queues job to be run on a worker thread. jobs with higher priority are started first,
+        jobs with equal priority in the order they were posted. worker threads are started on first use.
+        on platforms without threads, jobs are run on the main thread, in tick(). */
+        void post(std::function<void()> job, int priority = 0);
+
+        /** runs all jobs on the worker threads and the calling thread, and blocks until all of them
+        are finished. as the calling thread runs jobs itself, it can be called from within worker jobs.
+        on platforms without threads, the jobs are run on the calling thread. */
+        void runAndWait(std::vector<std::function<void()>> &jobs, int priority = 0);
+
+        /** queues fn to be run on the main thread, in the next call of tick().
+        can be called from any thread. */
+        void postToMain(std::function<void()> fn);
+
+        /** runs all functions queued via postToMain(). called by the main loop, before mygame::tick() */
+        void tick();
+
+        /** blocks until functions are queued for the main thread (or a short timeout expires),
+        without running them. on platforms without threads, runs one pending job instead */
+        void waitForMain();
+
+        /** blocks until all posted jobs are finished */
+        void waitIdle();
+
+        /** returns the number of worker threads (0: jobs run on the main thread) */
+        size_t getNumThreads();
+
+        /** finishes all posted jobs and stops the worker threads.
+        functions queued for the main thread are discarded. */
+        void shutdown();
+    } // namespace worker
+} // namespace yourgame_internal
+
+#endif
@@ -20,6 +20,7 @@ freely, subject to the following restrictions:
 #ifndef YOURGAME_GLBUFFER_H
 #define YOURGAME_GLBUFFER_H
 
+#include <vector>
 #include "yourgame/gl_include.h"
 
 namespace yourgame
@@ -29,12 +30,48 @@ namespace yourgame
         class Buffer
         {
         public:
+            /** \brief creates a buffer of size bytes (size and capacity). in debug builds (NDEBUG
+            not defined), returns nullptr if the GL did not allocate size bytes */
             static Buffer *make(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage);
             ~Buffer();
             void bind();
             void unbindTarget();
+
+            /** \brief replaces the content of the buffer with size bytes, leaves it bound.
+            the storage is only reallocated if size exceeds the capacity, which then grows
+            geometrically (at least doubles). it never shrinks, so resizing back and forth does not
+            reallocate. clears pending dirty ranges. in debug builds, returns false if the GL did not
+            allocate the storage. for data changing every frame, see StreamBuffer */
             bool bufferData(GLsizeiptr size, const GLvoid *data);
 
+            /** \brief updates size bytes at offset (glBufferSubData()), leaves the buffer bound.
+            if the range ends beyond the capacity, the storage grows (keeping the content) and the
+            size of the buffer is extended to the end of the range. returns false on negative
+            arguments or (debug builds) if the GL did not allocate the grown storage */
+            bool bufferSubData(GLintptr offset, GLsizeiptr size, const GLvoid *data);
+
+            /** \brief grows the capacity to at least capacity bytes, keeping the content */
+            bool reserve(GLsizeiptr capacity);
+
+            /** \brief marks size bytes at offset as changed, to be uploaded by uploadDirty().
+            useful for batching many small changes of a CPU-side copy of the buffer */
+            void markDirty(GLintptr offset, GLsizeiptr size);
+
+            /** \brief uploads the dirty ranges (see markDirty()) from data, which is the CPU-side
+            copy of the whole buffer (range [offset, offset+size) is read from data+offset). ranges
+            closer than mergeGap bytes are merged into one glBufferSubData() call. ranges beyond the
+            size of the buffer are clipped. clears the dirty ranges, leaves the buffer bound */
+            bool uploadDirty(const GLvoid *data, GLsizeiptr mergeGap = 256);
+
+            /** \brief returns true if there are dirty ranges to upload */
+            bool isDirty() const { return !m_dirty.empty(); }
+
+            /** \brief returns the number of bytes in use */
+            GLsizeiptr getSize() const { return m_size; }
+
+            /** \brief returns the number of bytes allocated */
+            GLsizeiptr getCapacity() const { return m_capacity; }
+
             /* deleting the copy constructor and the copy assignment operator
             prevents copying (and moving) of the object. */
             Buffer(Buffer const &) = delete;
@@ -42,9 +79,13 @@ namespace yourgame
 
         private:
             Buffer() {}
+            bool allocate(GLsizeiptr capacity, bool keepContent);
             GLenum m_target;
             GLuint m_handle;
             GLenum m_usage;
+            GLsizeiptr m_size;
+            GLsizeiptr m_capacity;
+            std::vector<std::pair<GLintptr, GLsizeiptr>> m_dirty;
         };
     } // namespace gl
 } // namespace yourgame
@@ -40,8 +40,20 @@ namespace yourgame
             std::vector<yourgame::gl::Texture *> textures = {};
             std::array<float, 4> subtex = {0.0f, 1.0f, 0.0f, 1.0f};
             GLsizei instancecount = 1;
+
+            /** \brief level of detail to draw (see Geometry::setShapeLods()). if < 0, it is selected using
+            camera and modelMat: the coarsest level, whose simplification error (see Geometry::setLodErrors())
+            projected to the screen, at the nearest point of the bounds, is below lodMaxScreenError */
+            int lod = 0;
+
+            /** \brief maximum projected simplification error for automatic LOD selection,
+            relative to the viewport height (0.001: ~1 pixel at 1080 pixels) */
+            float lodMaxScreenError = 0.001f;
         };
 
+        /** \brief returns the level of detail of geo to draw with cfg (see DrawConfig::lod) */
+        size_t selectLod(const yourgame::gl::Geometry *geo, const yourgame::gl::DrawConfig &cfg);
+
         void drawGeo(const yourgame::gl::Geometry *geo, const yourgame::gl::DrawConfig &cfg);
 
         std::array<float, 4> drawSprite(yourgame::gl::Texture *texture,
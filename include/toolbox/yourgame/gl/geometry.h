@@ -26,6 +26,7 @@ freely, subject to the following restrictions:
 #include "yourgame/gl_include.h"
 #include "yourgame/gl/buffer.h"
 #include "yourgame/gl/shape.h"
+#include "yourgame/gl/streambuffer.h"
 
 namespace yourgame
 {
@@ -38,6 +39,23 @@ namespace yourgame
             ~Geometry();
             bool addBuffer(std::string name, GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage);
             bool bufferData(std::string name, GLsizeiptr size, const GLvoid *data);
+
+            /** \brief updates a sub-range of buffer name, see Buffer::bufferSubData() */
+            bool bufferSubData(std::string name, GLintptr offset, GLsizeiptr size, const GLvoid *data);
+
+            /** \brief marks a range of buffer name as changed, see Buffer::markDirty() */
+            bool markDirty(std::string name, GLintptr offset, GLsizeiptr size);
+
+            /** \brief uploads the dirty ranges of buffer name from its CPU-side copy data,
+            see Buffer::uploadDirty() */
+            bool uploadDirty(std::string name, const GLvoid *data, GLsizeiptr mergeGap = 256);
+
+            /** \brief adds a StreamBuffer as buffer name, for data uploaded every frame. use it with
+            addBufferToShape(), with the offsets returned by StreamBuffer::upload() as attribute pointers */
+            bool addStreamBuffer(std::string name, GLenum target, GLsizeiptr regionSize, GLuint numRegions = 3);
+
+            /** \return the StreamBuffer name, nullptr if there is none */
+            StreamBuffer *getStreamBuffer(std::string name);
             bool addShape(std::string name,
                           std::vector<Shape::ArrBufferDescr> arDescrs,
                           std::vector<std::string> arBufferNames,
@@ -48,8 +66,31 @@ namespace yourgame
                                   std::string bufferName);
             bool setShapeElArDescr(std::string name,
                                    Shape::ElemArrBufferDescr elArDescr);
-            void drawAll() const;
-            void drawAllInstanced(GLsizei instancecount) const;
+            bool setShapeLods(std::string name, std::vector<Shape::Lod> lods);
+
+            /** \brief sets the simplification error (object space distance) of each level of detail
+            (LOD 0 first, usually 0.0f), used for LOD selection, see DrawConfig::lod */
+            void setLodErrors(std::vector<float> lodErrors) { m_lodErrors = lodErrors; }
+            const std::vector<float> &getLodErrors() const { return m_lodErrors; }
+
+            /** \brief sets the axis-aligned bounds (object space, dequantized positions) of the geometry */
+            void setBounds(const float (&boundsMin)[3], const float (&boundsMax)[3]);
+            const float *getBoundsMin() const { return m_boundsMin; }
+            const float *getBoundsMax() const { return m_boundsMax; }
+
+            /** \brief sets the dequantization of quantized positions (see MeshData::positionOffset,
+            MeshData::positionScale): position = positionOffset + positionScale * attribute.
+            drawGeo() applies it to the model matrix */
+            void setPositionDequantization(const float (&positionOffset)[3], const float (&positionScale)[3]);
+            const float *getPositionOffset() const { return m_positionOffset; }
+            const float *getPositionScale() const { return m_positionScale; }
+
+            /** \return true if the positions are quantized (dequantization is not the identity) */
+            bool hasPositionDequantization() const;
+
+            /** \brief draws level of detail lod of all shapes (the coarsest one, if lod is not available) */
+            void drawAll(size_t lod = 0) const;
+            void drawAllInstanced(GLsizei instancecount, size_t lod = 0) const;
 
             /* deleting the copy constructor and the copy assignment operator
             prevents copying (and moving) of the object. */
@@ -59,7 +100,13 @@ namespace yourgame
         private:
             Geometry() {}
             std::map<std::string, Buffer *> m_buffers;
+            std::map<std::string, StreamBuffer *> m_streamBuffers;
             std::map<std::string, Shape *> m_shapes;
+            std::vector<float> m_lodErrors;
+            float m_boundsMin[3] = {0.0f, 0.0f, 0.0f};
+            float m_boundsMax[3] = {0.0f, 0.0f, 0.0f};
+            float m_positionOffset[3] = {0.0f, 0.0f, 0.0f};
+            float m_positionScale[3] = {1.0f, 1.0f, 1.0f};
         };
     } // namespace gl
 } // namespace yourgame
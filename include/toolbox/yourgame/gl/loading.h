@@ -20,18 +20,46 @@ freely, subject to the following restrictions:
 #ifndef YOURGAME_GLLOADING_H
 #define YOURGAME_GLLOADING_H
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include "yourgame/gl_include.h"
 #include "yourgame/gl/geometry.h"
+#include "yourgame/gl/meshdata.h"
 #include "yourgame/gl/shader.h"
+#include "yourgame/gl/shadervariants.h"
 #include "yourgame/gl/texture.h"
+#include "yourgame/gl/texturedata.h"
 #include "yourgame/gl/conventions.h"
 
 namespace yourgame
 {
     namespace gl
     {
+        /** \brief state and result of an asynchronous geometry load, see loadGeometryAsync().
+        result (see loadMeshData(), -3: makeGeometry() failed) and geometry are valid, as soon as done is true.
+        the geometry is owned by the caller */
+        struct AsyncGeometry
+        {
+            std::string filename;
+            int result = -1;
+            Geometry *geometry = nullptr;
+            bool done = false;
+        };
+
+        /** \brief state and result of an asynchronous texture load, see loadTextureAsync().
+        result (0: success, -1: an image failed to load) is valid, as soon as done is true.
+        texture is valid as soon as done is true (nullptr on failure), or right away if a placeholder was requested
+        (the same texture receives the data then, 2d data only, and is kept on failure). the texture is owned by the caller */
+        struct AsyncTexture
+        {
+            std::string filename;
+            int result = -1;
+            Texture *texture = nullptr;
+            bool done = false;
+        };
+
         struct TextureConfig
         {
             GLenum unit = gl::textureUnitDiffuse;
@@ -42,10 +70,70 @@ namespace yourgame
             std::vector<std::pair<GLenum, GLint>> parameteri = {};
         };
 
+        /**
+        \brief loads a texture from an image file (png, jpg, ... decoded to GL_RGBA8) or from a KTX file
+        (.ktx, version 1), which is uploaded as stored: block-compressed formats (ETC2, S3TC/BC, ...)
+        and all prebuilt mipmap levels. compressed formats not supported by the GL implementation are
+        decompressed on the CPU, if possible (see TextureData::decompress()). KTX data is not flipped
+        nor premultiplied: it is expected bottom row first, with premultiplied alpha, if needed.
+        the atlas file (optional) is a json atlas file or an atlas cache, see loadAtlasData()
+        */
         Texture *loadTexture(const std::string &imgFilename,
                              const std::string &atlasFilename,
                              const yourgame::gl::TextureConfig &cfg);
 
+        /**
+        \brief loads the subtextures of a texture atlas from a json atlas file (Free Texture Packer
+        "array" or "hash", Crunch), or from an atlas cache (.ygatlas, see saveAtlasCache()),
+        which is read without parsing. can be called from any thread
+
+        \param imgFilename the image file of the atlas (Crunch atlas files describe multiple images)
+        \return 0 on success, -1 if the file failed to load, -2 if parsing failed
+        (dst holds the frames read until then)
+        */
+        int loadAtlasData(const std::string &imgFilename,
+                          const std::string &atlasFilename,
+                          AtlasData &dst);
+
+        /**
+        \brief parses a json atlas file and writes the frames and sequences as atlas cache (.ygatlas),
+        to be loaded via loadTexture() or loadAtlasData(), without json parsing
+
+        \return 0 on success, -1 if the atlas file failed to load, -2 if parsing
+        failed, -3 if the cache file failed to write
+        */
+        int saveAtlasCache(const std::string &imgFilename,
+                           const std::string &atlasFilename,
+                           const std::string &cacheFilename);
+
+        /** \brief writes atlas data as atlas cache (.ygatlas). returns 0 on success, -3 if the file failed to write */
+        int saveAtlasData(const AtlasData &atlas, const std::string &cacheFilename);
+
+        /**
+        \brief loads texture data from an image file or a KTX file, like loadTexture() does,
+        but without creating GL objects. can be called from any thread.
+        flipVertically and premultiplyAlpha apply to image files only
+
+        \return 0 on success, -1 if the file failed to load, -2 if decoding/parsing failed
+        */
+        int loadTextureData(const std::string &filename,
+                            TextureData &dst,
+                            bool flipVertically = true,
+                            bool premultiplyAlpha = true);
+
+        /** \brief returns the compressed texture formats supported by the GL implementation
+        (GL_COMPRESSED_TEXTURE_FORMATS), queried once. call from the GL thread only */
+        const std::vector<GLint> &getCompressedTextureFormats();
+
+        /** \brief decompresses data on the CPU (see TextureData::decompress()), if its compressed format is not
+        in supportedFormats (see getCompressedTextureFormats()). can be called from any thread, to keep the
+        decompression off the GL thread before makeTexture(). returns false if decompression failed */
+        bool makeUploadable(TextureData &data, const std::vector<GLint> &supportedFormats);
+
+        /** \brief creates a texture from texture data (see loadTextureData()), decompressing it on the CPU,
+        if the GL implementation does not support its compressed format. call from the GL thread only */
+        Texture *makeTexture(const TextureData &data, const yourgame::gl::TextureConfig &cfg);
+
         /**
         \brief loads images and generates cubemap texture
 
@@ -54,16 +142,140 @@ namespace yourgame
         Texture *loadCubemap(const std::vector<std::string> &filenames,
                              const yourgame::gl::TextureConfig &cfg);
 
+        /**
+        \brief loads a texture asynchronously, like loadTexture(): the image is decoded (and alpha
+        premultiplied), or the KTX file parsed (and decompressed, if needed), and the atlas file parsed on a worker thread.
+        the data is copied into a pixel unpack buffer (mapped on the main thread) by a worker thread, and uploaded
+        from there on the main thread, before mygame::tick()
+        - if placeholder is true, AsyncTexture::texture is available right away, showing a 1x1 mid grey texel
+        until the image is uploaded to the same texture
+        - callback is called on the main thread, after the upload (or failure)
+        - loads with higher priority are started first
+        \attention call from the main thread only
+        */
+        std::shared_ptr<AsyncTexture> loadTextureAsync(const std::string &imgFilename,
+                                                       const std::string &atlasFilename,
+                                                       const yourgame::gl::TextureConfig &cfg,
+                                                       std::function<void(AsyncTexture &)> callback = nullptr,
+                                                       int priority = 0,
+                                                       bool placeholder = false);
+
+        /** \brief loads a cubemap texture asynchronously, like loadCubemap(), decoding the faces
+        in parallel. see loadTextureAsync() */
+        std::shared_ptr<AsyncTexture> loadCubemapAsync(const std::vector<std::string> &filenames,
+                                                       const yourgame::gl::TextureConfig &cfg,
+                                                       std::function<void(AsyncTexture &)> callback = nullptr,
+                                                       int priority = 0,
+                                                       bool placeholder = false);
+
+        /**
+        \brief loads a shader source file, replacing <code>#include "path"</code> (or <code>#include <path></code>)
+        lines by the content of the included file, recursively. path is relative to the directory of the
+        including file, unless it has a prefix (like "a//shaders/common.glsl", see yourgame::file::readFile()).
+        each file is included once per source (include guards are not required, cycles are ignored).
+        can be called from any thread
+
+        \return 0 on success, -1 if the file or an included file failed to load
+        */
+        int loadShaderSource(const std::string &filename, std::string &dst);
+
+        /** \brief loads a shader program from source files (see loadShaderSource()) */
         Shader *loadShader(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
                            const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
                            const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
 
+        /**
+        \brief loads a shader program from source files (see loadShaderSource()), specialized by defines:
+        each define ("NAME" or "NAME=VALUE") is inserted as #define line, after the version line.
+        the program is owned by the caller. to keep several variants of the same sources, use
+        loadShaderVariants() instead, which loads the files once and caches the compiled programs
+        */
+        Shader *loadShaderVariant(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                                  const std::vector<std::string> &defines,
+                                  const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
+                                  const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
+
+        /** \brief loads several shader programs from source files, like loadShader(), but compiles and links
+        them together (see ShaderBatch). returns one program per entry of programs (nullptr on failure) */
+        std::vector<Shader *> loadShaders(const std::vector<std::vector<std::pair<GLenum, std::string>>> &programs);
+
+        /** \brief loads shader source files (see loadShaderSource()), for variants to be compiled on demand,
+        see ShaderVariants::get(). returns nullptr if a file failed to load */
+        ShaderVariants *loadShaderVariants(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                                           const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
+                                           const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
+
+        /** \brief the lines prepended to shader sources by loadShaderFromStrings(): the glsl
+        version line and a #define line per define ("NAME" or "NAME=VALUE") */
+        std::string getShaderPrologue(const std::vector<std::string> &defines = {});
+
+        /** \brief makes a shader program from source strings, prepending the glsl version
+        and a #define line per define (see loadShaderVariant()). includes are not resolved */
         Shader *loadShaderFromStrings(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
                                       const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
-                                      const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
+                                      const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {},
+                                      const std::vector<std::string> &defines = {});
 
+        /**
+        \brief loads geometry from an .obj file (and optional .mtl file), or from a
+        mesh cache (.ygmesh, see saveGeometryCache()), which is mapped and uploaded
+        without parsing (mtlFilename is ignored then)
+
+        the vertex data (position, color, normal and texcoords, if available) is
+        interleaved in buffer "vertices", indices are in buffers "idx" (shape "main",
+        triangles) and "idxLines" (shape "lines")
+
+        processing (optional) reorders triangles and vertices (see MeshData::optimize()) and selects
+        compact vertex and index formats (see MeshData::quantize()). quantized positions (snorm16)
+        need the dequantization of loadMeshData(), use half floats otherwise
+        */
         Geometry *loadGeometry(const std::string &objFilename,
-                               const std::string &mtlFilename = "");
+                               const std::string &mtlFilename = "",
+                               const MeshProcessing &processing = MeshProcessing());
+
+        /**
+        \brief parses an .obj file (and optional .mtl file) and writes the resulting
+        vertex and index data, shape descriptions and bounds as mesh cache (.ygmesh),
+        to be loaded via loadGeometry(). the data is processed as given (see MeshData::process())
+
+        \return 0 on success, -1 if the obj/mtl file failed to load, -2 if parsing
+        failed, -3 if the cache file failed to write
+        */
+        int saveGeometryCache(const std::string &objFilename,
+                              const std::string &mtlFilename,
+                              const std::string &cacheFilename,
+                              const MeshProcessing &processing = MeshProcessing());
+
+        /**
+        \brief loads mesh data from an .obj file (and optional .mtl file) or from a mesh cache (.ygmesh),
+        like loadGeometry() does, but without creating GL objects. can be called from any thread
+
+        \return 0 on success, -1 if the file failed to load, -2 if parsing failed
+        */
+        int loadMeshData(const std::string &filename,
+                         const std::string &mtlFilename,
+                         MeshData &dst);
+
+        /** \brief creates a Geometry from mesh data (see loadMeshData()). call from the GL thread only */
+        Geometry *makeGeometry(const MeshData &meshData);
+
+        /** \brief writes mesh data as mesh cache (.ygmesh). returns 0 on success, -3 if the file failed to write */
+        int saveMeshData(const MeshData &meshData, const std::string &cacheFilename);
+
+        /**
+        \brief loads geometry asynchronously: loadMeshData() runs on a worker thread,
+        makeGeometry() on the main thread, before mygame::tick()
+        - the mesh data is processed on the worker thread, see MeshData::process()
+        - callback is called on the main thread, after the geometry is created (or failed)
+        - loads with higher priority are started first
+        - the returned handle can be polled (AsyncGeometry::done) instead of using a callback
+        \attention call from the main thread only
+        */
+        std::shared_ptr<AsyncGeometry> loadGeometryAsync(const std::string &objFilename,
+                                                         const std::string &mtlFilename = "",
+                                                         std::function<void(AsyncGeometry &)> callback = nullptr,
+                                                         int priority = 0,
+                                                         const MeshProcessing &processing = MeshProcessing());
 
         Geometry *loadGeometryFromStrings(const std::string &objCode,
                                           const std::string &mtlCode = "");
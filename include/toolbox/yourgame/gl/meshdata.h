@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_GLMESHDATA_H
+#define YOURGAME_GLMESHDATA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "yourgame/gl_include.h"
+#include "yourgame/gl/shape.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        /** \brief opt-in compact vertex and index formats, see MeshData::quantize().
+        only attributes at the conventional locations (attrLocPosition ...) of type GL_FLOAT are converted */
+        struct MeshQuantization
+        {
+            enum class Positions
+            {
+                FLOAT,
+                HALF_FLOAT, /**< GL_HALF_FLOAT */
+                SNORM16     /**< normalized GL_SHORT, within the bounds. see MeshData::positionScale */
+            };
+
+            Positions positions = Positions::FLOAT;
+            bool normals = false;   /**< normalized GL_INT_2_10_10_10_REV */
+            bool colors = false;    /**< normalized GL_UNSIGNED_BYTE */
+            bool texcoords = false; /**< GL_HALF_FLOAT */
+            bool indices = false;   /**< GL_UNSIGNED_SHORT, if the number of vertices permits */
+        };
+
+        /** \brief optional reordering of triangles and vertices, see MeshData::optimize() */
+        struct MeshOptimization
+        {
+            bool vertexCache = false;   /**< reorder triangles for the post-transform vertex cache (Forsyth) */
+            bool vertexFetch = false;   /**< reorder vertices in the order of their first use */
+            bool overdraw = false;      /**< sort clusters of triangles (after vertexCache), outward-facing first */
+            unsigned int cacheSize = 32; /**< size of the simulated vertex cache (FIFO) */
+        };
+
+        /** \brief average cache miss ratio (ACMR: transformed vertices per triangle) of the triangle shapes,
+        before and after MeshData::optimize(). 0.5 is ideal for large regular meshes, 3.0 is worst */
+        struct MeshOptimizationStats
+        {
+            size_t numTriangles = 0;
+            float acmrBefore = 0.0f;
+            float acmrAfter = 0.0f;
+        };
+
+        /** \brief generation of levels of detail, see MeshData::generateLods() */
+        struct MeshLodConfig
+        {
+            unsigned int numLods = 0; /**< number of levels of detail to generate (in addition to level 0), at most 7 */
+            float ratio = 0.5f;       /**< target number of triangles of each level, relative to the previous one */
+            float maxError = 0.05f;   /**< maximum simplification error, relative to the radius of the bounds */
+        };
+
+        /** \brief processing steps of the geometry loading pipeline, applied in this order */
+        struct MeshProcessing
+        {
+            MeshOptimization optimization;
+            MeshLodConfig lods;
+            MeshQuantization quantization;
+        };
+
+        /** \brief geometry data in CPU memory: buffers, shape descriptions and bounds.
+        produced by loadMeshData() (on any thread), turned into a Geometry by makeGeometry() (on the GL thread) */
+        struct MeshData
+        {
+            struct BufferData
+            {
+                std::string name;
+                GLenum target;
+                std::vector<uint8_t> data;
+            };
+
+            struct AttribData
+            {
+                size_t buffer;               /**< index of the vertex buffer (see buffers) */
+                Shape::ArrBufferDescr descr; /**< descr.pointer is the byte offset in the buffer */
+            };
+
+            struct ShapeData
+            {
+                std::string name;
+                std::vector<AttribData> attribs;
+                Shape::ElemArrBufferDescr elArDescr;
+                size_t indexBuffer;          /**< index of the index buffer (see buffers) */
+                std::vector<Shape::Lod> lods; /**< levels of detail 1, 2, ... in the index buffer */
+            };
+
+            std::vector<BufferData> buffers;
+            std::vector<ShapeData> shapes;
+            float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+            float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+
+            /** \brief dequantization of positions: position = positionOffset + positionScale * attribute.
+            identity, unless positions are quantized to MeshQuantization::Positions::SNORM16.
+            stored in the Geometry by makeGeometry(), drawGeo() applies it to the model matrix, like
+            <code>modelMat * glm::translate(offset) * glm::scale(scale)</code> */
+            float positionOffset[3] = {0.0f, 0.0f, 0.0f};
+            float positionScale[3] = {1.0f, 1.0f, 1.0f};
+
+            /** \brief simplification error (object space distance) of each level of detail, level 0 first */
+            std::vector<float> lodErrors;
+
+            /** \brief returns the index of the buffer called name, or -1 */
+            int findBuffer(const std::string &name) const;
+
+            /** \brief converts vertex attributes and indices to the formats selected in cfg.
+            the vertex buffers are rewritten (interleaved as before, each attribute 4-byte aligned)
+            and the attribute descriptions of the shapes are updated. returns the number of bytes saved */
+            size_t quantize(const MeshQuantization &cfg);
+
+            /** \brief reorders the triangles of the GL_TRIANGLES shapes and/or the vertices
+            as selected in cfg. call before quantize(), as overdraw sorting needs float positions */
+            MeshOptimizationStats optimize(const MeshOptimization &cfg);
+
+            /** \brief reorders the vertices (of all vertex buffers) in the order of their first use
+            in the index buffers, and updates the indices. returns false if the layout is not supported
+            (vertex buffers of different lengths, instanced attributes) */
+            bool reorderVertices();
+
+            /** \brief generates levels of detail of the GL_TRIANGLES shapes by quadric edge collapse,
+            that only removes vertices, keeping attribute seams and borders. the index lists of each level are
+            appended to the index buffer of the shape (see ShapeData::lods, lodErrors).
+            call after optimize() and before quantize(), as float positions are needed.
+            if vertexCacheSize > 0, each level is reordered for the vertex cache (see MeshOptimization::vertexCache) */
+            void generateLods(const MeshLodConfig &cfg, unsigned int vertexCacheSize = 0);
+
+            /** \brief optimizes (logging the ACMR, if enabled), generates levels of detail and quantizes,
+            see optimize(), generateLods() and quantize() */
+            void process(const MeshProcessing &cfg);
+        };
+    } // namespace gl
+} // namespace yourgame
+
+#endif
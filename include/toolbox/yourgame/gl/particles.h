@@ -35,11 +35,14 @@ namespace yourgame
             ~Particles();
             void tick(float dt) override;
             yourgame::gl::Geometry *geo();
+            /** \brief number of particles to draw (instancecount), 0 if the last tick() failed to
+            upload the instance data */
             GLsizei numParticles();
 
         private:
             Particles(const Config cfg, yourgame::gl::Geometry *geo) : yourgame::math::Particles(cfg), m_geo(geo) {}
             yourgame::gl::Geometry *m_geo;
+            GLsizei m_numUploaded = 0;
         };
     } // namespace gl
 } // namespace yourgame
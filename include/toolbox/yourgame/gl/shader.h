@@ -22,6 +22,8 @@ freely, subject to the following restrictions:
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include "yourgame/gl_include.h"
 #include "yourgame/gl/lightsource.h"
@@ -34,10 +36,32 @@ namespace yourgame
         class Shader
         {
         public:
+            /**
+            \brief creates a program from shaderCodes (pairs of shader type and source), binding
+            attribute and fragment data locations before linking. returns nullptr on failure,
+            compile and link errors are appended to errorLog.
+
+            if the program binary cache is enabled (see setBinaryCacheDir()), the linked program is
+            loaded from the cache instead, if available, and written to it otherwise.
+            */
             static Shader *make(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
                                 const std::vector<std::pair<GLuint, std::string>> &attrLocs,
                                 const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
                                 std::string &errorLog);
+
+            /**
+            \brief enables the on-disk program binary cache of make(), if cacheDir is not empty
+            (disabled by default). cacheDir is a writable directory, ending with a slash and
+            including a prefix (like "p//shadercache/", see yourgame::file::writeFile()). it
+            must exist.
+
+            cache files are keyed by a hash of the shader sources, the location bindings and the
+            gl vendor, renderer and version strings. a changed source or driver results in a new
+            file, a binary rejected by the driver is replaced. without gl support for program
+            binaries (zero binary formats, like in WebGL), the cache is not used.
+            */
+            static void setBinaryCacheDir(const std::string &cacheDir);
+
             ~Shader();
             void useProgram(Lightsource *lightsource = nullptr, yourgame::math::Camera *camera = nullptr);
             GLint getUniformLocation(const GLchar *name);
@@ -48,10 +72,71 @@ namespace yourgame
             Shader &operator=(Shader const &) = delete;
 
         private:
+            friend class ShaderBatch;
+
             Shader() {}
+
+            /* wraps a successfully linked program */
+            static Shader *fromProgram(GLuint progHandle);
+
             GLuint m_programHandle;
             std::map<std::string, GLint> m_uniformLocations;
         };
+
+        /**
+        \brief creates several shader programs at once: all compiles and links are submitted first
+        (see submit()), their status is queried afterwards (see poll()). drivers with a threaded
+        compiler work on the programs in parallel then, instead of one after another.
+
+        programs which are not finished yet are deleted with the batch
+        */
+        class ShaderBatch
+        {
+        public:
+            ShaderBatch() {}
+            ~ShaderBatch();
+
+            /** \brief starts creating a program, like Shader::make() (including its binary cache), without
+            waiting for the result. returns the index of the program in this batch (0, 1, 2, ...) */
+            size_t submit(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                          const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
+                          const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
+
+            /**
+            \brief finishes the pending programs which are complete, and calls ready(index, shader, errorLog)
+            for each of them. shader is owned by the callee (nullptr on failure, see errorLog).
+
+            if the driver reports completion (GL_KHR_parallel_shader_compile), programs still compiling are
+            skipped, unless wait is true. otherwise (or if wait is true), all pending programs are finished,
+            blocking until they are complete. returns the number of programs still pending
+            */
+            size_t poll(const std::function<void(size_t, Shader *, const std::string &)> &ready, bool wait = false);
+
+            /** \brief number of submitted programs not finished by poll() yet */
+            size_t numPending() const { return m_pending.size(); }
+
+            /** \brief true if the driver supports GL_KHR_parallel_shader_compile (or GL_ARB_parallel_shader_compile),
+            and poll() does not block */
+            static bool isParallelCompileSupported();
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying (and moving) of the object. */
+            ShaderBatch(ShaderBatch const &) = delete;
+            ShaderBatch &operator=(ShaderBatch const &) = delete;
+
+        private:
+            struct Pending
+            {
+                size_t index;
+                GLuint progHandle;
+                std::vector<GLuint> shdrHandles;
+                bool useCache; // write the program binary to the cache when finished
+                uint64_t cacheKey;
+            };
+
+            std::vector<Pending> m_pending;
+            size_t m_numSubmitted = 0;
+        };
     } // namespace gl
 } // namespace yourgame
 
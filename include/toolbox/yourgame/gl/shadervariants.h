@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_GLSHADERVARIANTS_H
+#define YOURGAME_GLSHADERVARIANTS_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "yourgame/gl_include.h"
+#include "yourgame/gl/shader.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        /**
+        \brief specialized programs of the same shader sources, compiled on demand (per set of defines)
+        and kept for later requests. features are selected at compile time, instead of branching on
+        uniforms at runtime. see also loadShaderVariants()
+        */
+        class ShaderVariants
+        {
+        public:
+            /** \brief keeps shaderCodes (pairs of shader type and source, without version line)
+            and the location bindings for the variants, see loadShaderFromStrings() */
+            static ShaderVariants *make(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                                        const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
+                                        const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {});
+
+            /**
+            \brief returns the program specialized by defines ("NAME" or "NAME=VALUE", the order does
+            not matter), compiles it on the first request. returns nullptr if it failed to compile
+            (which is not retried). the program is owned by this object
+            */
+            Shader *get(const std::vector<std::string> &defines);
+
+            /** \brief number of variants requested so far (including failed ones) */
+            size_t numVariants() const { return m_variants.size(); }
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying (and moving) of the object. */
+            ShaderVariants(ShaderVariants const &) = delete;
+            ShaderVariants &operator=(ShaderVariants const &) = delete;
+
+        private:
+            ShaderVariants() {}
+            std::vector<std::pair<GLenum, std::string>> m_shaderCodes;
+            std::vector<std::pair<GLuint, std::string>> m_attrLocs;
+            std::vector<std::pair<GLuint, std::string>> m_fragDataLocs;
+            std::map<std::vector<std::string>, std::unique_ptr<Shader>> m_variants;
+        };
+    } // namespace gl
+} // namespace yourgame
+
+#endif
@@ -49,15 +49,31 @@ namespace yourgame
                 GLsizei numElements;
             };
 
+            /** \brief range of elements (in the element array buffer) of a level of detail */
+            struct Lod
+            {
+                GLsizei firstElement;
+                GLsizei numElements;
+            };
+
             static Shape *make(std::vector<ArrBufferDescr> arDescrs,
                                std::vector<Buffer *> arBuffers,
                                ElemArrBufferDescr elArDescr,
                                Buffer *elArBuffer);
             bool setElArDescr(Shape::ElemArrBufferDescr elArDescr);
             bool addArrBuf(ArrBufferDescr arDescr, Buffer *buf);
+
+            /** \brief sets the levels of detail 1, 2, ... (level 0: all elements, see setElArDescr()) */
+            void setLods(std::vector<Lod> lods);
+
+            /** \return number of levels of detail, including level 0 */
+            size_t getNumLods() const { return m_lods.size() + 1; }
+
             ~Shape();
-            void draw();
-            void drawInstanced(GLsizei instancecount);
+
+            /** \brief draws level of detail lod (or the coarsest one, if lod is not available) */
+            void draw(size_t lod = 0);
+            void drawInstanced(GLsizei instancecount, size_t lod = 0);
 
             /* deleting the copy constructor and the copy assignment operator
         prevents copying (and moving) of the object. */
@@ -67,7 +83,10 @@ namespace yourgame
         private:
             Shape() {}
             ElemArrBufferDescr m_elArDescr;
+            std::vector<Lod> m_lods;
             GLuint m_vaoHandle;
+            Lod getLod(size_t lod) const;
+            const GLvoid *getElementOffset(GLsizei firstElement) const;
         };
     } // namespace gl
 } // namespace yourgame
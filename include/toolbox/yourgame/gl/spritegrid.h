@@ -20,9 +20,12 @@ freely, subject to the following restrictions:
 #ifndef YOURGAME_GLSPRITEGRID_H
 #define YOURGAME_GLSPRITEGRID_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include "yourgame/gl/geometry.h"
+#include "yourgame/gl/meshdata.h"
 #include "yourgame/gl/texture.h"
 
 namespace yourgame
@@ -55,19 +58,47 @@ namespace yourgame
             \param width number of tiles per row. if = 0, all tiles in 1 row
             \param gridWidth desired width of entire grid. if <= 0.0f, aspect ratio and gridHeight (if > 0.0f) used
             \param gridHeight desired height of entire grid. if <= 0.0f, aspect ratio and gridWidth (if > 0.0f) used
+            \param quantization vertex and index formats (see MeshData::quantize()). default: GL_FLOAT, GL_UNSIGNED_INT
             \return error (0 on success)
             */
             int make(const yourgame::gl::Texture *atlas,
                      const std::vector<std::string> &tiles,
                      unsigned int width,
                      float gridWidth,
-                     float gridHeight);
+                     float gridHeight,
+                     const MeshQuantization &quantization = MeshQuantization());
+
+            /**
+            \brief changes tiles of the grid, uploading only the texture coordinates of the changed
+            tiles (see Buffer::markDirty()). the grid (positions) is kept as created by make().
+
+            \param atlas atlas, the coordinates are taken from
+            \param tiles pairs of tile index (row-major, as in make()) and name of tile in atlas
+            \return error (0 on success, -1 if the grid was not made, atlas is nullptr or an index
+            is out of range. nothing is changed then)
+            */
+            int setTiles(const yourgame::gl::Texture *atlas,
+                         const std::vector<std::pair<size_t, std::string>> &tiles);
 
             /** \return pointer to geometry object (m_geo) */
             Geometry *geo() const { return m_geo; }
 
+            /** \return dequantization of positions (3 floats), see MeshData::positionOffset.
+            also stored in geo(), drawGeo() applies it */
+            const float *positionOffset() const { return m_positionOffset; }
+
+            /** \return dequantization of positions (3 floats), see MeshData::positionScale.
+            also stored in geo(), drawGeo() applies it */
+            const float *positionScale() const { return m_positionScale; }
+
         private:
             Geometry *m_geo = nullptr;
+            MeshQuantization m_quantization;
+            size_t m_numTiles = 0;
+            std::vector<uint8_t> m_texcoordData; /* CPU-side copy of buffer "texcoords" */
+            Shape::ArrBufferDescr m_texcoordDescr;
+            float m_positionOffset[3] = {0.0f, 0.0f, 0.0f};
+            float m_positionScale[3] = {1.0f, 1.0f, 1.0f};
         };
     } // namespace gl
 } // namespace yourgame
@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_GLSTREAMBUFFER_H
+#define YOURGAME_GLSTREAMBUFFER_H
+
+#include <vector>
+#include "yourgame/gl_include.h"
+#include "yourgame/gl/buffer.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        /**
+        \brief buffer for data uploaded every frame (like instance data), without reallocating
+        the buffer or waiting for the GPU
+
+        the buffer is a ring of numRegions regions (triple buffering by default). the uploads of a
+        frame are placed one after another in the current region, written via unsynchronized
+        mappings. nextFrame() fences the region, the GPU reads from it while the following frames
+        use the other regions. a region is only waited for (the fence), if the GPU is numRegions
+        frames behind.
+
+        upload() returns the offset of the data in the buffer, to be used as attribute pointer
+        (see Shape::ArrBufferDescr, Geometry::addBufferToShape()). use like so, every frame:
+        - nextFrame()
+        - reserve() the space needed this frame (grows the buffer, if required)
+        - upload() the data, set the attribute pointers and draw
+        */
+        class StreamBuffer
+        {
+        public:
+            /** \brief alignment of the offsets returned by upload() */
+            static constexpr GLsizeiptr alignment = 16;
+
+            static StreamBuffer *make(GLenum target, GLsizeiptr regionSize, GLuint numRegions = 3);
+            ~StreamBuffer();
+
+            /** \brief finishes the current region (the commands using its data must be issued already)
+            and continues with the next one. call once per frame, before the uploads of the frame */
+            void nextFrame();
+
+            /**
+            \brief ensures that size bytes fit into the current region (including the alignment of
+            each upload). if they do not, the buffer grows (at least doubling the region size), but
+            only before the first upload of the frame. returns false if size bytes do not fit then
+            */
+            bool reserve(GLsizeiptr size);
+
+            /** \brief copies size bytes of data to the current region. returns the offset of the data
+            in the buffer, -1 if it does not fit the remaining space of the region (see reserve()) or if
+            the mapped data store got corrupted (glUnmapBuffer() failed) */
+            GLintptr upload(const GLvoid *data, GLsizeiptr size);
+
+            /** \brief the buffer, to be passed to Shape::addArrBuf() */
+            Buffer *buffer() { return m_buffer; }
+
+            GLsizeiptr getRegionSize() const { return m_regionSize; }
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying (and moving) of the object. */
+            StreamBuffer(StreamBuffer const &) = delete;
+            StreamBuffer &operator=(StreamBuffer const &) = delete;
+
+        private:
+            StreamBuffer() {}
+            Buffer *m_buffer;
+            GLenum m_target;
+            GLsizeiptr m_regionSize;
+            GLsizeiptr m_regionUsed = 0;
+            GLuint m_region = 0;
+            std::vector<GLsync> m_fences; // per region, nullptr if not in use by the GPU
+        };
+    } // namespace gl
+} // namespace yourgame
+
+#endif
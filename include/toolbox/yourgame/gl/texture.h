@@ -21,8 +21,11 @@ freely, subject to the following restrictions:
 #define YOURGAME_GLTEXTURE_H
 
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "yourgame/assetid.h"
 #include "yourgame/gl_include.h"
 
 namespace yourgame
@@ -65,6 +68,39 @@ namespace yourgame
             bool cwRotated = false;
         };
 
+        /** \brief subtextures (frames) of a texture atlas, with the sequences pre-grouped,
+        see Texture::insertAtlas(), yourgame::gl::loadAtlasData() */
+        struct AtlasData
+        {
+            struct Frame
+            {
+                AssetId id;
+                int x;
+                int y;
+                int width;
+                int height;
+                bool cwRot;
+            };
+
+            struct Sequence
+            {
+                std::string name;
+                AssetId id;
+                std::vector<std::pair<int, uint32_t>> frames; /**< frame index and index into AtlasData::frames, ascending frame index */
+            };
+
+            std::vector<Frame> frames;
+            std::vector<Sequence> sequences;
+            std::unordered_map<AssetId, size_t> sequenceIndex; /**< index into sequences, maintained by addFrame() */
+
+            /** \brief adds a frame, and adds it to a sequence if its name has an index at the end,
+            like Texture::insertCoords() does (zero-size frames are skipped) */
+            void addFrame(const std::string &name, int x, int y, int width, int height, bool cwRot);
+
+            /** \brief sorts the frames of each sequence by frame index. call after the last addFrame() */
+            void sortSequences();
+        };
+
         class Texture
         {
         public:
@@ -81,6 +117,9 @@ namespace yourgame
             void bind() const;
             void unbindTarget() const;
 
+            /** \brief sets a texture parameter (glTexParameteri()), like the parameters of make() */
+            void setParameteri(GLenum pname, GLint param);
+
             void updateData(GLenum target,
                             GLint level,
                             GLint internalformat,
@@ -92,34 +131,51 @@ namespace yourgame
                             const void *data,
                             bool generateMipmap);
 
+            /** \brief uploads block-compressed data (glCompressedTexImage2D()) to level of target */
+            void updateCompressedData(GLenum target,
+                                      GLint level,
+                                      GLenum internalformat,
+                                      GLsizei width,
+                                      GLsizei height,
+                                      GLsizei imageSize,
+                                      const void *data);
+
             GLuint handle() const { return m_handle; }
             GLenum getTarget() const { return m_target; }
             GLsizei getWidth() const { return m_width; }
             GLsizei getHeight() const { return m_height; }
 
-            void insertCoords(std::string name, int x, int y, int width, int height, bool cwRot);
+            /**
+            \brief inserts texture coordinates of a subtexture. names with an index at the end
+            (with - or _, like walking_01 or walking-01) are added to a sequence (walking) as well
+             */
+            void insertCoords(const std::string &name, int x, int y, int width, int height, bool cwRot);
+
+            /** \brief inserts texture coordinates of all subtextures and sequences of atlas,
+            without parsing their names (see insertCoords()) */
+            void insertAtlas(const AtlasData &atlas);
 
             /**
             \brief returns texture coordinates of subtexture with name name
 
-            \param name name of subtexture to return
+            \param name name of subtexture to return (string or AssetId, like <code>"ship"_id</code>)
              */
-            TextureCoords getCoords(std::string name) const;
+            TextureCoords getCoords(AssetId name) const;
 
             /**
             \brief returns texture coordinates of subtexture which is part of a sequence
 
-            \param sequenceName name of the sequence
+            \param sequenceName name of the sequence (string or AssetId)
             \param frame frame index. is always wrapped into valid range. may be negative
              */
-            TextureCoords getFrameCoords(std::string sequenceName, int frame);
+            TextureCoords getFrameCoords(AssetId sequenceName, int frame);
 
             /**
             \brief returns the number of frames of a sequence
 
             \param sequenceName name of the sequence
              */
-            int getNumFrames(std::string sequenceName) const;
+            int getNumFrames(AssetId sequenceName) const;
 
             /**
             \brief returns a list of the names of all sequences
@@ -150,8 +206,9 @@ namespace yourgame
                 std::vector<TextureCoords> framesConsec; /**< \brief consecutive representation of the frame coordinates */
             };
 
-            std::map<std::string, TextureCoords> m_coords;
-            std::map<std::string, Sequence> m_sequences;
+            std::unordered_map<AssetId, TextureCoords> m_coords;
+            std::unordered_map<AssetId, Sequence> m_sequences;
+            std::set<std::string> m_sequenceNames; /**< \brief for getSequenceNames() */
         };
     } // namespace gl
 } // namespace yourgame
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_GLTEXTUREDATA_H
+#define YOURGAME_GLTEXTUREDATA_H
+
+#include <cstdint>
+#include <vector>
+#include "yourgame/gl_include.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        /** \brief texture data in CPU memory: all mipmap levels (and cubemap faces), uncompressed or
+        block-compressed. produced by loadTextureData() (on any thread), turned into a Texture by
+        makeTexture() (on the GL thread) */
+        struct TextureData
+        {
+            struct Level
+            {
+                GLsizei width;
+                GLsizei height;
+                std::vector<std::vector<uint8_t>> faces; /**< 1 face, or 6 faces of a cubemap (+X, -X, +Y, -Y, +Z, -Z) */
+            };
+
+            GLenum target = GL_TEXTURE_2D; /**< GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP */
+            GLint internalFormat = GL_RGBA8;
+            GLenum format = GL_RGBA;        /**< 0, if compressed */
+            GLenum type = GL_UNSIGNED_BYTE; /**< 0, if compressed */
+            std::vector<Level> levels;      /**< level 0 first */
+
+            bool isCompressed() const { return type == 0; }
+
+            /** \brief returns true if decompress() supports the compressed internalFormat:
+            ETC1, ETC2 RGB8 and RGBA8 (EAC), S3TC DXT1, DXT3 and DXT5 (BC1, BC2, BC3), and their sRGB variants */
+            bool canDecompress() const;
+
+            /** \brief converts all levels to GL_RGBA8 (or GL_SRGB8_ALPHA8), GL_RGBA, GL_UNSIGNED_BYTE.
+            for GL implementations without support for the compressed format. returns false if the format
+            is not supported (see canDecompress()). does nothing for uncompressed data */
+            bool decompress();
+
+            /** \brief returns the size of the data of all levels and faces, in bytes */
+            size_t getNumBytes() const;
+        };
+    } // namespace gl
+} // namespace yourgame
+
+#endif
@@ -30,12 +30,15 @@ freely, subject to the following restrictions:
 #include "yourgame/gl/loading.h"
 #include "yourgame/gl/particles.h"
 #include "yourgame/gl/shader.h"
+#include "yourgame/gl/shadervariants.h"
 #include "yourgame/gl/shape.h"
 #include "yourgame/gl/spritegrid.h"
+#include "yourgame/gl/streambuffer.h"
 #include "yourgame/gl/texture.h"
 #include "yourgame/math/camera.h"
 #include "yourgame/math/particles.h"
 #include "yourgame/math/trafo.h"
+#include "yourgame/util/assetloader.h"
 #include "yourgame/util/assetmanager.h"
 #include "yourgame/util/image.h"
 #include "yourgame/util/motion.h"
@@ -0,0 +1,130 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef YOURGAME_ASSETLOADER_H
+#define YOURGAME_ASSETLOADER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "yourgame/assetid.h"
+#include "yourgame/gl_include.h"
+#include "yourgame/gl/loading.h"
+#include "yourgame/util/assetmanager.h"
+
+namespace yourgame
+{
+    namespace util
+    {
+        /**
+        \brief loads a set of assets into an AssetManager, as a graph of dependent assets
+
+        each asset is loaded in two stages:
+        - work: file I/O and decoding (see loadMeshData(), loadTextureData(), ...), on a worker thread.
+          the work stages of all assets are started at once (see start()), and run in parallel
+        - make: creation of GL objects and insertion into the manager, on the main thread, as soon as the
+          work stage is done and all dependencies are made. shaders are compiled in parallel (see ShaderBatch)
+
+        an asset fails if one of its stages fails, or one of its dependencies fails (or is unknown, or part
+        of a dependency cycle). the total loading time approaches the longest chain of dependent assets,
+        instead of the sum of all of them.
+
+        use like so:
+        - add() assets (addGeometry(), addTexture(), addShader() or generic ones, like materials, whose
+          make stage gets their dependencies from the manager)
+        - start() the loader, and keep it until getProgress() is finished (the stages are run before
+          mygame::tick(), the loader does not need to be ticked), or
+        - wait() for all assets, like in mygame::init()
+
+        \attention call from the main thread only. destroying the loader cancels the make stages not run yet
+        */
+        class AssetLoader
+        {
+        public:
+            /** \brief state of a load, see getProgress() */
+            struct Progress
+            {
+                size_t numAssets = 0; // added assets
+                size_t numDone = 0;   // made or failed
+                size_t numFailed = 0;
+                bool finished() const { return numDone == numAssets; }
+            };
+
+            explicit AssetLoader(AssetManager &manager);
+            ~AssetLoader();
+
+            /**
+            \brief adds an asset. work (optional) is run on a worker thread, make on the main thread,
+            after work and the make stages of the assets named in dependencies. both return false on
+            failure. make is expected to insert the asset into the manager (as AssetId(name)).
+            names (and the filenames of the typed assets below) are kept for the log
+            \attention assets can not be added after start()
+            */
+            void add(const std::string &name,
+                     std::function<bool()> work,
+                     std::function<bool(AssetManager &)> make,
+                     const std::vector<std::string> &dependencies = {});
+
+            /** \brief adds a Geometry, see yourgame::gl::loadGeometry() */
+            void addGeometry(const std::string &name,
+                             const std::string &objFilename,
+                             const std::string &mtlFilename = "",
+                             const yourgame::gl::MeshProcessing &processing = yourgame::gl::MeshProcessing(),
+                             const std::vector<std::string> &dependencies = {});
+
+            /** \brief adds a Texture, see yourgame::gl::loadTexture() */
+            void addTexture(const std::string &name,
+                            const std::string &imgFilename,
+                            const std::string &atlasFilename,
+                            const yourgame::gl::TextureConfig &cfg,
+                            const std::vector<std::string> &dependencies = {});
+
+            /** \brief adds a Shader, see yourgame::gl::loadShaderVariant() */
+            void addShader(const std::string &name,
+                           const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                           const std::vector<std::string> &defines = {},
+                           const std::vector<std::pair<GLuint, std::string>> &attrLocs = {},
+                           const std::vector<std::pair<GLuint, std::string>> &fragDataLocs = {},
+                           const std::vector<std::string> &dependencies = {});
+
+            /**
+            \brief starts loading the assets. onProgress (optional) is called on the main thread, whenever
+            an asset is done (made or failed). work stages are posted with priority (see loadTextureAsync())
+            */
+            void start(std::function<void(const Progress &)> onProgress = nullptr, int priority = 0);
+
+            /** \brief starts loading (if not started yet) and blocks until all assets are done */
+            Progress wait();
+
+            Progress getProgress() const;
+
+            /* deleting the copy constructor and the copy assignment operator
+            prevents copying (and moving) of the object. */
+            AssetLoader(AssetLoader const &) = delete;
+            AssetLoader &operator=(AssetLoader const &) = delete;
+
+        private:
+            struct State;
+            std::shared_ptr<State> m_state; // shared with queued stages
+        };
+    } // namespace util
+} // namespace yourgame
+
+#endif
@@ -23,8 +23,8 @@ freely, subject to the following restrictions:
 #include <functional>
 #include <cstdint> // std::uintptr_t
 #include <typeinfo>
-#include <map>
-#include <string>
+#include <unordered_map>
+#include "yourgame/assetid.h"
 
 namespace yourgame
 {
@@ -33,6 +33,9 @@ namespace yourgame
         /**
         \brief utility to store and request pointers, and to delete dynamically allocated objects, by name
 
+        names are AssetIds: strings, string literals and <code>"name"_id</code> can be used interchangeably.
+        lookups are hash lookups, without string comparisons
+
         use like so:
         - create an object with `new`
         - use insert() to store the pointer by name
@@ -60,7 +63,7 @@ namespace yourgame
             \return false, if obj was nullptr, true otherwise
             */
             template <class T>
-            bool insert(std::string name, T *obj)
+            bool insert(AssetId name, T *obj)
             {
                 if (!obj)
                 {
@@ -95,7 +98,7 @@ namespace yourgame
             \param obj pointer
             */
             template <class T>
-            void insert(std::string name, T obj)
+            void insert(AssetId name, T obj)
             {
                 static_assert(sizeof(T) + 1 == 0, "this class only works with pointer types");
             }
@@ -108,7 +111,7 @@ namespace yourgame
             \return pointer. nullptr, if no pointer of type T* and name exists
             */
             template <class T>
-            T *get(std::string name)
+            T *get(AssetId name)
             {
                 auto itMap = m_ptrMaps.find(typeid(T).hash_code());
                 if (itMap != m_ptrMaps.end())
@@ -146,7 +149,7 @@ namespace yourgame
             \param name name
             */
             template <class T>
-            void destroy(std::string name)
+            void destroy(AssetId name)
             {
                 auto itMap = m_ptrMaps.find(typeid(T).hash_code());
                 if (itMap != m_ptrMaps.end())
@@ -196,8 +199,8 @@ namespace yourgame
             }
 
         private:
-            std::map<size_t, std::map<std::string, std::uintptr_t>> m_ptrMaps;
-            std::map<size_t, std::function<void(std::uintptr_t)>> m_delFuncs;
+            std::unordered_map<size_t, std::unordered_map<AssetId, std::uintptr_t>> m_ptrMaps;
+            std::unordered_map<size_t, std::function<void(std::uintptr_t)>> m_delFuncs;
         };
     } // namespace util
 } // namespace yourgame
@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "yourgame/assetid.h"
+#include "yourgame/log.h"
+
+#ifndef NDEBUG
+#define YOURGAME_ASSETID_NAMES
+#endif
+
+namespace
+{
+#ifdef YOURGAME_ASSETID_NAMES
+    // debug name table: hash -> name
+    std::unordered_map<uint64_t, std::string> names;
+    std::mutex namesMutex;
+#endif
+} // namespace
+
+namespace yourgame
+{
+    AssetId::AssetId(const std::string &name) : m_hash(hash(name.data(), name.size()))
+    {
+#ifdef YOURGAME_ASSETID_NAMES
+        std::lock_guard<std::mutex> lock(namesMutex);
+        // find() first, emplace() would allocate a node even if the name is known already
+        auto it = names.find(m_hash);
+        if (it == names.end())
+        {
+            names.emplace(m_hash, name);
+        }
+        else if (it->second != name)
+        {
+            yourgame::log::error("AssetId: hash collision of %v and %v", it->second, name);
+        }
+#endif
+    }
+
+    std::string AssetId::name() const
+    {
+#ifdef YOURGAME_ASSETID_NAMES
+        {
+            std::lock_guard<std::mutex> lock(namesMutex);
+            auto it = names.find(m_hash);
+            if (it != names.end())
+            {
+                return it->second;
+            }
+        }
+#endif
+        char buf[18];
+        std::snprintf(buf, sizeof(buf), "#%016llx", static_cast<unsigned long long>(m_hash));
+        return buf;
+    }
+} // namespace yourgame
@@ -19,12 +19,16 @@ freely, subject to the following restrictions:
 */
 #include <string>
 #include <map>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 #include <valarray>
 #include "yourgame/file.h"
 #include "yourgame/log.h"
+#include "yourgame_internal/worker.h"
 #ifdef YOURGAME_EXTPROJ_miniaudio
 #define STB_VORBIS_HEADER_ONLY
 #include "stb_vorbis.c"
@@ -61,6 +65,11 @@ namespace yourgame
             return -1;
         }
 
+        int playStream(const std::string &filename, bool loop = false)
+        {
+            return -1;
+        }
+
         int stop(int sourceId)
         {
             return -1;
@@ -86,12 +95,42 @@ namespace yourgame
     {
         namespace
         {
-            struct audioSource
+            // decoding of a streamed source. the frames are decoded by worker jobs (see refillStream())
+            // into a ring buffer, the data callback only reads from it. file access and decoding are
+            // kept off the audio thread
+            struct streamDecoding
             {
                 ma_decoder decoder;
+                yourgame::file::Stream *stream = nullptr;
+                ma_pcm_rb ring;
+                ma_uint32 ringFrames = 0;
+                bool decoderInitialized = false;
+                bool ringInitialized = false;
+                std::atomic<bool> refilling{false}; // a refill job is queued or running
+                std::atomic<bool> atEnd{false};     // all frames are decoded (not looping)
+
+                ~streamDecoding()
+                {
+                    if (ringInitialized)
+                    {
+                        ma_pcm_rb_uninit(&ring);
+                    }
+                    if (decoderInitialized)
+                    {
+                        ma_decoder_uninit(&decoder);
+                    }
+                    delete stream;
+                }
+            };
+
+            struct audioSource
+            {
+                ma_decoder decoder;                        // stored sources only, see play()
+                std::shared_ptr<streamDecoding> streaming; // streamed sources only, see playStream()
                 std::vector<float> channelGains;
                 bool paused = false;
                 bool loop = false;
+                bool finished = false; // streamed sources are deleted on the main thread, see serviceStreams()
             };
 
             ma_device g_maDevice;
@@ -99,6 +138,7 @@ namespace yourgame
             ma_mutex g_mtxSources;
             std::map<std::string, std::vector<uint8_t>> g_audioFileData;
             bool g_audioInitialized = false;
+            bool g_streamsServiced = false; // serviceStreams() is queued (main thread only)
 
             bool checkValidSourceId(int sourceId)
             {
@@ -120,13 +160,180 @@ namespace yourgame
                     return -2;
                 }
 
-                ma_decoder_uninit(&(src->decoder));
+                if (!src->streaming)
+                {
+                    ma_decoder_uninit(&(src->decoder));
+                }
                 delete src;
                 g_sources[sourceId] = nullptr;
 
                 return 0;
             }
 
+            ma_result maStreamRead(ma_decoder *pDecoder, void *pBufferOut, size_t bytesToRead, size_t *pBytesRead)
+            {
+                auto stream = static_cast<yourgame::file::Stream *>(pDecoder->pUserData);
+                *pBytesRead = stream->read(pBufferOut, bytesToRead);
+                return (*pBytesRead == 0 && bytesToRead > 0) ? MA_AT_END : MA_SUCCESS;
+            }
+
+            ma_result maStreamSeek(ma_decoder *pDecoder, ma_int64 byteOffset, ma_seek_origin origin)
+            {
+                auto stream = static_cast<yourgame::file::Stream *>(pDecoder->pUserData);
+                ma_int64 pos = byteOffset;
+                if (origin == ma_seek_origin_current)
+                {
+                    pos += static_cast<ma_int64>(stream->tell());
+                }
+                else if (origin == ma_seek_origin_end)
+                {
+                    pos += static_cast<ma_int64>(stream->size());
+                }
+
+                if (pos < 0 || stream->seek(static_cast<uint64_t>(pos)) != 0)
+                {
+                    return MA_BAD_SEEK;
+                }
+                return MA_SUCCESS;
+            }
+
+            // runs on a worker thread. decodes frames until the ring buffer is full, or the end is reached
+            void refillStream(streamDecoding &streaming)
+            {
+                while (true)
+                {
+                    ma_uint32 numFrames = ma_pcm_rb_available_write(&streaming.ring);
+                    void *buf = nullptr;
+                    if (numFrames == 0 || ma_pcm_rb_acquire_write(&streaming.ring, &numFrames, &buf) != MA_SUCCESS)
+                    {
+                        break;
+                    }
+
+                    ma_uint64 numDecoded = 0;
+                    ma_data_source_read_pcm_frames(&streaming.decoder, buf, numFrames, &numDecoded);
+                    ma_pcm_rb_commit_write(&streaming.ring, static_cast<ma_uint32>(numDecoded));
+
+                    // looping decoders do not end
+                    if (numDecoded < numFrames)
+                    {
+                        streaming.atEnd = true;
+                        break;
+                    }
+                }
+                streaming.refilling = false;
+            }
+
+            // posts a refill job, if the ring buffer is running low and no job is pending
+            void requestRefill(const std::shared_ptr<streamDecoding> &streaming)
+            {
+                if (streaming->atEnd ||
+                    ma_pcm_rb_available_write(&streaming->ring) < streaming->ringFrames / 4 ||
+                    streaming->refilling.exchange(true))
+                {
+                    return;
+                }
+                yourgame_internal::worker::post([streaming]()
+                                                { refillStream(*streaming); });
+            }
+
+            // runs on the main thread (re-queued every tick), as long as there are streamed
+            // sources: requests refills, and deletes finished sources
+            void serviceStreams()
+            {
+                // released outside the lock, as that might close the stream
+                std::vector<std::shared_ptr<streamDecoding>> released;
+                bool anyStreams = false;
+
+                ma_mutex_lock(&g_mtxSources);
+                for (auto iSrc = 0; iSrc < g_sources.size(); iSrc++)
+                {
+                    audioSource *src = g_sources[iSrc];
+                    if (src == nullptr || !src->streaming)
+                    {
+                        continue;
+                    }
+                    if (src->finished)
+                    {
+                        released.push_back(src->streaming);
+                        deleteAudioSource(iSrc);
+                        continue;
+                    }
+                    anyStreams = true;
+                    requestRefill(src->streaming);
+                }
+                ma_mutex_unlock(&g_mtxSources);
+
+                g_streamsServiced = anyStreams;
+                if (anyStreams)
+                {
+                    yourgame_internal::worker::postToMain(serviceStreams);
+                }
+            }
+
+            // runs on the audio thread. reads up to frameCount decoded frames from the ring buffer
+            ma_uint64 readStreamFrames(streamDecoding &streaming, float *dst, ma_uint32 frameCount, ma_uint32 numChannels)
+            {
+                ma_uint32 numRead = 0;
+                while (numRead < frameCount)
+                {
+                    ma_uint32 numFrames = frameCount - numRead;
+                    void *buf = nullptr;
+                    if (ma_pcm_rb_acquire_read(&streaming.ring, &numFrames, &buf) != MA_SUCCESS || numFrames == 0)
+                    {
+                        break;
+                    }
+                    std::memcpy(dst + numRead * numChannels, buf, numFrames * numChannels * sizeof(float));
+                    ma_pcm_rb_commit_read(&streaming.ring, numFrames);
+                    numRead += numFrames;
+                }
+                return numRead;
+            }
+
+            // does NOT lock g_mtxSources
+            int findEmptySourceSlot()
+            {
+                for (int sourceId = 0; sourceId < g_sources.size(); sourceId++)
+                {
+                    if (g_sources[sourceId] == nullptr)
+                    {
+                        return sourceId;
+                    }
+                }
+                return -1;
+            }
+
+            // takes ownership of newSource (deleted on failure)
+            int startAudioSource(audioSource *newSource, bool loop)
+            {
+                newSource->channelGains.resize(g_maDevice.playback.channels, 1.0f);
+                newSource->loop = loop;
+
+                if (loop && !newSource->streaming)
+                {
+                    ma_data_source_set_looping(&(newSource->decoder), 1);
+                }
+
+                ma_mutex_lock(&g_mtxSources);
+                int sourceId = findEmptySourceSlot();
+                if (sourceId >= 0)
+                {
+                    g_sources[sourceId] = newSource;
+                }
+                ma_mutex_unlock(&g_mtxSources);
+
+                if (sourceId < 0)
+                {
+                    if (!newSource->streaming)
+                    {
+                        ma_decoder_uninit(&(newSource->decoder));
+                    }
+                    delete newSource;
+                    return -2;
+                }
+
+                return sourceId;
+            }
+
             void maDataCallback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount)
             {
                 ma_uint32 numDeviceChannels = pDevice->playback.channels;
@@ -136,7 +343,7 @@ namespace yourgame
                 {
                     audioSource *src = g_sources[iSrc];
 
-                    if (src == nullptr || src->paused)
+                    if (src == nullptr || src->paused || src->finished)
                     {
                         continue;
                     }
@@ -144,9 +351,16 @@ namespace yourgame
                     // prepare storage for pcm frames
                     std::vector<float> pcmBuf(frameCount * numDeviceChannels, 0.0f);
 
-                    // read pcm frames
-                    ma_uint64 framesBuffered;
-                    auto maRes = ma_data_source_read_pcm_frames(&(src->decoder), pcmBuf.data(), frameCount, &framesBuffered);
+                    // read pcm frames. streamed sources are decoded ahead, see refillStream()
+                    ma_uint64 framesBuffered = 0;
+                    if (src->streaming)
+                    {
+                        framesBuffered = readStreamFrames(*src->streaming, pcmBuf.data(), frameCount, numDeviceChannels);
+                    }
+                    else
+                    {
+                        ma_data_source_read_pcm_frames(&(src->decoder), pcmBuf.data(), frameCount, &framesBuffered);
+                    }
 
                     // form a valarray from pcm frames. the gains get applied in this valarray below
                     std::valarray<float> pcmBufVarr(pcmBuf.data(), pcmBuf.size());
@@ -174,8 +388,17 @@ namespace yourgame
                         ((float *)pOutput)[i] += pcmBuf[i];
                     }
 
-                    // a non-looping source is deleted when end of data is reached
-                    if (framesBuffered < frameCount && !src->loop)
+                    // a non-looping source is deleted when end of data is reached. streamed sources
+                    // might just be behind (not at the end), and are deleted on the main thread
+                    if (src->streaming)
+                    {
+                        if (framesBuffered < frameCount && src->streaming->atEnd &&
+                            ma_pcm_rb_available_read(&src->streaming->ring) == 0)
+                        {
+                            src->finished = true;
+                        }
+                    }
+                    else if (framesBuffered < frameCount && !src->loop)
                     {
                         deleteAudioSource(iSrc);
                     }
@@ -235,6 +458,7 @@ namespace yourgame
             ma_mutex_unlock(&g_mtxSources);
 
             g_audioInitialized = false;
+            g_streamsServiced = false;
 
             yourgame::log::info("yourgame::audio::shutdown(): audio shut down.");
         }
@@ -272,20 +496,11 @@ namespace yourgame
             }
 
             // check if an empty source slot is available
-            int sourceId;
-            bool emptySourceSlot = false;
             ma_mutex_lock(&g_mtxSources);
-            for (sourceId = 0; sourceId < g_sources.size(); sourceId++)
-            {
-                if (g_sources[sourceId] == nullptr)
-                {
-                    emptySourceSlot = true;
-                    break;
-                }
-            }
+            int sourceId = findEmptySourceSlot();
             ma_mutex_unlock(&g_mtxSources);
 
-            if (!emptySourceSlot)
+            if (sourceId < 0)
             {
                 return -2;
             }
@@ -304,24 +519,74 @@ namespace yourgame
                 return -3;
             }
 
-            newSource->channelGains.resize(g_maDevice.playback.channels, 1.0f);
-            newSource->loop = loop;
+            return startAudioSource(newSource, loop);
+        }
+
+        int playStream(const std::string &filename, bool loop)
+        {
+            // check if an empty source slot is available
+            ma_mutex_lock(&g_mtxSources);
+            int sourceId = findEmptySourceSlot();
+            ma_mutex_unlock(&g_mtxSources);
+
+            if (sourceId < 0)
+            {
+                return -2;
+            }
+
+            auto streaming = std::make_shared<streamDecoding>();
+            streaming->stream = yourgame::file::Stream::open(filename);
+            if (!streaming->stream)
+            {
+                return -1;
+            }
+
+            ma_decoder_config maDecCfg = ma_decoder_config_init(
+                g_maDevice.playback.format,
+                g_maDevice.playback.channels,
+                g_maDevice.sampleRate);
 
+            // the decoder pulls encoded data from the stream, as needed
+            if (ma_decoder_init(maStreamRead, maStreamSeek, streaming->stream, &maDecCfg, &(streaming->decoder)) != MA_SUCCESS)
+            {
+                return -3;
+            }
+            streaming->decoderInitialized = true;
             if (loop)
             {
-                ma_data_source_set_looping(&(newSource->decoder), 1);
+                ma_data_source_set_looping(&(streaming->decoder), 1);
             }
 
-            ma_mutex_lock(&g_mtxSources);
-            g_sources[sourceId] = newSource;
-            ma_mutex_unlock(&g_mtxSources);
+            // one second of decoded frames
+            streaming->ringFrames = g_maDevice.sampleRate;
+            if (ma_pcm_rb_init(g_maDevice.playback.format, g_maDevice.playback.channels,
+                               streaming->ringFrames, NULL, NULL, &(streaming->ring)) != MA_SUCCESS)
+            {
+                return -3;
+            }
+            streaming->ringInitialized = true;
+            requestRefill(streaming);
 
-            return sourceId;
+            audioSource *newSource = new audioSource();
+            newSource->streaming = streaming;
+            int ret = startAudioSource(newSource, loop);
+            if (ret >= 0 && !g_streamsServiced)
+            {
+                g_streamsServiced = true;
+                yourgame_internal::worker::postToMain(serviceStreams);
+            }
+            return ret;
         }
 
         int stop(int sourceId)
         {
+            // streamed sources are released outside the lock, as that might close the stream
+            std::shared_ptr<streamDecoding> streaming;
             ma_mutex_lock(&g_mtxSources);
+            if (checkValidSourceId(sourceId) && g_sources[sourceId] != nullptr)
+            {
+                streaming = g_sources[sourceId]->streaming;
+            }
             int ret = deleteAudioSource(sourceId);
             ma_mutex_unlock(&g_mtxSources);
             return ret;
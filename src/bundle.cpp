@@ -0,0 +1,417 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "miniz.h"
+#include "yourgame/file.h"
+#include "yourgame/log.h"
+#include "yourgame_internal/bundle.h"
+#include "yourgame_internal/file.h"
+
+/* bundle file layout (all integers in native byte order, like the other caches. bundles
+written on a host of the other byte order fail the magic check):
+- BundleHeader
+- entry data. stored entries start at multiples of BUNDLE_ALIGNMENT
+- table of contents (at header.tocOffset, 8 byte aligned):
+  - BundleEntry[numEntries]
+  - uint32_t buckets[numBuckets]: hash table (open addressing) of entry indices
+  - names of the entries, not terminated */
+
+namespace yourgame_internal
+{
+    namespace file
+    {
+        struct BundleEntry
+        {
+            uint64_t hash;       // see hashName()
+            uint64_t offset;     // of the data, from the beginning of the file
+            uint64_t storedSize; // size of the data in the file
+            uint64_t size;       // uncompressed size
+            uint32_t nameOffset; // from the beginning of the names
+            uint32_t nameSize;
+            uint32_t method; // 0: stored, MZ_DEFLATED: deflated (raw)
+            uint32_t crc32;  // of the uncompressed data
+        };
+    } // namespace file
+} // namespace yourgame_internal
+
+namespace
+{
+    using yourgame_internal::file::BundleEntry;
+
+    struct BundleHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numEntries;
+        uint32_t numBuckets; // power of 2
+        uint64_t tocOffset;
+        uint64_t tocSize;
+    };
+
+    static_assert(sizeof(BundleHeader) == 32, "unexpected size of BundleHeader");
+    static_assert(sizeof(BundleEntry) == 48, "unexpected size of BundleEntry");
+
+    const uint32_t BUNDLE_MAGIC = 0x42475921; // "!YGB"
+    const uint32_t BUNDLE_VERSION = 1;
+    const uint64_t BUNDLE_ALIGNMENT = 4096;
+    const uint32_t BUNDLE_EMPTY_BUCKET = 0xFFFFFFFF;
+
+    // FNV-1a, case-insensitive (like archive entries)
+    uint64_t hashName(const char *name, size_t nameSize)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < nameSize; i++)
+        {
+            hash ^= static_cast<uint64_t>(std::tolower(static_cast<unsigned char>(name[i])));
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    bool equalNames(const char *a, size_t aSize, const char *b, size_t bSize)
+    {
+        if (aSize != bSize)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < aSize; i++)
+        {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // writes zeros up to the next multiple of alignment
+    bool writePadding(std::FILE *f, uint64_t &offset, uint64_t alignment)
+    {
+        static const uint8_t zeros[BUNDLE_ALIGNMENT] = {};
+        uint64_t numBytes = (alignment - (offset % alignment)) % alignment;
+        offset += numBytes;
+        return std::fwrite(zeros, 1, static_cast<size_t>(numBytes), f) == numBytes;
+    }
+} // namespace
+
+namespace yourgame_internal
+{
+    namespace file
+    {
+        Bundle *Bundle::open(const std::string &path)
+        {
+            auto file = std::make_shared<yourgame::file::FileView>();
+            if (mapFileFromPath(path, *file) != 0 || file->size() < sizeof(BundleHeader))
+            {
+                return nullptr;
+            }
+
+            BundleHeader header;
+            std::memcpy(&header, file->data(), sizeof(header));
+
+            uint64_t entriesSize = static_cast<uint64_t>(header.numEntries) * sizeof(BundleEntry);
+            uint64_t bucketsSize = static_cast<uint64_t>(header.numBuckets) * sizeof(uint32_t);
+            if (header.magic != BUNDLE_MAGIC ||
+                header.version != BUNDLE_VERSION ||
+                header.numBuckets == 0 ||
+                (header.numBuckets & (header.numBuckets - 1)) != 0 ||
+                header.numBuckets < header.numEntries ||
+                (header.tocOffset % 8) != 0 ||
+                header.tocOffset > file->size() ||
+                header.tocSize > file->size() - header.tocOffset ||
+                header.tocSize < entriesSize + bucketsSize)
+            {
+                yourgame::log::error("Bundle: invalid bundle file %v", path);
+                return nullptr;
+            }
+
+            // the table of contents is used in place
+            const uint8_t *toc = file->data() + header.tocOffset;
+            Bundle *bundle = new Bundle();
+            bundle->m_file = file;
+            bundle->m_entries = reinterpret_cast<const BundleEntry *>(toc);
+            bundle->m_buckets = reinterpret_cast<const uint32_t *>(toc + entriesSize);
+            bundle->m_names = reinterpret_cast<const char *>(toc + entriesSize + bucketsSize);
+            bundle->m_numEntries = header.numEntries;
+            bundle->m_numBuckets = header.numBuckets;
+            bundle->m_namesSize = header.tocSize - entriesSize - bucketsSize;
+
+            yourgame::log::debug("Bundle: opened %v with %v entries", path, header.numEntries);
+
+            return bundle;
+        }
+
+        const BundleEntry *Bundle::find(const std::string &filename) const
+        {
+            uint64_t hash = hashName(filename.data(), filename.size());
+            uint32_t mask = m_numBuckets - 1;
+            for (uint32_t i = 0, b = static_cast<uint32_t>(hash) & mask; i < m_numBuckets; i++, b = (b + 1) & mask)
+            {
+                uint32_t idx = m_buckets[b];
+                if (idx == BUNDLE_EMPTY_BUCKET || idx >= m_numEntries)
+                {
+                    return nullptr;
+                }
+
+                const BundleEntry *entry = &m_entries[idx];
+                if (entry->hash == hash &&
+                    static_cast<uint64_t>(entry->nameOffset) + entry->nameSize <= m_namesSize &&
+                    equalNames(m_names + entry->nameOffset, entry->nameSize, filename.data(), filename.size()))
+                {
+                    // the data of an entry must be within the file
+                    if (entry->offset > m_file->size() || entry->storedSize > m_file->size() - entry->offset)
+                    {
+                        return nullptr;
+                    }
+                    return entry;
+                }
+            }
+            return nullptr;
+        }
+
+        bool Bundle::contains(const std::string &filename) const
+        {
+            return find(filename) != nullptr;
+        }
+
+        int Bundle::read(const std::string &filename, std::vector<uint8_t> &dst) const
+        {
+            yourgame::file::FileView view;
+            int ret = map(filename, view);
+            if (ret != 0)
+            {
+                return ret;
+            }
+            dst.assign(view.data(), view.data() + view.size());
+            return 0;
+        }
+
+        int Bundle::map(const std::string &filename, yourgame::file::FileView &dst) const
+        {
+            const BundleEntry *entry = find(filename);
+            if (!entry)
+            {
+                return -3;
+            }
+
+            const uint8_t *data = m_file->data() + entry->offset;
+
+            if (entry->method == 0) // stored
+            {
+                if (entry->storedSize != entry->size)
+                {
+                    return -3;
+                }
+                // the view keeps the mapping alive
+                auto file = m_file;
+                dst = yourgame::file::FileView(data,
+                                               static_cast<size_t>(entry->size),
+                                               [file]() {});
+                return 0;
+            }
+            else if (entry->method == MZ_DEFLATED)
+            {
+                std::vector<uint8_t> buffer(static_cast<size_t>(entry->size));
+                size_t numBytes = 0;
+                if (!buffer.empty())
+                {
+                    numBytes = tinfl_decompress_mem_to_mem(buffer.data(),
+                                                           buffer.size(),
+                                                           data,
+                                                           static_cast<size_t>(entry->storedSize),
+                                                           TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+                }
+                if (numBytes != buffer.size() ||
+                    mz_crc32(MZ_CRC32_INIT, buffer.data(), buffer.size()) != entry->crc32)
+                {
+                    return -3;
+                }
+                dst = yourgame::file::FileView(std::move(buffer));
+                return 0;
+            }
+
+            return -3;
+        }
+
+        int Bundle::mapStored(const std::string &filename, yourgame::file::FileView &dst,
+                              bool &deflated, uint64_t &size, uint32_t &crc32) const
+        {
+            const BundleEntry *entry = find(filename);
+            if (!entry || (entry->method != 0 && entry->method != MZ_DEFLATED))
+            {
+                return -3;
+            }
+
+            auto file = m_file;
+            dst = yourgame::file::FileView(m_file->data() + entry->offset,
+                                           static_cast<size_t>(entry->storedSize),
+                                           [file]() {});
+            deflated = (entry->method == MZ_DEFLATED);
+            size = entry->size;
+            crc32 = entry->crc32;
+            return 0;
+        }
+
+        size_t Bundle::getNumEntries() const
+        {
+            return m_numEntries;
+        }
+
+        std::vector<std::string> Bundle::getNames() const
+        {
+            std::vector<std::string> names;
+            names.reserve(m_numEntries);
+            for (uint32_t i = 0; i < m_numEntries; i++)
+            {
+                const BundleEntry &entry = m_entries[i];
+                if (static_cast<uint64_t>(entry.nameOffset) + entry.nameSize <= m_namesSize)
+                {
+                    names.emplace_back(m_names + entry.nameOffset, entry.nameSize);
+                }
+            }
+            return names;
+        }
+    } // namespace file
+} // namespace yourgame_internal
+
+namespace yourgame
+{
+    namespace file
+    {
+        int writeBundle(const std::string &bundlePath, const std::vector<BundleFile> &files)
+        {
+            // names are unique, case-insensitive
+            std::unordered_set<std::string> names;
+            for (const auto &f : files)
+            {
+                std::string name = f.name;
+                std::transform(name.begin(), name.end(), name.begin(),
+                               [](unsigned char c)
+                               { return static_cast<char>(std::tolower(c)); });
+                if (f.name.empty() || !names.insert(name).second)
+                {
+                    yourgame::log::error("writeBundle(): empty or duplicate name %v", f.name);
+                    return -1;
+                }
+            }
+
+            std::FILE *f = std::fopen(bundlePath.c_str(), "wb");
+            if (!f)
+            {
+                return -2;
+            }
+
+            // the header is written last, as soon as the toc offset is known
+            BundleHeader header = {};
+            uint64_t offset = sizeof(header);
+            bool ok = (std::fwrite(&header, sizeof(header), 1, f) == 1);
+
+            std::vector<BundleEntry> entries(files.size());
+            std::string namesData;
+            for (size_t i = 0; ok && i < files.size(); i++)
+            {
+                std::vector<uint8_t> data;
+                if (readFile(files[i].source, data) != 0)
+                {
+                    yourgame::log::error("writeBundle(): failed to read %v", files[i].source);
+                    ok = false;
+                    break;
+                }
+
+                BundleEntry &entry = entries[i];
+                entry.hash = hashName(files[i].name.data(), files[i].name.size());
+                entry.size = data.size();
+                entry.crc32 = static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, data.data(), data.size()));
+                entry.nameOffset = static_cast<uint32_t>(namesData.size());
+                entry.nameSize = static_cast<uint32_t>(files[i].name.size());
+                namesData += files[i].name;
+
+                // raw deflate, kept only if it saves space
+                void *deflated = nullptr;
+                size_t deflatedSize = 0;
+                if (files[i].deflate && !data.empty())
+                {
+                    deflated = tdefl_compress_mem_to_heap(data.data(), data.size(), &deflatedSize, TDEFL_DEFAULT_MAX_PROBES);
+                }
+
+                if (deflated && deflatedSize < data.size())
+                {
+                    entry.method = MZ_DEFLATED;
+                    entry.offset = offset;
+                    entry.storedSize = deflatedSize;
+                    ok = (std::fwrite(deflated, 1, deflatedSize, f) == deflatedSize);
+                }
+                else
+                {
+                    // stored entries are aligned, to be mapped in place
+                    ok = writePadding(f, offset, BUNDLE_ALIGNMENT);
+                    entry.method = 0;
+                    entry.offset = offset;
+                    entry.storedSize = data.size();
+                    ok = ok && (std::fwrite(data.data(), 1, data.size(), f) == data.size());
+                }
+                offset += entry.storedSize;
+                mz_free(deflated);
+            }
+
+            // hash table, at most half full
+            uint32_t numBuckets = 1;
+            while (numBuckets < 2 * entries.size())
+            {
+                numBuckets *= 2;
+            }
+            std::vector<uint32_t> buckets(numBuckets, BUNDLE_EMPTY_BUCKET);
+            for (uint32_t i = 0; i < entries.size(); i++)
+            {
+                uint32_t b = static_cast<uint32_t>(entries[i].hash) & (numBuckets - 1);
+                while (buckets[b] != BUNDLE_EMPTY_BUCKET)
+                {
+                    b = (b + 1) & (numBuckets - 1);
+                }
+                buckets[b] = i;
+            }
+
+            ok = ok && writePadding(f, offset, 8);
+            header.magic = BUNDLE_MAGIC;
+            header.version = BUNDLE_VERSION;
+            header.numEntries = static_cast<uint32_t>(entries.size());
+            header.numBuckets = numBuckets;
+            header.tocOffset = offset;
+            header.tocSize = entries.size() * sizeof(BundleEntry) + buckets.size() * sizeof(uint32_t) + namesData.size();
+
+            ok = ok && (std::fwrite(entries.data(), sizeof(BundleEntry), entries.size(), f) == entries.size());
+            ok = ok && (std::fwrite(buckets.data(), sizeof(uint32_t), buckets.size(), f) == buckets.size());
+            ok = ok && (std::fwrite(namesData.data(), 1, namesData.size(), f) == namesData.size());
+            ok = ok && (std::fseek(f, 0, SEEK_SET) == 0);
+            ok = ok && (std::fwrite(&header, sizeof(header), 1, f) == 1);
+            ok = (std::fclose(f) == 0) && ok;
+
+            return ok ? 0 : -3;
+        }
+    } // namespace file
+} // namespace yourgame
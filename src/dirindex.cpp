@@ -0,0 +1,372 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <sys/stat.h>
+#if defined(__linux__)
+#define YOURGAME_FILE_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "dirent.h"
+#include "yourgame_internal/file.h"
+
+namespace
+{
+    using yourgame_internal::file::DirEntry;
+
+    /* modification time (nanoseconds, where available), size and inode of a directory */
+    struct DirStamp
+    {
+        time_t sec = 0;
+        long nsec = 0;
+        long long size = 0;
+        unsigned long long ino = 0;
+
+        bool operator==(const DirStamp &other) const
+        {
+            return sec == other.sec && nsec == other.nsec && size == other.size && ino == other.ino;
+        }
+    };
+
+    DirStamp makeStamp(const struct stat &st)
+    {
+        DirStamp stamp;
+        stamp.sec = st.st_mtime;
+#if defined(__APPLE__)
+        stamp.nsec = (long)st.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+        stamp.nsec = (long)st.st_mtim.tv_nsec;
+#endif
+        stamp.size = (long long)st.st_size;
+        stamp.ino = (unsigned long long)st.st_ino;
+        return stamp;
+    }
+
+    /* snapshot of the entries of a directory, see forEachDirEntry(). watched directories
+    are invalidated by inotify events, others are checked by their stamp */
+    struct DirSnapshot
+    {
+        std::vector<DirEntry> entries; // sorted
+        bool valid = false;
+        int watch = -1;
+        DirStamp stamp;
+        time_t readTime = 0; // when the directory was read
+    };
+
+    std::mutex dirIndexMutex;
+    std::unordered_map<std::string, DirSnapshot> dirIndex; // path (with trailing '/') -> snapshot
+
+#ifdef YOURGAME_FILE_INOTIFY
+    int inotifyFd = -1;
+    bool inotifyFailed = false;
+    std::unordered_map<int, std::vector<std::string>> dirWatches; // watch -> paths
+
+    // invalidates snapshots of changed directories. requires dirIndexMutex to be locked
+    void processDirEvents()
+    {
+        if (inotifyFd < 0)
+        {
+            return;
+        }
+
+        alignas(struct inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = read(inotifyFd, buf, sizeof(buf))) > 0)
+        {
+            for (char *p = buf; p < buf + len;)
+            {
+                auto ev = reinterpret_cast<const struct inotify_event *>(p);
+                p += sizeof(struct inotify_event) + ev->len;
+
+                if (ev->mask & IN_Q_OVERFLOW)
+                {
+                    // events were lost
+                    for (auto &snap : dirIndex)
+                    {
+                        snap.second.valid = false;
+                    }
+                    continue;
+                }
+
+                auto watch = dirWatches.find(ev->wd);
+                if (watch == dirWatches.end())
+                {
+                    continue;
+                }
+
+                for (const auto &path : watch->second)
+                {
+                    auto snap = dirIndex.find(path);
+                    if (snap != dirIndex.end())
+                    {
+                        snap->second.valid = false;
+                        if (ev->mask & IN_IGNORED)
+                        {
+                            snap->second.watch = -1;
+                        }
+                    }
+                }
+
+                // the watch was removed (directory deleted, etc.)
+                if (ev->mask & IN_IGNORED)
+                {
+                    dirWatches.erase(watch);
+                }
+            }
+        }
+    }
+
+    void watchDirectory(const std::string &path, DirSnapshot &snap)
+    {
+        if (inotifyFd < 0 && !inotifyFailed)
+        {
+            inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            inotifyFailed = (inotifyFd < 0);
+        }
+
+        if (inotifyFd < 0 || snap.watch >= 0)
+        {
+            return;
+        }
+
+        int wd = inotify_add_watch(inotifyFd, path.c_str(),
+                                   IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                       IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        if (wd >= 0)
+        {
+            snap.watch = wd;
+            auto &paths = dirWatches[wd];
+            if (std::find(paths.begin(), paths.end(), path) == paths.end())
+            {
+                paths.push_back(path);
+            }
+        }
+    }
+#endif
+
+    // requires dirIndexMutex to be locked
+    bool isCurrent(const std::string &path, const DirSnapshot &snap)
+    {
+        if (!snap.valid)
+        {
+            return false;
+        }
+
+        if (snap.watch >= 0)
+        {
+            return true;
+        }
+
+        // the modification time might be of one second granularity (file system, platform):
+        // changes within the second the directory was read could be missed
+        struct stat st;
+        return (stat(path.c_str(), &st) == 0) &&
+               (makeStamp(st) == snap.stamp) &&
+               (snap.stamp.sec < snap.readTime);
+    }
+
+    // re-reads the directory. requires dirIndexMutex to be locked
+    bool refresh(const std::string &path, DirSnapshot &snap)
+    {
+        snap.valid = false;
+        snap.entries.clear();
+
+#ifdef YOURGAME_FILE_INOTIFY
+        // watch first, to not miss changes while reading
+        watchDirectory(path, snap);
+#endif
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+        {
+            return false;
+        }
+        snap.stamp = makeStamp(st);
+        snap.readTime = std::time(nullptr);
+
+        DIR *dir = opendir(path.c_str());
+        if (!dir)
+        {
+            return false;
+        }
+
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL)
+        {
+            char suffix;
+            switch (ent->d_type)
+            {
+            case DT_REG:
+                suffix = '\0';
+                break;
+            case DT_DIR:
+                suffix = '/';
+                break;
+            case DT_LNK:
+                suffix = '@';
+                break;
+            default:
+                suffix = '*';
+            }
+            snap.entries.push_back({std::string(ent->d_name), suffix});
+        }
+        closedir(dir);
+
+        std::sort(snap.entries.begin(), snap.entries.end(),
+                  [](const DirEntry &a, const DirEntry &b)
+                  { return a.name < b.name; });
+        snap.valid = true;
+        return true;
+    }
+
+    std::string toLower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return str;
+    }
+} // namespace
+
+namespace yourgame_internal
+{
+    namespace file
+    {
+        bool globMatch(const char *pattern, const char *name)
+        {
+            // on mismatch, retry from the last "*", consuming one more character
+            const char *starPattern = nullptr;
+            const char *starName = nullptr;
+            while (*name)
+            {
+                if (*pattern == '*')
+                {
+                    starPattern = pattern++;
+                    starName = name;
+                }
+                else if (*pattern == '?' || *pattern == *name)
+                {
+                    pattern++;
+                    name++;
+                }
+                else if (starPattern)
+                {
+                    pattern = starPattern + 1;
+                    name = ++starName;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            while (*pattern == '*')
+            {
+                pattern++;
+            }
+            return *pattern == '\0';
+        }
+
+        bool forEachDirEntry(const std::string &path, const std::function<void(const DirEntry &)> &fn)
+        {
+            std::string dirPath = path.empty() ? "./" : path;
+            if (dirPath.back() != '/')
+            {
+                dirPath += '/';
+            }
+
+            std::lock_guard<std::mutex> lock(dirIndexMutex);
+#ifdef YOURGAME_FILE_INOTIFY
+            processDirEvents();
+#endif
+            DirSnapshot &snap = dirIndex[dirPath];
+            if (!isCurrent(dirPath, snap) && !refresh(dirPath, snap))
+            {
+                return false;
+            }
+
+            for (const auto &e : snap.entries)
+            {
+                fn(e);
+            }
+            return true;
+        }
+
+        void clearDirIndex()
+        {
+            std::lock_guard<std::mutex> lock(dirIndexMutex);
+            dirIndex.clear();
+#ifdef YOURGAME_FILE_INOTIFY
+            if (inotifyFd >= 0)
+            {
+                close(inotifyFd);
+                inotifyFd = -1;
+            }
+            dirWatches.clear();
+#endif
+        }
+
+        void buildDirTree(const std::vector<std::string> &filenames, DirTree &dst)
+        {
+            dst.clear();
+            dst[""]; // the root exists, even if empty
+
+            std::unordered_set<std::string> dirs;
+            for (const auto &f : filenames)
+            {
+                if (f.empty() || f.back() == '/')
+                {
+                    continue;
+                }
+
+                // every component of the path, but the last, is a directory
+                size_t begin = 0;
+                size_t sep;
+                while ((sep = f.find('/', begin)) != std::string::npos)
+                {
+                    std::string parent = toLower(f.substr(0, begin));
+                    std::string dir = toLower(f.substr(0, sep + 1));
+                    if (dirs.insert(dir).second)
+                    {
+                        dst[parent].push_back({f.substr(begin, sep - begin), '/'});
+                        dst[dir];
+                    }
+                    begin = sep + 1;
+                }
+                dst[toLower(f.substr(0, begin))].push_back({f.substr(begin), '\0'});
+            }
+
+            for (auto &dir : dst)
+            {
+                std::sort(dir.second.begin(), dir.second.end(),
+                          [](const DirEntry &a, const DirEntry &b)
+                          { return a.name < b.name; });
+            }
+        }
+    } // namespace file
+} // namespace yourgame_internal
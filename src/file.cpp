@@ -17,16 +17,1089 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
-#include <algorithm> // std::replace()
-#include <regex>
+#include <algorithm> // std::replace(), std::transform()
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator> // std::next()
+#include <cctype>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <sys/stat.h>
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define YOURGAME_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "dirent.h"
 #include "miniz.h"
 #include "yourgame/file.h"
 #include "yourgame/log.h"
+#include "yourgame_internal/bundle.h"
+#include "yourgame_internal/file.h"
+#include "yourgame_internal/worker.h"
+
+namespace
+{
+    // archive access counters, see getArchiveStats()
+    std::atomic<uint64_t> statOpens(0);
+    std::atomic<uint64_t> statLookups(0);
+    std::atomic<uint64_t> statMisses(0);
+
+    std::string toLower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return str;
+    }
+
+    /* an archive (.zip), opened and indexed once. it stays open as long as it is mounted */
+    class Archive
+    {
+    public:
+        // compressed data of an entry, see fetch() and inflate()
+        struct Entry
+        {
+            mz_zip_archive_file_stat stat;
+            std::vector<uint8_t> compressed;
+        };
+
+        Archive()
+        {
+            std::memset(&m_zip, 0, sizeof(m_zip));
+        }
+
+        ~Archive()
+        {
+            if (m_isOpen)
+            {
+                mz_zip_reader_end(&m_zip);
+            }
+        }
+
+        /* deleting the copy constructor and the copy assignment operator
+        prevents copying (and moving) of the object. */
+        Archive(Archive const &) = delete;
+        Archive &operator=(Archive const &) = delete;
+
+        int open(const std::string &archivepath)
+        {
+            if (!mz_zip_reader_init_file(&m_zip, archivepath.c_str(), 0))
+            {
+                return -2;
+            }
+            m_isOpen = true;
+            statOpens++;
+
+            // build the name->index lookup table once, instead of
+            // locating each entry in the central directory on every read.
+            // lower case, because miniz locates entries case-insensitive,
+            // and we keep that behavior
+            mz_uint numFiles = mz_zip_reader_get_num_files(&m_zip);
+            m_index.reserve(numFiles);
+            std::vector<char> nameBuf;
+            for (mz_uint i = 0; i < numFiles; i++)
+            {
+                if (mz_zip_reader_is_file_a_directory(&m_zip, i))
+                {
+                    continue;
+                }
+
+                // returned size includes the terminating zero
+                mz_uint nameSize = mz_zip_reader_get_filename(&m_zip, i, nullptr, 0);
+                nameBuf.resize(nameSize);
+                mz_zip_reader_get_filename(&m_zip, i, nameBuf.data(), nameSize);
+                m_index.emplace(toLower(std::string(nameBuf.data())), i);
+                m_names.emplace_back(nameBuf.data());
+            }
+
+            yourgame::log::debug("Archive: indexed %v entries of %v", m_index.size(), archivepath);
+
+            return 0;
+        }
+
+        // names of all files (not directories), in original case
+        const std::vector<std::string> &getNames() const
+        {
+            return m_names;
+        }
+
+        // m_index is not modified after open(), so no locking is required here
+        bool contains(const std::string &filename) const
+        {
+            return m_index.find(toLower(filename)) != m_index.end();
+        }
+
+        /* looks up filename and reads its (still compressed) data. this touches
+        the miniz reader and its file handle, so it is done while locked */
+        int fetch(const std::string &filename, Entry &dst)
+        {
+            statLookups++;
+            auto entry = m_index.find(toLower(filename));
+            if (entry == m_index.end())
+            {
+                statMisses++;
+                return -3;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!mz_zip_reader_file_stat(&m_zip, entry->second, &dst.stat) ||
+                !dst.stat.m_is_supported ||
+                (dst.stat.m_method != 0 && dst.stat.m_method != MZ_DEFLATED))
+            {
+                return -3;
+            }
+
+            dst.compressed.resize(static_cast<size_t>(dst.stat.m_comp_size));
+            if (!mz_zip_reader_extract_to_mem(&m_zip,
+                                              entry->second,
+                                              dst.compressed.data(),
+                                              dst.compressed.size(),
+                                              MZ_ZIP_FLAG_COMPRESSED_DATA))
+            {
+                return -3;
+            }
+
+            return 0;
+        }
+
+        /* decompresses entry to dst. uses its own inflate state, so entries
+        can be decompressed in parallel, without locking */
+        static int inflate(Entry &entry, std::vector<uint8_t> &dst)
+        {
+            if (entry.stat.m_method == 0) // stored
+            {
+                dst.swap(entry.compressed);
+            }
+            else
+            {
+                dst.resize(static_cast<size_t>(entry.stat.m_uncomp_size));
+                size_t numBytes = 0;
+                if (!dst.empty())
+                {
+                    numBytes = tinfl_decompress_mem_to_mem(dst.data(),
+                                                           dst.size(),
+                                                           entry.compressed.data(),
+                                                           entry.compressed.size(),
+                                                           TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+                }
+                entry.compressed.clear();
+                entry.compressed.shrink_to_fit();
+
+                if (numBytes != dst.size())
+                {
+                    dst.clear();
+                    return -3;
+                }
+            }
+
+            if (mz_crc32(MZ_CRC32_INIT, dst.data(), dst.size()) != entry.stat.m_crc32)
+            {
+                dst.clear();
+                return -3;
+            }
+
+            return 0;
+        }
+
+        int read(const std::string &filename, std::vector<uint8_t> &dst)
+        {
+            Entry entry;
+            int ret = fetch(filename, entry);
+            if (ret != 0)
+            {
+                return ret;
+            }
+            return inflate(entry, dst);
+        }
+
+        /* iterative decompression of an entry, see ArchiveStream. the iterator
+        reads via the miniz reader and its file handle, so each call is done while locked */
+        mz_zip_reader_extract_iter_state *iterNew(const std::string &filename)
+        {
+            statLookups++;
+            auto entry = m_index.find(toLower(filename));
+            if (entry == m_index.end())
+            {
+                statMisses++;
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return mz_zip_reader_extract_iter_new(&m_zip, entry->second, 0);
+        }
+
+        size_t iterRead(mz_zip_reader_extract_iter_state *iter, void *dst, size_t numBytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return mz_zip_reader_extract_iter_read(iter, dst, numBytes);
+        }
+
+        void iterFree(mz_zip_reader_extract_iter_state *iter)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            mz_zip_reader_extract_iter_free(iter);
+        }
+
+    private:
+        mz_zip_archive m_zip;
+        bool m_isOpen = false;
+        std::unordered_map<std::string, mz_uint> m_index;
+        std::vector<std::string> m_names;
+        std::mutex m_mutex;
+    };
+
+    /* a directory, an archive or a bundle, providing the files of a location (a//, p//) */
+    struct Mount
+    {
+        yourgame_internal::file::MountType type;
+        std::string path; // directories: with trailing '/'
+        std::unique_ptr<Archive> archive;
+        std::unique_ptr<yourgame_internal::file::Bundle> bundle;
+
+        // directories of archives and bundles, built on first use, see list()
+        yourgame_internal::file::DirTree tree;
+        std::once_flag treeOnce;
+
+        bool contains(const std::string &filename) const
+        {
+            switch (type)
+            {
+            case yourgame_internal::file::MountType::DIRECTORY:
+            {
+                struct stat st;
+                return (stat((path + filename).c_str(), &st) == 0);
+            }
+            case yourgame_internal::file::MountType::ARCHIVE:
+                return archive->contains(filename);
+            case yourgame_internal::file::MountType::BUNDLE:
+                return bundle->contains(filename);
+            default:
+                // platform file access can not be queried cheaply, assume the file exists
+                return true;
+            }
+        }
+
+        int read(const std::string &filename, std::vector<uint8_t> &dst) const
+        {
+            switch (type)
+            {
+            case yourgame_internal::file::MountType::DIRECTORY:
+                return yourgame_internal::file::readFileFromPath(path + filename, dst);
+            case yourgame_internal::file::MountType::ARCHIVE:
+                return archive->read(filename, dst);
+            case yourgame_internal::file::MountType::BUNDLE:
+                return bundle->read(filename, dst);
+            default:
+                return yourgame_internal::file::readFileFromPlatform(path + filename, dst);
+            }
+        }
+
+        int map(const std::string &filename, yourgame::file::FileView &dst) const
+        {
+            switch (type)
+            {
+            case yourgame_internal::file::MountType::DIRECTORY:
+                return yourgame_internal::file::mapFileFromPath(path + filename, dst);
+            case yourgame_internal::file::MountType::ARCHIVE:
+            {
+                // archive entries are extracted to a buffer, which is handed over to the view
+                std::vector<uint8_t> buffer;
+                int ret = archive->read(filename, buffer);
+                if (ret == 0)
+                {
+                    dst = yourgame::file::FileView(std::move(buffer));
+                }
+                return ret;
+            }
+            case yourgame_internal::file::MountType::BUNDLE:
+                return bundle->map(filename, dst);
+            default:
+                return yourgame_internal::file::mapFileFromPlatform(path + filename, dst);
+            }
+        }
+
+        /* calls fn for all entries of directory dir (relative, with trailing '/', or empty).
+        returns false, if the directory does not exist */
+        bool list(const std::string &dir, const std::function<void(const yourgame_internal::file::DirEntry &)> &fn)
+        {
+            switch (type)
+            {
+            case yourgame_internal::file::MountType::ARCHIVE:
+            case yourgame_internal::file::MountType::BUNDLE:
+            {
+                std::call_once(treeOnce, [this]()
+                               { yourgame_internal::file::buildDirTree(archive ? archive->getNames() : bundle->getNames(), tree); });
+                auto it = tree.find(toLower(dir));
+                if (it == tree.end())
+                {
+                    return false;
+                }
+                for (const auto &e : it->second)
+                {
+                    fn(e);
+                }
+                return true;
+            }
+            default:
+                // platform file access without a local path (android assets) can not be listed
+                if (type == yourgame_internal::file::MountType::PLATFORM && path.empty())
+                {
+                    return false;
+                }
+                return yourgame_internal::file::forEachDirEntry(path + dir, fn);
+            }
+        }
+    };
+
+    /* the mount table of a location (a//, p//): the base mount (asset directory,
+    project directory or archive), and overlays, which take precedence */
+    struct Location
+    {
+        std::shared_ptr<Mount> base;
+        std::vector<std::shared_ptr<Mount>> overlays; // last: highest precedence
+
+        // logical file name -> mount providing it. only used with overlays. only files found in
+        // archives or bundles (which do not change) are cached, if no directory overlay precedes them
+        std::unordered_map<std::string, std::shared_ptr<Mount>> cache;
+        uint64_t generation = 0; // of the mount table
+
+        // to be called when the mount table changes
+        void changed()
+        {
+            cache.clear();
+            generation++;
+        }
+    };
+
+    Location assetLocation;
+    Location projectLocation;
+
+    // guards the locations above
+    std::mutex vfsMutex;
+
+    Location *getLocation(char location)
+    {
+        switch (location)
+        {
+        case 'a':
+            return &assetLocation;
+        case 'p':
+            return &projectLocation;
+        default:
+            return nullptr;
+        }
+    }
+
+    // returns location ('a', 'p') of a prefix ("a//", "p//"), or 0
+    char getLocationFromPrefix(const std::string &prefix)
+    {
+        if (prefix.length() == 3 && prefix.compare(1, 2, "//") == 0 && getLocation(prefix[0]))
+        {
+            return prefix[0];
+        }
+        return 0;
+    }
+
+    std::shared_ptr<Mount> makeMount(const std::string &path, yourgame_internal::file::MountType type)
+    {
+        auto mount = std::make_shared<Mount>();
+        mount->type = type;
+        mount->path = path;
+        yourgame_internal::file::normalizePath(mount->path);
+
+        if (type == yourgame_internal::file::MountType::ARCHIVE)
+        {
+            mount->archive.reset(new Archive());
+            if (mount->archive->open(mount->path) != 0)
+            {
+                yourgame::log::error("failed to open archive %v", mount->path);
+                return nullptr;
+            }
+        }
+        else if (type == yourgame_internal::file::MountType::BUNDLE)
+        {
+            mount->bundle.reset(yourgame_internal::file::Bundle::open(mount->path));
+            if (!mount->bundle)
+            {
+                yourgame::log::error("failed to open bundle %v", mount->path);
+                return nullptr;
+            }
+        }
+        else if (!mount->path.empty() && mount->path.back() != '/')
+        {
+            mount->path += '/';
+        }
+
+        return mount;
+    }
+
+    /* returns the mount providing filename in location, or nullptr. with overlays,
+    hits in archives and bundles are cached, as long as the mount table is unchanged.
+    directory overlays are queried on each call (outside the lock), files might be added later */
+    std::shared_ptr<Mount> resolve(char location, const std::string &filename)
+    {
+        std::vector<std::shared_ptr<Mount>> overlays;
+        std::shared_ptr<Mount> mount;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(vfsMutex);
+
+            Location *loc = getLocation(location);
+            if (!loc)
+            {
+                return nullptr;
+            }
+
+            if (loc->overlays.empty())
+            {
+                return loc->base;
+            }
+
+            auto cached = loc->cache.find(filename);
+            if (cached != loc->cache.end())
+            {
+                return cached->second;
+            }
+
+            overlays = loc->overlays;
+            mount = loc->base;
+            generation = loc->generation;
+        }
+
+        // the base provides everything not provided by an overlay
+        bool cacheable = true;
+        for (auto it = overlays.rbegin(); it != overlays.rend(); ++it)
+        {
+            bool immutable = ((*it)->type == yourgame_internal::file::MountType::ARCHIVE ||
+                              (*it)->type == yourgame_internal::file::MountType::BUNDLE);
+            if ((*it)->contains(filename))
+            {
+                if (cacheable && immutable)
+                {
+                    std::lock_guard<std::mutex> lock(vfsMutex);
+                    Location *loc = getLocation(location);
+                    if (loc->generation == generation)
+                    {
+                        loc->cache.emplace(filename, *it);
+                    }
+                }
+                return *it;
+            }
+            cacheable = cacheable && immutable;
+        }
+
+        return mount;
+    }
+
+    int readFromLocation(char location, const std::string &filename, std::vector<uint8_t> &dst)
+    {
+        auto mount = resolve(location, filename);
+        if (!mount)
+        {
+            return -1;
+        }
+        return mount->read(filename, dst);
+    }
+
+    int mapFromLocation(char location, const std::string &filename, yourgame::file::FileView &dst)
+    {
+        auto mount = resolve(location, filename);
+        if (!mount)
+        {
+            return -1;
+        }
+        return mount->map(filename, dst);
+    }
+
+    /* a stream of a plain file */
+    class FileStream : public yourgame::file::Stream
+    {
+    public:
+        static FileStream *open(const std::string &path)
+        {
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0)
+            {
+                return nullptr;
+            }
+
+            std::FILE *file = std::fopen(path.c_str(), "rb");
+            if (!file)
+            {
+                return nullptr;
+            }
+
+            FileStream *stream = new FileStream();
+            stream->m_file = file;
+            stream->m_size = static_cast<uint64_t>(st.st_size);
+            return stream;
+        }
+
+        ~FileStream()
+        {
+            std::fclose(m_file);
+        }
+
+        size_t read(void *dst, size_t numBytes) override
+        {
+            size_t numRead = std::fread(dst, 1, numBytes, m_file);
+            m_pos += numRead;
+            return numRead;
+        }
+
+        int seek(uint64_t pos) override
+        {
+            if (pos > m_size)
+            {
+                return -1;
+            }
+#ifdef _WIN32
+            int ret = _fseeki64(m_file, static_cast<__int64>(pos), SEEK_SET);
+#else
+            int ret = fseeko(m_file, static_cast<off_t>(pos), SEEK_SET);
+#endif
+            if (ret != 0)
+            {
+                return -2;
+            }
+            m_pos = pos;
+            return 0;
+        }
+
+        uint64_t tell() const override
+        {
+            return m_pos;
+        }
+
+        uint64_t size() const override
+        {
+            return m_size;
+        }
+
+    private:
+        FileStream() {}
+        std::FILE *m_file = nullptr;
+        uint64_t m_size = 0;
+        uint64_t m_pos = 0;
+    };
+
+    /* a stream of an archive entry, decompressed incrementally. the stream keeps
+    the mount (and its archive) alive, even if it gets unmounted meanwhile */
+    class ArchiveStream : public yourgame::file::Stream
+    {
+    public:
+        static ArchiveStream *open(std::shared_ptr<Mount> mount, const std::string &filename)
+        {
+            mz_zip_reader_extract_iter_state *iter = mount->archive->iterNew(filename);
+            if (!iter)
+            {
+                return nullptr;
+            }
+
+            ArchiveStream *stream = new ArchiveStream();
+            stream->m_mount = mount;
+            stream->m_filename = filename;
+            stream->m_iter = iter;
+            stream->m_size = iter->file_stat.m_uncomp_size;
+            return stream;
+        }
+
+        ~ArchiveStream()
+        {
+            if (m_iter)
+            {
+                m_mount->archive->iterFree(m_iter);
+            }
+        }
+
+        size_t read(void *dst, size_t numBytes) override
+        {
+            if (!m_iter)
+            {
+                return 0;
+            }
+            size_t numRead = m_mount->archive->iterRead(m_iter, dst, numBytes);
+            m_pos += numRead;
+            return numRead;
+        }
+
+        /* deflated data can not be seeked in. seeking backwards restarts
+        decompression, seeking forwards decompresses (and discards) up to pos */
+        int seek(uint64_t pos) override
+        {
+            if (pos > m_size)
+            {
+                return -1;
+            }
+
+            if (pos < m_pos || !m_iter)
+            {
+                if (m_iter)
+                {
+                    m_mount->archive->iterFree(m_iter);
+                }
+                m_iter = m_mount->archive->iterNew(m_filename);
+                m_pos = 0;
+                if (!m_iter)
+                {
+                    return -2;
+                }
+            }
+
+            uint8_t skipBuf[4096];
+            while (m_pos < pos)
+            {
+                size_t numSkip = static_cast<size_t>(std::min<uint64_t>(sizeof(skipBuf), pos - m_pos));
+                if (read(skipBuf, numSkip) != numSkip)
+                {
+                    return -2;
+                }
+            }
+            return 0;
+        }
+
+        uint64_t tell() const override
+        {
+            return m_pos;
+        }
+
+        uint64_t size() const override
+        {
+            return m_size;
+        }
+
+    private:
+        ArchiveStream() {}
+        std::shared_ptr<Mount> m_mount;
+        std::string m_filename;
+        mz_zip_reader_extract_iter_state *m_iter = nullptr;
+        uint64_t m_size = 0;
+        uint64_t m_pos = 0;
+    };
+
+    /* a stream of a file view. used for stored bundle entries (mapped in place)
+    and for platform file access (android assets, web downloads), which provides
+    (mapped) whole files only */
+    class ViewStream : public yourgame::file::Stream
+    {
+    public:
+        explicit ViewStream(yourgame::file::FileView &&view) : m_view(std::move(view)) {}
+
+        size_t read(void *dst, size_t numBytes) override
+        {
+            size_t numRead = static_cast<size_t>(std::min<uint64_t>(numBytes, m_view.size() - m_pos));
+            if (numRead > 0)
+            {
+                std::memcpy(dst, m_view.data() + m_pos, numRead);
+            }
+            m_pos += numRead;
+            return numRead;
+        }
+
+        int seek(uint64_t pos) override
+        {
+            if (pos > m_view.size())
+            {
+                return -1;
+            }
+            m_pos = pos;
+            return 0;
+        }
+
+        uint64_t tell() const override
+        {
+            return m_pos;
+        }
+
+        uint64_t size() const override
+        {
+            return m_view.size();
+        }
+
+    private:
+        yourgame::file::FileView m_view;
+        uint64_t m_pos = 0;
+    };
+
+    /* a stream of a deflated bundle entry, inflated incrementally from the mapped
+    stored data. the output is buffered in the dictionary of the inflator (32 KiB) */
+    class InflateStream : public yourgame::file::Stream
+    {
+    public:
+        InflateStream(yourgame::file::FileView &&stored, uint64_t size, uint32_t crc32)
+            : m_stored(std::move(stored)), m_size(size), m_crc32(crc32), m_dict(TINFL_LZ_DICT_SIZE)
+        {
+            restart();
+        }
+
+        size_t read(void *dst, size_t numBytes) override
+        {
+            uint8_t *out = static_cast<uint8_t *>(dst);
+            size_t numRead = 0;
+            while (numRead < numBytes)
+            {
+                if (m_outBegin < m_outEnd)
+                {
+                    size_t numCopy = std::min(numBytes - numRead, m_outEnd - m_outBegin);
+                    std::memcpy(out + numRead, m_dict.data() + m_outBegin, numCopy);
+                    m_outBegin += numCopy;
+                    numRead += numCopy;
+                    continue;
+                }
+                if (m_status != TINFL_STATUS_HAS_MORE_OUTPUT && m_status != TINFL_STATUS_NEEDS_MORE_INPUT)
+                {
+                    break; // done, or failed
+                }
+
+                // all input is available, the output wraps around the dictionary
+                size_t inBytes = m_stored.size() - m_inPos;
+                size_t outBytes = m_dict.size() - m_dictPos;
+                m_status = tinfl_decompress(&m_inflator,
+                                            m_stored.data() + m_inPos, &inBytes,
+                                            m_dict.data(), m_dict.data() + m_dictPos, &outBytes,
+                                            0);
+                m_inPos += inBytes;
+                m_outBegin = m_dictPos;
+                m_outEnd = m_dictPos + outBytes;
+                m_dictPos = (m_dictPos + outBytes) & (m_dict.size() - 1);
+                m_crc = static_cast<uint32_t>(mz_crc32(m_crc, m_dict.data() + m_outBegin, outBytes));
+
+                if (m_status == TINFL_STATUS_NEEDS_MORE_INPUT && inBytes == 0 && outBytes == 0)
+                {
+                    m_status = TINFL_STATUS_FAILED; // truncated
+                }
+                if (m_status < TINFL_STATUS_DONE ||
+                    (m_status == TINFL_STATUS_DONE && (m_pos + numRead + outBytes != m_size || m_crc != m_crc32)))
+                {
+                    yourgame::log::error("Stream: failed to inflate bundle entry");
+                    m_status = TINFL_STATUS_FAILED;
+                    m_outEnd = m_outBegin;
+                }
+            }
+            m_pos += numRead;
+            return numRead;
+        }
+
+        /* deflated data can not be seeked in. seeking backwards restarts
+        decompression, seeking forwards decompresses (and discards) up to pos */
+        int seek(uint64_t pos) override
+        {
+            if (pos > m_size)
+            {
+                return -1;
+            }
+
+            if (pos < m_pos)
+            {
+                restart();
+            }
+
+            uint8_t skipBuf[4096];
+            while (m_pos < pos)
+            {
+                size_t numSkip = static_cast<size_t>(std::min<uint64_t>(sizeof(skipBuf), pos - m_pos));
+                if (read(skipBuf, numSkip) != numSkip)
+                {
+                    return -2;
+                }
+            }
+            return 0;
+        }
+
+        uint64_t tell() const override
+        {
+            return m_pos;
+        }
+
+        uint64_t size() const override
+        {
+            return m_size;
+        }
+
+    private:
+        void restart()
+        {
+            tinfl_init(&m_inflator);
+            m_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+            m_inPos = 0;
+            m_dictPos = 0;
+            m_outBegin = 0;
+            m_outEnd = 0;
+            m_crc = MZ_CRC32_INIT;
+            m_pos = 0;
+        }
+
+        yourgame::file::FileView m_stored;
+        uint64_t m_size = 0;
+        uint32_t m_crc32 = 0;
+        std::vector<uint8_t> m_dict; // power of 2
+        tinfl_decompressor m_inflator;
+        tinfl_status m_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+        size_t m_inPos = 0;
+        size_t m_dictPos = 0;
+        size_t m_outBegin = 0; // not yet read output, in m_dict
+        size_t m_outEnd = 0;
+        uint32_t m_crc = MZ_CRC32_INIT;
+        uint64_t m_pos = 0;
+    };
+
+    yourgame::file::Stream *openStreamFromLocation(char location, const std::string &filename)
+    {
+        auto mount = resolve(location, filename);
+        if (!mount)
+        {
+            return nullptr;
+        }
+
+        switch (mount->type)
+        {
+        case yourgame_internal::file::MountType::DIRECTORY:
+            return FileStream::open(mount->path + filename);
+        case yourgame_internal::file::MountType::ARCHIVE:
+            return ArchiveStream::open(mount, filename);
+        case yourgame_internal::file::MountType::BUNDLE:
+        {
+            yourgame::file::FileView stored;
+            bool deflated = false;
+            uint64_t size = 0;
+            uint32_t crc32 = 0;
+            if (mount->bundle->mapStored(filename, stored, deflated, size, crc32) != 0)
+            {
+                return nullptr;
+            }
+            if (deflated)
+            {
+                return new InflateStream(std::move(stored), size, crc32);
+            }
+            if (stored.size() != size)
+            {
+                return nullptr;
+            }
+            return new ViewStream(std::move(stored));
+        }
+        default:
+        {
+            yourgame::file::FileView view;
+            if (mount->map(filename, view) != 0)
+            {
+                return nullptr;
+            }
+            return new ViewStream(std::move(view));
+        }
+        }
+    }
+
+    // completions of asynchronous reads and writes, run on the main thread: by tick() (via postToMain()),
+    // or by waitAsyncReads() and flushWrites(), which do not run unrelated functions queued for the main thread
+    std::mutex completionMutex;
+    std::condition_variable completionCv;
+    std::deque<std::function<void()>> completions;
+
+    void runCompletions()
+    {
+        std::deque<std::function<void()>> fns;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            fns.swap(completions);
+        }
+        for (auto &fn : fns)
+        {
+            fn();
+        }
+    }
+
+    // can be called from any thread
+    void postCompletion(std::function<void()> fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back(std::move(fn));
+        }
+        completionCv.notify_all();
+        yourgame_internal::worker::postToMain(runCompletions);
+    }
+
+    // waits for completions (or a short timeout) and runs them. without worker
+    // threads, runs a pending job instead of waiting
+    void waitCompletions()
+    {
+        if (yourgame_internal::worker::getNumThreads() == 0)
+        {
+            yourgame_internal::worker::waitForMain();
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(completionMutex);
+            completionCv.wait_for(lock, std::chrono::milliseconds(10), []
+                                  { return !completions.empty(); });
+        }
+        runCompletions();
+    }
+
+    // write-behind queue, see writeFileAsync(). guarded by writeMutex
+    struct QueuedWrite
+    {
+        std::vector<uint8_t> data;
+        std::vector<std::function<void(int)>> callbacks; // of all coalesced writes
+        std::chrono::steady_clock::time_point requested; // of the first coalesced write
+    };
+
+    std::mutex writeMutex;
+    std::unordered_map<std::string, QueuedWrite> queuedWrites; // not started yet
+    std::unordered_set<std::string> writesInProgress;
+    size_t writesPending = 0; // queued, in progress, or waiting for delivery
+    yourgame::file::WriteStats writeStats;
+    double writeLatencySum = 0.0;
+
+    void postWrite(const std::string &filename);
+
+    // runs on a worker thread. writes the latest data queued for filename
+    void writeQueued(const std::string &filename)
+    {
+        QueuedWrite write;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            auto it = queuedWrites.find(filename);
+            write = std::move(it->second);
+            queuedWrites.erase(it);
+            writesInProgress.insert(filename);
+        }
+
+        int ret = yourgame::file::writeFile(filename, write.data.data(), write.data.size());
+        double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - write.requested).count();
+
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writesInProgress.erase(filename);
+
+            (ret == 0) ? writeStats.written++ : writeStats.failed++;
+            writeStats.lastLatency = latency;
+            writeStats.maxLatency = std::max(writeStats.maxLatency, latency);
+            writeLatencySum += latency;
+
+            // the file was requested to be written again meanwhile
+            if (queuedWrites.find(filename) != queuedWrites.end())
+            {
+                postWrite(filename);
+            }
+        }
+
+        // deliver on the main thread
+        auto callbacks = std::move(write.callbacks);
+        postCompletion(
+            [ret, callbacks]()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    writesPending--;
+                }
+                for (const auto &cb : callbacks)
+                {
+                    cb(ret);
+                }
+            });
+    }
+
+    // writes yield to reads (default priority 0)
+    void postWrite(const std::string &filename)
+    {
+        yourgame_internal::worker::post([filename]()
+                                        { writeQueued(filename); },
+                                        -1);
+    }
+
+    // asynchronous reads, see readFileAsync(). only accessed by the main thread
+    struct QueuedRead
+    {
+        std::shared_ptr<yourgame::file::AsyncRead> read;
+        std::function<void(yourgame::file::AsyncRead &)> callback;
+        int priority;
+        uint64_t seq;
+    };
+
+    // heap order: highest priority first, then FIFO
+    bool queuedReadLess(const QueuedRead &a, const QueuedRead &b)
+    {
+        return (a.priority < b.priority) || (a.priority == b.priority && a.seq > b.seq);
+    }
+
+    std::vector<QueuedRead> queuedReads; // heap, see queuedReadLess()
+    uint64_t queuedReadSeq = 0;
+    size_t readsInFlight = 0;
+    size_t readsInFlightLimit = 16;
+
+    // hands queued reads over to the worker threads, as long as
+    // the in-flight limit permits
+    void dispatchAsyncReads()
+    {
+        while (readsInFlight < readsInFlightLimit && !queuedReads.empty())
+        {
+            std::pop_heap(queuedReads.begin(), queuedReads.end(), queuedReadLess);
+            QueuedRead q = std::move(queuedReads.back());
+            queuedReads.pop_back();
+
+            readsInFlight++;
+
+            auto read = q.read;
+            auto callback = q.callback;
+            yourgame_internal::worker::post(
+                [read, callback]()
+                {
+                    read->result = yourgame::file::readFile(read->filename, read->data);
+
+                    // deliver on the main thread
+                    postCompletion(
+                        [read, callback]()
+                        {
+                            readsInFlight--;
+                            read->done = true;
+                            if (callback)
+                            {
+                                callback(*read);
+                            }
+                            dispatchAsyncReads();
+                        });
+                },
+                q.priority);
+        }
+    }
+
+    /* opens a new temporary file next to filepath, with a unique name: the process (clock at first
+    use) and a counter tell concurrent writers apart, exclusive creation ("x") rules out collisions */
+    std::FILE *openTmpFile(const std::string &filepath, std::string &tmpPath)
+    {
+        static const unsigned long long processToken =
+            (unsigned long long)std::chrono::system_clock::now().time_since_epoch().count();
+        static std::atomic<unsigned long long> counter(0);
+
+        for (int attempt = 0; attempt < 4; attempt++)
+        {
+            char suffix[48];
+            std::snprintf(suffix, sizeof(suffix), ".%llx.%llx.tmp", processToken, counter++);
+            tmpPath = filepath + suffix;
+            std::FILE *f = std::fopen(tmpPath.c_str(), "wbx");
+            if (f)
+            {
+                return f;
+            }
+        }
+        return nullptr;
+    }
+} // namespace
 
 namespace yourgame_internal
 {
@@ -51,46 +1124,115 @@ namespace yourgame_internal
             return -1;
         }
 
-        int readFileFromArchive(const std::string &archivepath, const std::string &filename, std::vector<uint8_t> &dst)
+        int setBaseMount(char location, const std::string &path, MountType type)
+        {
+            auto mount = makeMount(path, type);
+
+            std::lock_guard<std::mutex> lock(vfsMutex);
+            Location *loc = getLocation(location);
+            if (!loc)
+            {
+                return -1;
+            }
+
+            // on failure, the previous base is released anyway, like
+            // setting an invalid project path always did
+            loc->base = mount;
+            loc->changed();
+
+            return mount ? 0 : -2;
+        }
+
+        void unmountAll()
         {
-            mz_zip_archive zip_archive;
-            void *p;
-            size_t uncomp_size;
+            {
+                std::lock_guard<std::mutex> lock(vfsMutex);
+                for (auto loc : {&assetLocation, &projectLocation})
+                {
+                    loc->base = nullptr;
+                    loc->overlays.clear();
+                    loc->changed();
+                }
+            }
+            clearDirIndex();
+        }
 
-            std::memset(&zip_archive, 0, sizeof(zip_archive));
+        int mapFileFromPath(const std::string &filepath, yourgame::file::FileView &dst)
+        {
+#ifdef YOURGAME_FILE_MMAP
+            int fd = open(filepath.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return -1;
+            }
 
-            mz_bool status = mz_zip_reader_init_file(&zip_archive, archivepath.c_str(), 0);
-            if (!status)
+            struct stat st;
+            if (fstat(fd, &st) != 0)
             {
-                return -2;
+                close(fd);
+                return -1;
             }
 
-            p = mz_zip_reader_extract_file_to_heap(&zip_archive, filename.c_str(), &uncomp_size, 0);
-            if (!p)
+            // mmap() of zero bytes fails, an empty view is fine though
+            size_t numBytes = static_cast<size_t>(st.st_size);
+            if (numBytes == 0)
             {
-                mz_zip_reader_end(&zip_archive);
-                return -3;
+                close(fd);
+                dst = yourgame::file::FileView();
+                return 0;
             }
 
-            // Success
-            dst.assign(static_cast<uint8_t *>(p),
-                       static_cast<uint8_t *>(p) + uncomp_size);
-            mz_free(p);
+            void *p = mmap(nullptr, numBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            // the mapping stays valid after closing the file descriptor
+            close(fd);
+            if (p == MAP_FAILED)
+            {
+                return -1;
+            }
 
+            dst = yourgame::file::FileView(static_cast<const uint8_t *>(p),
+                                           numBytes,
+                                           [p, numBytes]()
+                                           { munmap(p, numBytes); });
             return 0;
+#else
+            std::vector<uint8_t> buffer;
+            int ret = readFileFromPath(filepath, buffer);
+            if (ret == 0)
+            {
+                dst = yourgame::file::FileView(std::move(buffer));
+            }
+            return ret;
+#endif
         }
 
         int writeFileToPath(const std::string &filepath, const void *data, size_t numBytes)
         {
-            int ret = -1;
-            std::FILE *f = std::fopen(filepath.c_str(), "wb");
-            if (f)
+            // write to a temporary file first, and replace the actual file on success,
+            // so an interrupted write never leaves a partially written file behind
+            std::string tmpPath;
+            std::FILE *f = openTmpFile(filepath, tmpPath);
+            if (!f)
             {
-                std::fwrite(data, 1, numBytes, f);
-                ret = std::ferror(f);
-                std::fclose(f);
+                return -1;
             }
-            return ret;
+
+            bool ok = (std::fwrite(data, 1, numBytes, f) == numBytes);
+            ok = (std::fclose(f) == 0) && ok;
+#ifdef _WIN32
+            // rename() does not replace existing files on windows. if removing fails, so does rename()
+            if (ok)
+            {
+                std::remove(filepath.c_str());
+            }
+#endif
+            ok = ok && (std::rename(tmpPath.c_str(), filepath.c_str()) == 0);
+            if (!ok)
+            {
+                std::remove(tmpPath.c_str());
+                return -1;
+            }
+            return 0;
         }
 
         bool checkIfPathIsDirectory(const std::string &filepath)
@@ -115,6 +1257,92 @@ namespace yourgame
 {
     namespace file
     {
+        FileView::FileView(const uint8_t *data, size_t numBytes, std::function<void()> release)
+            : m_data(data), m_size(numBytes), m_release(release) {}
+
+        FileView::FileView(std::vector<uint8_t> &&buffer)
+            : m_buffer(std::move(buffer))
+        {
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+
+        FileView::~FileView()
+        {
+            release();
+        }
+
+        FileView::FileView(FileView &&other)
+        {
+            *this = std::move(other);
+        }
+
+        FileView &FileView::operator=(FileView &&other)
+        {
+            if (this != &other)
+            {
+                release();
+
+                // moving a vector keeps its data pointer valid
+                m_buffer = std::move(other.m_buffer);
+                m_data = other.m_data;
+                m_size = other.m_size;
+                m_release = std::move(other.m_release);
+
+                other.m_data = nullptr;
+                other.m_size = 0;
+                other.m_release = nullptr;
+            }
+            return *this;
+        }
+
+        const uint8_t *FileView::data() const
+        {
+            return m_data;
+        }
+
+        size_t FileView::size() const
+        {
+            return m_size;
+        }
+
+        bool FileView::empty() const
+        {
+            return m_size == 0;
+        }
+
+        void FileView::release()
+        {
+            if (m_release)
+            {
+                m_release();
+                m_release = nullptr;
+            }
+            m_buffer.clear();
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        Stream *Stream::open(const std::string &filename)
+        {
+            if (filename.length() > 3 && filename.compare(1, 2, "//") == 0)
+            {
+                switch (filename[0])
+                {
+                case 'a':
+                case 'p':
+                    return openStreamFromLocation(filename[0], filename.substr(3, std::string::npos));
+                }
+            }
+
+            return FileStream::open(filename);
+        }
+
+        bool Stream::eof() const
+        {
+            return tell() >= size();
+        }
+
         int readFile(const std::string &filename, std::vector<uint8_t> &dst)
         {
             if (filename.length() > 3 && filename.compare(1, 2, "//") == 0)
@@ -131,65 +1359,207 @@ namespace yourgame
             return yourgame_internal::file::readFileFromPath(filename, dst);
         }
 
-        std::string getFileLocation(const std::string &filepath)
+        int readAssetFile(const std::string &filename, std::vector<uint8_t> &dst)
         {
-            // return location prefix (a// etc.)
-            if (filepath.length() > 3 && filepath.compare(1, 2, "//") == 0)
+            return readFromLocation('a', filename, dst);
+        }
+
+        int readProjectFile(const std::string &filename, std::vector<uint8_t> &dst)
+        {
+            return readFromLocation('p', filename, dst);
+        }
+
+        int readFiles(const std::vector<std::string> &filenames,
+                      std::vector<std::vector<uint8_t>> &dst,
+                      std::vector<int> *results)
+        {
+            dst.assign(filenames.size(), std::vector<uint8_t>());
+            std::vector<int> rets(filenames.size(), -1);
+            std::vector<Archive::Entry> entries(filenames.size());
+
+            // files provided by archives are looked up and read (compressed) right
+            // away, and decompressed in parallel. everything else is read in parallel.
+            std::vector<std::function<void()>> jobs;
+            for (size_t i = 0; i < filenames.size(); i++)
             {
-                return filepath.substr(0, 3);
+                const auto &f = filenames[i];
+                std::shared_ptr<Mount> mount;
+                if (f.length() > 3 && f.compare(1, 2, "//") == 0)
+                {
+                    mount = resolve(f[0], f.substr(3, std::string::npos));
+                }
+
+                if (mount && mount->type == yourgame_internal::file::MountType::ARCHIVE)
+                {
+                    rets[i] = mount->archive->fetch(f.substr(3, std::string::npos), entries[i]);
+                    if (rets[i] == 0)
+                    {
+                        jobs.push_back([i, &entries, &dst, &rets]()
+                                       { rets[i] = Archive::inflate(entries[i], dst[i]); });
+                    }
+                }
+                else
+                {
+                    jobs.push_back([i, &filenames, &dst, &rets]()
+                                   { rets[i] = readFile(filenames[i], dst[i]); });
+                }
+            }
+
+            yourgame_internal::worker::runAndWait(jobs, 1);
+
+            int numFailed = 0;
+            for (auto r : rets)
+            {
+                if (r != 0)
+                {
+                    numFailed++;
+                }
             }
 
-            // match 1: beginning until last "/"
-            static std::regex reFilePath(R"((.*\/|^).*$)");
-            std::smatch reMatches;
-            if (std::regex_match(filepath, reMatches, reFilePath) && reMatches.size() == 2)
+            if (results)
             {
-                return reMatches[1].str();
+                *results = rets;
             }
 
-            return "";
+            return numFailed;
         }
 
-        std::string getFileName(const std::string &filepath)
+        int mapFile(const std::string &filename, FileView &dst)
         {
-            // match 2: everything after last "/"
-            static std::regex reFilePath(R"((.*\/|^)(.*)$)");
-            std::smatch reMatches;
-            if (std::regex_match(filepath, reMatches, reFilePath) && reMatches.size() == 3)
+            if (filename.length() > 3 && filename.compare(1, 2, "//") == 0)
             {
-                return reMatches[2].str();
+                switch (filename[0])
+                {
+                case 'a':
+                    return mapAssetFile(filename.substr(3, std::string::npos), dst);
+                case 'p':
+                    return mapProjectFile(filename.substr(3, std::string::npos), dst);
+                }
             }
 
-            return "";
+            return yourgame_internal::file::mapFileFromPath(filename, dst);
         }
 
-        std::string getFileNameWithoutExtension(const std::string &filepath)
+        int mapAssetFile(const std::string &filename, FileView &dst)
+        {
+            return mapFromLocation('a', filename, dst);
+        }
+
+        int mapProjectFile(const std::string &filename, FileView &dst)
+        {
+            return mapFromLocation('p', filename, dst);
+        }
+
+        int mount(const std::string &path, const std::string &location)
+        {
+            char loc = getLocationFromPrefix(location);
+            if (!loc)
+            {
+                return -1;
+            }
+
+            std::string mountPath = path;
+            yourgame_internal::file::MountType type = yourgame_internal::file::MountType::DIRECTORY;
+            std::string ext = getFileExtension(mountPath);
+            if (ext == yourgame_internal::file::ARCHIVE_FILE_EXTENSION ||
+                ext == yourgame_internal::file::BUNDLE_FILE_EXTENSION)
+            {
+                type = (ext == yourgame_internal::file::BUNDLE_FILE_EXTENSION)
+                           ? yourgame_internal::file::MountType::BUNDLE
+                           : yourgame_internal::file::MountType::ARCHIVE;
+                if (yourgame_internal::file::fetchArchive(mountPath) != 0)
+                {
+                    return -2;
+                }
+            }
+#ifdef __EMSCRIPTEN__
+            else
+            {
+                // directories are not accessible from here, download files on request
+                type = yourgame_internal::file::MountType::PLATFORM;
+            }
+#endif
+
+            auto mount = makeMount(mountPath, type);
+            if (!mount)
+            {
+                return -2;
+            }
+
+            std::lock_guard<std::mutex> lock(vfsMutex);
+            Location *l = getLocation(loc);
+            l->overlays.push_back(mount);
+            l->changed();
+
+            return 0;
+        }
+
+        int unmount(const std::string &path, const std::string &location)
         {
-            // match 2: everything after last "/" and then
-            //   rest of filepath if there are no more ".", OR
-            //   everything before first ".", OR
-            //   file name starting with "."
-            static std::regex re(R"((^.*\/|^)([^.]+$|[^.]+|\..+$)(.*$))");
-            std::smatch reMatches;
-            if (std::regex_match(filepath, reMatches, re) && reMatches.size() == 4)
+            char loc = getLocationFromPrefix(location);
+            if (!loc)
+            {
+                return -1;
+            }
+
+            std::string mountPath = path;
+            yourgame_internal::file::normalizePath(mountPath);
+
+            std::lock_guard<std::mutex> lock(vfsMutex);
+            Location *l = getLocation(loc);
+
+            // remove the top-most overlay with this path (directories with or without trailing '/')
+            for (auto it = l->overlays.rbegin(); it != l->overlays.rend(); ++it)
             {
-                return reMatches[2].str();
+                if ((*it)->path == mountPath || (*it)->path == (mountPath + "/"))
+                {
+                    l->overlays.erase(std::next(it).base());
+                    l->changed();
+                    return 0;
+                }
             }
 
-            return "";
+            return -1;
         }
 
-        std::string getFileExtension(const std::string &filepath)
+        std::string getFileLocation(const std::string &filepath)
+        {
+            // return location prefix (a// etc.)
+            if (filepath.length() > 3 && filepath.compare(1, 2, "//") == 0)
+            {
+                return filepath.substr(0, 3);
+            }
+
+            // beginning until last "/"
+            size_t sep = filepath.find_last_of('/');
+            return (sep == std::string::npos) ? "" : filepath.substr(0, sep + 1);
+        }
+
+        std::string getFileName(const std::string &filepath)
+        {
+            // everything after last "/"
+            size_t sep = filepath.find_last_of('/');
+            return (sep == std::string::npos) ? filepath : filepath.substr(sep + 1);
+        }
+
+        std::string getFileNameWithoutExtension(const std::string &filepath)
         {
-            // match 2: everything after last "."
-            static std::regex reFilePath(R"((.*\.)(.*)$)");
-            std::smatch reMatches;
-            if (std::regex_match(filepath, reMatches, reFilePath) && reMatches.size() == 3)
+            // file name (see getFileName()), and then
+            //   file name starting with "." (hidden files), OR
+            //   everything before first "."
+            std::string name = getFileName(filepath);
+            if (name.size() > 1 && name[0] == '.')
             {
-                return reMatches[2].str();
+                return name;
             }
+            return name.substr(0, name.find('.'));
+        }
 
-            return "";
+        std::string getFileExtension(const std::string &filepath)
+        {
+            // everything after last "."
+            size_t dot = filepath.find_last_of('.');
+            return (dot == std::string::npos) ? "" : filepath.substr(dot + 1);
         }
 
         int writeFile(const std::string &filename, const void *data, size_t numBytes)
@@ -207,5 +1577,224 @@ namespace yourgame
 
             return -1;
         }
+
+        std::vector<std::string> ls(const std::string &pattern, bool recursive)
+        {
+            // if pattern has wildcards after the last "/", use that last part as a
+            // file filter, and everything until the last "/" as the actual path to list
+            std::string dir = pattern;
+            std::string filter;
+            size_t sep = pattern.find_last_of('/');
+            size_t nameBegin = (sep == std::string::npos) ? 0 : (sep + 1);
+            if (pattern.find_first_of("*?", nameBegin) != std::string::npos)
+            {
+                dir = pattern.substr(0, nameBegin);
+                filter = pattern.substr(nameBegin);
+            }
+
+            // the mounts providing the location (a//, p//), or a plain path
+            std::vector<std::shared_ptr<Mount>> mounts;
+            char loc = 0;
+            if (dir.length() >= 3 && dir.compare(1, 2, "//") == 0 && getLocation(dir[0]))
+            {
+                loc = dir[0];
+                dir = dir.substr(3);
+                std::lock_guard<std::mutex> lock(vfsMutex);
+                Location *l = getLocation(loc);
+                if (l->base)
+                {
+                    mounts.push_back(l->base);
+                }
+                mounts.insert(mounts.end(), l->overlays.begin(), l->overlays.end());
+            }
+            if (!dir.empty() && dir.back() != '/')
+            {
+                dir += '/';
+            }
+
+            std::vector<std::string> ret;
+            bool found = false;
+
+            // directories to list, relative to dir. subdirectories are appended, if recursive.
+            // a directory provided by several mounts is listed once (all mounts per directory)
+            std::vector<std::string> subdirs = {""};
+            std::unordered_set<std::string> knownSubdirs;
+            for (size_t i = 0; i < subdirs.size(); i++)
+            {
+                std::string subdir = subdirs[i];
+                auto addEntry = [&](const yourgame_internal::file::DirEntry &e)
+                {
+                    bool isDotEntry = e.name == "." || e.name == "..";
+                    if (isDotEntry && !subdir.empty())
+                    {
+                        // listed for the top level directory only
+                        return;
+                    }
+                    bool isDir = (e.suffix == '/') && !isDotEntry;
+                    if (recursive && isDir && knownSubdirs.insert(subdir + e.name + "/").second)
+                    {
+                        subdirs.push_back(subdir + e.name + "/");
+                    }
+                    if (filter.empty() || yourgame_internal::file::globMatch(filter.c_str(), e.name.c_str()))
+                    {
+                        ret.push_back(subdir + e.name);
+                        if (e.suffix != '\0')
+                        {
+                            ret.back() += e.suffix;
+                        }
+                    }
+                };
+
+                if (loc)
+                {
+                    for (auto &m : mounts)
+                    {
+                        found = m->list(dir + subdir, addEntry) || found;
+                    }
+                }
+                else
+                {
+                    found = yourgame_internal::file::forEachDirEntry(dir + subdir, addEntry) || found;
+                }
+            }
+
+            if (!found)
+            {
+                yourgame::log::error("ls(): failed to open directory: %v", pattern);
+            }
+
+            // snapshots are sorted already. merge the entries of multiple mounts or directories
+            if (mounts.size() > 1 || subdirs.size() > 1)
+            {
+                std::sort(ret.begin(), ret.end());
+                ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+            }
+
+            return ret;
+        }
+
+        ArchiveStats getArchiveStats()
+        {
+            ArchiveStats stats;
+            stats.opens = statOpens;
+            stats.lookups = statLookups;
+            stats.misses = statMisses;
+            return stats;
+        }
+
+        void resetArchiveStats()
+        {
+            statOpens = 0;
+            statLookups = 0;
+            statMisses = 0;
+        }
+
+        std::shared_ptr<AsyncRead> readFileAsync(const std::string &filename,
+                                                 std::function<void(AsyncRead &)> callback,
+                                                 int priority)
+        {
+            auto read = std::make_shared<AsyncRead>();
+            read->filename = filename;
+
+            queuedReads.push_back({read, callback, priority, queuedReadSeq++});
+            std::push_heap(queuedReads.begin(), queuedReads.end(), queuedReadLess);
+
+            dispatchAsyncReads();
+
+            return read;
+        }
+
+        void setAsyncReadLimit(size_t maxInFlight)
+        {
+            readsInFlightLimit = (maxInFlight > 0) ? maxInFlight : 1;
+            dispatchAsyncReads();
+        }
+
+        size_t getNumAsyncReadsPending()
+        {
+            return queuedReads.size() + readsInFlight;
+        }
+
+        void waitAsyncReads()
+        {
+            while (getNumAsyncReadsPending() > 0)
+            {
+                waitCompletions();
+            }
+        }
+
+        void writeFileAsync(const std::string &filename,
+                            std::vector<uint8_t> &&data,
+                            std::function<void(int)> callback)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            auto it = queuedWrites.find(filename);
+            if (it != queuedWrites.end())
+            {
+                // not started yet: replace the data, the file is written once
+                it->second.data = std::move(data);
+                writeStats.coalesced++;
+            }
+            else
+            {
+                it = queuedWrites.emplace(filename, QueuedWrite()).first;
+                it->second.data = std::move(data);
+                it->second.requested = std::chrono::steady_clock::now();
+                writesPending++;
+
+                // files being written are written again, as soon as finished (see writeQueued())
+                if (writesInProgress.find(filename) == writesInProgress.end())
+                {
+                    postWrite(filename);
+                }
+            }
+
+            if (callback)
+            {
+                it->second.callbacks.push_back(callback);
+            }
+        }
+
+        void writeFileAsync(const std::string &filename,
+                            const void *data,
+                            size_t numBytes,
+                            std::function<void(int)> callback)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            writeFileAsync(filename, std::vector<uint8_t>(bytes, bytes + numBytes), callback);
+        }
+
+        void flushWrites()
+        {
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    if (writesPending == 0)
+                    {
+                        break;
+                    }
+                }
+                waitCompletions();
+            }
+        }
+
+        WriteStats getWriteStats()
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            WriteStats stats = writeStats;
+            stats.pending = writesPending;
+            uint64_t numFinished = stats.written + stats.failed;
+            stats.meanLatency = (numFinished > 0) ? (writeLatencySum / numFinished) : 0.0;
+            return stats;
+        }
+
+        void resetWriteStats()
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writeStats = WriteStats();
+            writeLatencySum = 0.0;
+        }
     } // namespace file
 } // namespace yourgame
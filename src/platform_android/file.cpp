@@ -38,8 +38,56 @@ namespace yourgame_internal
             void initFile(struct android_app *app)
             {
                 assMan = app->activity->assetManager;
+
+                // assets are read via the asset manager
+                yourgame_internal::file::setBaseMount('a', "", MountType::PLATFORM);
             }
         } // namespace android
+
+        int readFileFromPlatform(const std::string &filepath, std::vector<uint8_t> &dst)
+        {
+            AAsset *assDesc = AAssetManager_open(assMan,
+                                                 filepath.c_str(),
+                                                 AASSET_MODE_BUFFER);
+            if (assDesc)
+            {
+                auto nBytes = AAsset_getLength(assDesc);
+                dst.resize(nBytes);
+                int64_t nBytesRead = AAsset_read(assDesc, dst.data(), dst.size());
+                AAsset_close(assDesc);
+                return 0;
+            }
+            // todo: check dst.size() against nBytesRead and handle error case
+            return -1;
+        }
+
+        int mapFileFromPlatform(const std::string &filepath, yourgame::file::FileView &dst)
+        {
+            AAsset *assDesc = AAssetManager_open(assMan,
+                                                 filepath.c_str(),
+                                                 AASSET_MODE_BUFFER);
+            if (assDesc)
+            {
+                // the buffer is owned by the asset, so keep it open
+                // until the view is released
+                const void *buf = AAsset_getBuffer(assDesc);
+                if (buf)
+                {
+                    dst = yourgame::file::FileView(static_cast<const uint8_t *>(buf),
+                                                   static_cast<size_t>(AAsset_getLength(assDesc)),
+                                                   [assDesc]()
+                                                   { AAsset_close(assDesc); });
+                    return 0;
+                }
+                AAsset_close(assDesc);
+            }
+            return -1;
+        }
+
+        int fetchArchive(std::string & /* archivepath */)
+        {
+            return 0;
+        }
     } // namespace file
 } // namespace yourgame_internal
 
@@ -62,28 +110,6 @@ namespace yourgame
             return "";
         }
 
-        int readAssetFile(const std::string &filename, std::vector<uint8_t> &dst)
-        {
-            AAsset *assDesc = AAssetManager_open(assMan,
-                                                 filename.c_str(),
-                                                 AASSET_MODE_BUFFER);
-            if (assDesc)
-            {
-                auto nBytes = AAsset_getLength(assDesc);
-                dst.resize(nBytes);
-                int64_t nBytesRead = AAsset_read(assDesc, dst.data(), dst.size());
-                AAsset_close(assDesc);
-                return 0;
-            }
-            // todo: check dst.size() against nBytesRead and handle error case
-            return -1;
-        }
-
-        int readProjectFile(const std::string &filename, std::vector<uint8_t> &dst)
-        {
-            return -1;
-        }
-
         int writeAssetFile(const std::string &filename, const void *data, size_t numBytes)
         {
             return -1;
@@ -97,11 +123,5 @@ namespace yourgame
         void setProjectPath(const std::string &path)
         {
         }
-
-        std::vector<std::string> ls(const std::string &pattern)
-        {
-            std::vector<std::string> ret;
-            return ret;
-        }
     } // namespace file
 } // namespace yourgame
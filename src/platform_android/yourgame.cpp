@@ -29,11 +29,13 @@ freely, subject to the following restrictions:
 #include "yourgame/yourgame.h"
 #include "yourgame/gl_include.h"
 #include "yourgame_internal/mygame_external.h"
+#include "yourgame_internal/file.h"
 #include "yourgame_internal/file_android.h"
 #include "yourgame_internal/input.h"
 #include "yourgame_internal/input_android.h"
 #include "yourgame_internal/log.h"
 #include "yourgame_internal/time.h"
+#include "yourgame_internal/worker.h"
 #ifdef YOURGAME_TOOLBOX
 #include "yourgame_internal/gl/init.h"
 #include "yourgame_internal/util/assets.h"
@@ -226,6 +228,9 @@ namespace yourgame_internal
         // timing
         yourgame_internal::time::tick();
 
+        // deliver completions of worker jobs (async file reads, etc.)
+        yourgame_internal::worker::tick();
+
         if (_display != EGL_NO_DISPLAY)
         {
             // update window size in yourgame
@@ -266,6 +271,9 @@ namespace yourgame_internal
 
         int ret = mygame::shutdown();
 
+        yourgame_internal::worker::shutdown();
+        yourgame_internal::file::unmountAll();
+
 #ifdef YOURGAME_EXTPROJ_imgui
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplAndroid_Shutdown();
@@ -17,10 +17,9 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
-#include <algorithm> // std::sort()
 #include <string>
+#include <utility>
 #include <vector>
-#include <regex>
 #include "dirent.h"
 #ifndef __EMSCRIPTEN__
 #include "whereami.h"
@@ -92,47 +91,80 @@ namespace yourgame_internal
                     }
                 }
 #endif
+
+#ifdef __EMSCRIPTEN__
+                yourgame_internal::file::setBaseMount('a', assetPathAbs, MountType::PLATFORM);
+#else
+                yourgame_internal::file::setBaseMount('a', assetPathAbs, MountType::DIRECTORY);
+#endif
             }
         } // namespace desktop
-    } // namespace file
-} // namespace yourgame_internal
-
-namespace yourgame
-{
-    namespace file
-    {
-        std::string getAssetFilePath(const std::string &pathRelative)
-        {
-            return assetPathAbs + pathRelative;
-        }
 
-        std::string getBasePath(const std::string &pathRelative)
+        int readFileFromPlatform(const std::string &filepath, std::vector<uint8_t> &dst)
         {
-            return basePathAbs + pathRelative;
+#ifdef __EMSCRIPTEN__
+            return wgetData(filepath, dst);
+#else
+            return readFileFromPath(filepath, dst);
+#endif
         }
 
-        int readAssetFile(const std::string &filename, std::vector<uint8_t> &dst)
+        int mapFileFromPlatform(const std::string &filepath, yourgame::file::FileView &dst)
         {
 #ifdef __EMSCRIPTEN__
-            return wgetData(assetPathAbs + filename, dst);
+            std::vector<uint8_t> buffer;
+            int ret = wgetData(filepath, buffer);
+            if (ret == 0)
+            {
+                dst = yourgame::file::FileView(std::move(buffer));
+            }
+            return ret;
 #else
-            return (yourgame_internal::file::readFileFromPath(assetPathAbs + filename, dst));
+            return mapFileFromPath(filepath, dst);
 #endif
         }
 
-        int readProjectFile(const std::string &filename, std::vector<uint8_t> &dst)
+        int fetchArchive(std::string &archivepath)
         {
-            // Assuming projectPath points to an archive file
-            if (getFileExtension(projectPath) == yourgame_internal::file::ARCHIVE_FILE_EXTENSION)
+#ifdef __EMSCRIPTEN__
+            // archives can not be opened remotely. we download it
+            // to transient memory and adjust the archivepath
+            std::vector<uint8_t> archiveData;
+            if (wgetData(archivepath, archiveData) != 0)
             {
-                return yourgame_internal::file::readFileFromArchive(projectPath, filename, dst);
+                yourgame::log::error("fetchArchive(): failed to download archive file %v", archivepath);
+                return -1;
             }
 
-#ifdef __EMSCRIPTEN__
-            return wgetData(projectPath + filename, dst);
+            std::string localPath = "/home/web_user/" + yourgame::file::getFileName(archivepath);
+            if (writeFileToPath(localPath, archiveData.data(), archiveData.size()) != 0)
+            {
+                yourgame::log::error("fetchArchive(): failed to save archive file %v", localPath);
+                return -1;
+            }
+
+            yourgame::log::info("fetchArchive(): saved archive file to %v", localPath);
+            archivepath = localPath;
 #else
-            return yourgame_internal::file::readFileFromPath(projectPath + filename, dst);
+            (void)archivepath;
 #endif
+            return 0;
+        }
+    } // namespace file
+} // namespace yourgame_internal
+
+namespace yourgame
+{
+    namespace file
+    {
+        std::string getAssetFilePath(const std::string &pathRelative)
+        {
+            return assetPathAbs + pathRelative;
+        }
+
+        std::string getBasePath(const std::string &pathRelative)
+        {
+            return basePathAbs + pathRelative;
         }
 
         void setProjectPath(const std::string &path)
@@ -146,34 +178,34 @@ namespace yourgame
             yourgame_internal::file::normalizePath(projectPath);
 
             // Assuming directory path. Append '/'
-            if (getFileExtension(projectPath) != yourgame_internal::file::ARCHIVE_FILE_EXTENSION)
+            std::string ext = getFileExtension(projectPath);
+            if (ext != yourgame_internal::file::ARCHIVE_FILE_EXTENSION &&
+                ext != yourgame_internal::file::BUNDLE_FILE_EXTENSION)
             {
                 if (projectPath.back() != '/')
                 {
                     projectPath += '/';
                 }
+
+#ifdef __EMSCRIPTEN__
+                yourgame_internal::file::setBaseMount('p', projectPath, yourgame_internal::file::MountType::PLATFORM);
+#else
+                yourgame_internal::file::setBaseMount('p', projectPath, yourgame_internal::file::MountType::DIRECTORY);
+#endif
             }
-            // Assuming archive path. On platform web: if the project path is an archive,
-            // we download it to transient memory and adjust the projectPath
+            // Assuming archive (or bundle) path. The archive is opened and indexed once, and
+            // kept open for all subsequent readProjectFile() calls. On platform web,
+            // the archive is downloaded first, and projectPath is adjusted
             else
             {
-#ifdef __EMSCRIPTEN__
-                std::vector<uint8_t> archiveData;
-                if (wgetData(projectPath, archiveData) == 0)
-                {
-                    projectPath = "/home/web_user/" + getFileName(projectPath);
-
-                    yourgame_internal::file::writeFileToPath(projectPath,
-                                                             archiveData.data(),
-                                                             archiveData.size());
-
-                    yourgame::log::info("setProjectPath(): saved project archive file to %v", projectPath);
-                }
-                else
+                yourgame_internal::file::fetchArchive(projectPath);
+                auto type = (ext == yourgame_internal::file::BUNDLE_FILE_EXTENSION)
+                                ? yourgame_internal::file::MountType::BUNDLE
+                                : yourgame_internal::file::MountType::ARCHIVE;
+                if (yourgame_internal::file::setBaseMount('p', projectPath, type) != 0)
                 {
-                    yourgame::log::error("setProjectPath(): failed to save project archive file %v", getFileName(projectPath));
+                    yourgame::log::error("setProjectPath(): failed to open project archive file %v", projectPath);
                 }
-#endif
             }
         }
 
@@ -191,84 +223,5 @@ namespace yourgame
         {
             return yourgame_internal::file::writeFileToPath(assetPathAbs + filename, data, numBytes);
         }
-
-        std::vector<std::string> ls(const std::string &pattern)
-        {
-            std::vector<std::string> ret;
-            std::string pathToOpen = pattern;
-
-            // step 1: if pattern has a file location prefix (like a//),
-            // replace it with the appropriate absolut path
-            if (pathToOpen.length() >= 3 && pathToOpen.compare(1, 2, "//") == 0)
-            {
-                switch (pathToOpen[0])
-                {
-                case 'a':
-                    // substr() returns empty string if pos == length.
-                    pathToOpen = (assetPathAbs + pathToOpen.substr(3, std::string::npos));
-                    break;
-                case 'p':
-                    // substr() returns empty string if pos == length.
-                    pathToOpen = (projectPath + pathToOpen.substr(3, std::string::npos));
-                    break;
-                }
-            }
-
-            std::regex reFileFilter("^.*$");
-
-            // step 2: check if pathToOpen has one or more "*" after the last "/".
-            //   if so, use that last part as a file filter, and everything until the last "/" as the actual path to open.
-            //   otherwise, leave pathToOpen unchanged.
-            static std::regex reLsPattern(R"((.*\/|^)(.*\*[^\/\n]*)$)"); // match 0: full string,
-                                                                         // 1: beginning until last "/",
-                                                                         // 2: everything after last "/" (if it contains one or more "*")
-            std::smatch reMatches;
-            std::string tmp = pathToOpen;
-            if (std::regex_match(tmp, reMatches, reLsPattern) && reMatches.size() == 3)
-            {
-                pathToOpen = reMatches[1].str();
-                std::string filePattern = reMatches[2].str();
-                filePattern = std::regex_replace(filePattern, std::regex("\\."), "\\.");
-                filePattern = std::regex_replace(filePattern, std::regex("\\*"), ".*");
-                // todo ensure filePattern is a valid regex
-                reFileFilter = std::regex(std::string("^") + filePattern + "$");
-            }
-
-            // try to open the path
-            DIR *dir = opendir(pathToOpen.c_str());
-            if (!dir)
-            {
-                yourgame::log::error("ls(): failed to open directory: %v", pathToOpen);
-            }
-            else
-            {
-                struct dirent *ent;
-                while ((ent = readdir(dir)) != NULL)
-                {
-                    if (std::regex_match(ent->d_name, reFileFilter))
-                    {
-                        switch (ent->d_type)
-                        {
-                        case DT_REG:
-                            ret.emplace_back(std::string(ent->d_name));
-                            break;
-                        case DT_DIR:
-                            ret.emplace_back(std::string(ent->d_name) + "/");
-                            break;
-                        case DT_LNK:
-                            ret.emplace_back(std::string(ent->d_name) + "@");
-                            break;
-                        default:
-                            ret.emplace_back(std::string(ent->d_name) + "*");
-                        }
-                    }
-                }
-
-                closedir(dir);
-            }
-
-            std::sort(ret.begin(), ret.end());
-            return ret;
-        }
     } // namespace file
 } // namespace yourgame
@@ -33,11 +33,13 @@ freely, subject to the following restrictions:
 #endif
 #include "yourgame/yourgame.h"
 #include "yourgame_internal/mygame_external.h"
+#include "yourgame_internal/file.h"
 #include "yourgame_internal/file_desktop.h"
 #include "yourgame_internal/input.h"
 #include "yourgame_internal/input_desktop.h"
 #include "yourgame_internal/log.h"
 #include "yourgame_internal/time.h"
+#include "yourgame_internal/worker.h"
 #ifdef YOURGAME_TOOLBOX
 #include "yourgame_internal/gl/init.h"
 #include "yourgame_internal/util/assets.h"
@@ -99,6 +101,9 @@ namespace yourgame_internal
     {
         yourgame_internal::time::tick();
 
+        // deliver completions of worker jobs (async file reads, etc.)
+        yourgame_internal::worker::tick();
+
 #ifndef YOURGAME_CLIMODE
 #if defined(__EMSCRIPTEN__) && !defined(EMSCRIPTEN_USE_PORT_CONTRIB_GLFW3)
         {
@@ -154,6 +159,9 @@ namespace yourgame_internal
     {
         int ret = mygame::shutdown();
 
+        yourgame_internal::worker::shutdown();
+        yourgame_internal::file::unmountAll();
+
 #ifndef YOURGAME_CLIMODE
 #ifdef YOURGAME_EXTPROJ_imgui
         ImGui_ImplOpenGL3_Shutdown();
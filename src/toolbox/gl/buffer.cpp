@@ -17,6 +17,7 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <algorithm>
 #include "yourgame/gl_include.h"
 #include "yourgame/gl/buffer.h"
 
@@ -31,6 +32,8 @@ namespace yourgame
             glBindBuffer(target, handle);
             glBufferData(target, size, data, usage);
 
+#ifndef NDEBUG
+            // querying the size waits for the GL (debug builds only)
             GLint checkSize = -1;
             glGetBufferParameteriv(target, GL_BUFFER_SIZE, &checkSize);
             if (size != checkSize)
@@ -39,14 +42,15 @@ namespace yourgame
                 glDeleteBuffers(1, &handle);
                 return nullptr;
             }
-            else
-            {
-                Buffer *newBuf = new Buffer();
-                newBuf->m_target = target;
-                newBuf->m_handle = handle;
-                newBuf->m_usage = usage;
-                return newBuf;
-            }
+#endif
+
+            Buffer *newBuf = new Buffer();
+            newBuf->m_target = target;
+            newBuf->m_handle = handle;
+            newBuf->m_usage = usage;
+            newBuf->m_size = size;
+            newBuf->m_capacity = size;
+            return newBuf;
         }
 
         Buffer::~Buffer()
@@ -66,12 +70,142 @@ namespace yourgame
 
         bool Buffer::bufferData(GLsizeiptr size, const GLvoid *data)
         {
+            m_dirty.clear();
+            bool ok = true;
+            if (size > m_capacity)
+            {
+                ok = allocate(std::max(size, 2 * m_capacity), false);
+            }
+            else
+            {
+                // orphaning the storage avoids waiting for draw calls still reading from it
+                glBindBuffer(m_target, m_handle);
+                glBufferData(m_target, m_capacity, nullptr, m_usage);
+            }
+            m_size = size;
+
+            if (data && size > 0)
+            {
+                glBufferSubData(m_target, 0, size, data);
+            }
+            return ok;
+        }
+
+        bool Buffer::bufferSubData(GLintptr offset, GLsizeiptr size, const GLvoid *data)
+        {
+            if (offset < 0 || size < 0)
+            {
+                return false;
+            }
+
+            bool ok = true;
+            if (offset + size > m_capacity)
+            {
+                ok = allocate(std::max(offset + size, 2 * m_capacity), true);
+            }
+            else
+            {
+                glBindBuffer(m_target, m_handle);
+            }
+            m_size = std::max(m_size, offset + size);
+
+            if (data && size > 0)
+            {
+                glBufferSubData(m_target, offset, size, data);
+            }
+            return ok;
+        }
+
+        bool Buffer::reserve(GLsizeiptr capacity)
+        {
+            return (capacity <= m_capacity) || allocate(capacity, true);
+        }
+
+        void Buffer::markDirty(GLintptr offset, GLsizeiptr size)
+        {
+            if (offset >= 0 && size > 0)
+            {
+                m_dirty.push_back({offset, size});
+            }
+        }
+
+        bool Buffer::uploadDirty(const GLvoid *data, GLsizeiptr mergeGap)
+        {
+            if (m_dirty.empty())
+            {
+                return true;
+            }
+            if (!data)
+            {
+                m_dirty.clear();
+                return false;
+            }
+
+            std::sort(m_dirty.begin(), m_dirty.end());
             glBindBuffer(m_target, m_handle);
-            glBufferData(m_target, size, data, m_usage);
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+            auto upload = [&](GLintptr begin, GLintptr end)
+            {
+                end = std::min(end, (GLintptr)m_size);
+                if (end > begin)
+                {
+                    glBufferSubData(m_target, begin, end - begin, bytes + begin);
+                }
+            };
+
+            GLintptr begin = m_dirty.front().first;
+            GLintptr end = begin + m_dirty.front().second;
+            for (const auto &range : m_dirty)
+            {
+                if (range.first > end + mergeGap)
+                {
+                    upload(begin, end);
+                    begin = range.first;
+                }
+                end = std::max(end, (GLintptr)(range.first + range.second));
+            }
+            upload(begin, end);
+
+            m_dirty.clear();
+            return true;
+        }
+
+        bool Buffer::allocate(GLsizeiptr capacity, bool keepContent)
+        {
+            // the content is copied on the GPU via a temporary buffer
+            GLuint tmp = 0;
+            GLsizeiptr keep = keepContent ? std::min(m_size, capacity) : 0;
+            if (keep > 0)
+            {
+                glGenBuffers(1, &tmp);
+                glBindBuffer(GL_COPY_READ_BUFFER, m_handle);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, tmp);
+                glBufferData(GL_COPY_WRITE_BUFFER, keep, nullptr, GL_STREAM_COPY);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keep);
+            }
+
+            glBindBuffer(m_target, m_handle);
+            glBufferData(m_target, capacity, nullptr, m_usage);
+            m_capacity = capacity;
+
+            if (keep > 0)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, tmp);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_handle);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keep);
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                glDeleteBuffers(1, &tmp);
+            }
 
+#ifndef NDEBUG
             GLint checkSize = -1;
             glGetBufferParameteriv(m_target, GL_BUFFER_SIZE, &checkSize);
-            return (size == checkSize);
+            return (capacity == checkSize);
+#else
+            return true;
+#endif
         }
     } // namespace gl
 } // namespace yourgame
@@ -37,12 +37,20 @@ namespace yourgame
             {
                 GLint unif;
 
+                // quantized positions: attribute space to object space
+                glm::mat4 modelMat = cfg.modelMat;
+                if (geo->hasPositionDequantization())
+                {
+                    modelMat = glm::translate(modelMat, glm::make_vec3(geo->getPositionOffset()));
+                    modelMat = glm::scale(modelMat, glm::make_vec3(geo->getPositionScale()));
+                }
+
                 // mvp matrix
                 unif = cfg.shader->getUniformLocation(gl::unifNameMvpMatrix);
                 if (unif != -1)
                 {
-                    auto mvp = cfg.camera ? (cfg.camera->pMat() * cfg.camera->vMat() * cfg.modelMat)
-                                          : cfg.modelMat;
+                    auto mvp = cfg.camera ? (cfg.camera->pMat() * cfg.camera->vMat() * modelMat)
+                                          : modelMat;
                     glUniformMatrix4fv(unif, 1, GL_FALSE, glm::value_ptr(mvp));
                 }
 
@@ -50,10 +58,10 @@ namespace yourgame
                 unif = cfg.shader->getUniformLocation(gl::unifNameModelMatrix);
                 if (unif != -1)
                 {
-                    glUniformMatrix4fv(unif, 1, GL_FALSE, glm::value_ptr(cfg.modelMat));
+                    glUniformMatrix4fv(unif, 1, GL_FALSE, glm::value_ptr(modelMat));
                 }
 
-                // normal matrix
+                // normal matrix (normals are not affected by the dequantization of positions)
                 unif = cfg.shader->getUniformLocation(gl::unifNameNormalMatrix);
                 if (unif != -1)
                 {
@@ -80,14 +88,60 @@ namespace yourgame
             }
 
             // draw call
+            size_t lod = selectLod(geo, cfg);
             if (cfg.instancecount > 1)
             {
-                geo->drawAllInstanced(cfg.instancecount);
+                geo->drawAllInstanced(cfg.instancecount, lod);
             }
             else
             {
-                geo->drawAll();
+                geo->drawAll(lod);
+            }
+        }
+
+        size_t selectLod(const yourgame::gl::Geometry *geo, const yourgame::gl::DrawConfig &cfg)
+        {
+            if (cfg.lod >= 0)
+            {
+                return (size_t)cfg.lod;
+            }
+
+            const auto &lodErrors = geo->getLodErrors();
+            if (lodErrors.size() < 2 || !cfg.camera)
+            {
+                return 0;
+            }
+
+            // bounding sphere in view space
+            glm::vec3 bMin = glm::make_vec3(geo->getBoundsMin());
+            glm::vec3 bMax = glm::make_vec3(geo->getBoundsMax());
+            glm::vec4 center = cfg.camera->vMat() * cfg.modelMat * glm::vec4(0.5f * (bMin + bMax), 1.0f);
+            float modelScale = std::max(glm::length(glm::vec3(cfg.modelMat[0])),
+                                        std::max(glm::length(glm::vec3(cfg.modelMat[1])),
+                                                 glm::length(glm::vec3(cfg.modelMat[2]))));
+            float radius = 0.5f * glm::length(bMax - bMin) * modelScale;
+
+            // projected size of one unit (view space), relative to the viewport height
+            glm::mat4 pMat = cfg.camera->pMat();
+            float unitScreenSize = 0.5f * pMat[1][1];
+            if (pMat[3][3] == 0.0f) // perspective
+            {
+                float depth = -center.z - radius;
+                if (depth <= 0.0f)
+                {
+                    return 0;
+                }
+                unitScreenSize /= depth;
+            }
+
+            for (size_t lod = lodErrors.size() - 1; lod > 0; lod--)
+            {
+                if (lodErrors[lod] * modelScale * unitScreenSize <= cfg.lodMaxScreenError)
+                {
+                    return lod;
+                }
             }
+            return 0;
         }
 
         std::array<float, 4> drawSprite(yourgame::gl::Texture *texture,
@@ -17,6 +17,7 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <algorithm>
 #include "yourgame/gl/geometry.h"
 
 namespace yourgame
@@ -35,6 +36,11 @@ namespace yourgame
                 delete b.second;
             }
 
+            for (const auto &b : m_streamBuffers)
+            {
+                delete b.second;
+            }
+
             for (const auto &s : m_shapes)
             {
                 delete s.second;
@@ -56,6 +62,27 @@ namespace yourgame
             return false;
         }
 
+        bool Geometry::addStreamBuffer(std::string name, GLenum target, GLsizeiptr regionSize, GLuint numRegions)
+        {
+            if (!m_buffers.count(name) && !m_streamBuffers.count(name))
+            {
+                StreamBuffer *newBuffer = StreamBuffer::make(target, regionSize, numRegions);
+                if (newBuffer)
+                {
+                    m_streamBuffers.insert(std::pair<std::string, StreamBuffer *>(name, newBuffer));
+                    return true;
+                }
+                return false;
+            }
+            return false;
+        }
+
+        StreamBuffer *Geometry::getStreamBuffer(std::string name)
+        {
+            auto it = m_streamBuffers.find(name);
+            return (it != m_streamBuffers.end()) ? it->second : nullptr;
+        }
+
         bool Geometry::bufferData(std::string name, GLsizeiptr size, const GLvoid *data)
         {
             auto it = m_buffers.find(name);
@@ -66,6 +93,37 @@ namespace yourgame
             return false;
         }
 
+        bool Geometry::bufferSubData(std::string name, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+        {
+            auto it = m_buffers.find(name);
+            if (it != m_buffers.end())
+            {
+                return it->second->bufferSubData(offset, size, data);
+            }
+            return false;
+        }
+
+        bool Geometry::markDirty(std::string name, GLintptr offset, GLsizeiptr size)
+        {
+            auto it = m_buffers.find(name);
+            if (it != m_buffers.end())
+            {
+                it->second->markDirty(offset, size);
+                return true;
+            }
+            return false;
+        }
+
+        bool Geometry::uploadDirty(std::string name, const GLvoid *data, GLsizeiptr mergeGap)
+        {
+            auto it = m_buffers.find(name);
+            if (it != m_buffers.end())
+            {
+                return it->second->uploadDirty(data, mergeGap);
+            }
+            return false;
+        }
+
         bool Geometry::addShape(std::string name,
                                 std::vector<Shape::ArrBufferDescr> arDescrs,
                                 std::vector<std::string> arBufferNames,
@@ -105,7 +163,8 @@ namespace yourgame
                 auto numArDescrs = arDescrs.size();
                 if (numArDescrs > 0)
                 {
-                    it->second->addArrBuf(arDescrs[0], m_buffers[bufferName]);
+                    auto stream = m_streamBuffers.find(bufferName);
+                    it->second->addArrBuf(arDescrs[0], (stream != m_streamBuffers.end()) ? stream->second->buffer() : m_buffers[bufferName]);
                 }
                 for (auto i = 1; i < numArDescrs; i++)
                 {
@@ -126,19 +185,54 @@ namespace yourgame
             return false;
         }
 
-        void Geometry::drawAll() const
+        bool Geometry::setShapeLods(std::string name, std::vector<Shape::Lod> lods)
+        {
+            auto it = m_shapes.find(name);
+            if (it != m_shapes.end())
+            {
+                it->second->setLods(lods);
+                return true;
+            }
+            return false;
+        }
+
+        void Geometry::setBounds(const float (&boundsMin)[3], const float (&boundsMax)[3])
+        {
+            std::copy(boundsMin, boundsMin + 3, m_boundsMin);
+            std::copy(boundsMax, boundsMax + 3, m_boundsMax);
+        }
+
+        void Geometry::setPositionDequantization(const float (&positionOffset)[3], const float (&positionScale)[3])
+        {
+            std::copy(positionOffset, positionOffset + 3, m_positionOffset);
+            std::copy(positionScale, positionScale + 3, m_positionScale);
+        }
+
+        bool Geometry::hasPositionDequantization() const
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                if (m_positionOffset[i] != 0.0f || m_positionScale[i] != 1.0f)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Geometry::drawAll(size_t lod) const
         {
             for (const auto &s : m_shapes)
             {
-                s.second->draw();
+                s.second->draw(lod);
             }
         }
 
-        void Geometry::drawAllInstanced(GLsizei instancecount) const
+        void Geometry::drawAllInstanced(GLsizei instancecount, size_t lod) const
         {
             for (const auto &s : m_shapes)
             {
-                s.second->drawInstanced(instancecount);
+                s.second->drawInstanced(instancecount, lod);
             }
         }
     } // namespace gl
@@ -19,287 +19,1872 @@ freely, subject to the following restrictions:
 */
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <exception>
+#include <istream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <streambuf>
 #include "tiny_obj_loader.h"
 #include "nlohmann/json.hpp"
 #include "yourgame/yourgame.h"
 #include "yourgame/file.h"
+#include "yourgame/gl/buffer.h"
 #include "yourgame/gl/loading.h"
 #include "yourgame/gl/conventions.h"
+#include "yourgame_internal/worker.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    /* read-only stream buffer on top of existing memory, used to
+    parse file views without copying them into a string first */
+    class MemoryStreamBuf : public std::streambuf
+    {
+    public:
+        MemoryStreamBuf(const uint8_t *data, size_t numBytes)
+        {
+            char *p = const_cast<char *>(reinterpret_cast<const char *>(data));
+            setg(p, p, p + numBytes);
+        }
+    };
+
+    /* read-only stream buffer on top of a yourgame::file::Stream, reading
+    it in chunks. used to parse (large) files without loading them as a whole */
+    class ChunkedStreamBuf : public std::streambuf
+    {
+    public:
+        explicit ChunkedStreamBuf(yourgame::file::Stream *stream) : m_stream(stream), m_buf(64 * 1024) {}
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            size_t numRead = m_stream->read(m_buf.data(), m_buf.size());
+            if (numRead == 0)
+            {
+                return traits_type::eof();
+            }
+            setg(m_buf.data(), m_buf.data(), m_buf.data() + numRead);
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        yourgame::file::Stream *m_stream;
+        std::vector<char> m_buf;
+    };
+
+    /* .ygmesh: geometry data, ready to be uploaded. layout:
+    header, buffer records, shape records, buffer data (each aligned).
+    all values are stored in native byte order */
+    const uint32_t meshCacheMagic = 0x4D475921U; // "!YGM"
+    const uint32_t meshCacheVersion = 3U;
+    const size_t meshCacheNameSize = 16U;
+    const size_t meshCacheMaxAttribs = 8U;
+    const size_t meshCacheAlignment = 16U;
+    const size_t meshCacheMaxLods = 7U; // in addition to level 0
+
+    struct MeshCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numBuffers;
+        uint32_t numShapes;
+        float boundsMin[3];
+        float boundsMax[3];
+        float positionOffset[3];
+        float positionScale[3];
+        uint32_t numLodErrors;
+        uint32_t reserved;
+        float lodErrors[meshCacheMaxLods + 1];
+    };
+
+    struct MeshCacheBuffer
+    {
+        char name[meshCacheNameSize];
+        uint32_t target;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct MeshCacheAttrib
+    {
+        uint32_t buffer; // index of the buffer record
+        uint32_t location;
+        uint32_t size;
+        uint32_t type;
+        uint32_t normalized;
+        uint32_t stride;
+        uint32_t offset;
+        uint32_t divisor;
+    };
+
+    struct MeshCacheLod
+    {
+        uint32_t firstElement;
+        uint32_t numElements;
+    };
+
+    struct MeshCacheShape
+    {
+        char name[meshCacheNameSize];
+        uint32_t drawMode;
+        uint32_t indexType;
+        uint32_t numElements;
+        uint32_t indexBuffer; // index of the buffer record
+        uint32_t numAttribs;
+        uint32_t numLods;
+        MeshCacheAttrib attribs[meshCacheMaxAttribs];
+        MeshCacheLod lods[meshCacheMaxLods];
+    };
+
+    static_assert(sizeof(MeshCacheHeader) == 104, "unexpected size of MeshCacheHeader");
+    static_assert(sizeof(MeshCacheBuffer) == 40, "unexpected size of MeshCacheBuffer");
+    static_assert(sizeof(MeshCacheShape) == 352, "unexpected size of MeshCacheShape");
+
+    void copyMeshCacheName(char (&dst)[meshCacheNameSize], const std::string &name)
+    {
+        std::memset(dst, 0, meshCacheNameSize);
+        std::memcpy(dst, name.data(), std::min(name.size(), meshCacheNameSize - 1));
+    }
+
+    std::string getMeshCacheName(const char (&src)[meshCacheNameSize])
+    {
+        return std::string(src, std::find(src, src + meshCacheNameSize, '\0'));
+    }
+
+    size_t alignMeshCacheOffset(size_t offset)
+    {
+        return (offset + meshCacheAlignment - 1) & ~(meshCacheAlignment - 1);
+    }
+
+    /* pointer and size of buffer data, either owned by a MeshData or mapped */
+    using BufferView = std::pair<const uint8_t *, size_t>;
+
+    /* serializes mesh data as .ygmesh */
+    std::vector<uint8_t> encodeMeshCache(const yourgame::gl::MeshData &mesh)
+    {
+        MeshCacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = meshCacheMagic;
+        header.version = meshCacheVersion;
+        header.numBuffers = (uint32_t)mesh.buffers.size();
+        header.numShapes = (uint32_t)mesh.shapes.size();
+        std::copy(mesh.boundsMin, mesh.boundsMin + 3, header.boundsMin);
+        std::copy(mesh.boundsMax, mesh.boundsMax + 3, header.boundsMax);
+        std::copy(mesh.positionOffset, mesh.positionOffset + 3, header.positionOffset);
+        std::copy(mesh.positionScale, mesh.positionScale + 3, header.positionScale);
+        header.numLodErrors = (uint32_t)std::min(mesh.lodErrors.size(), meshCacheMaxLods + 1);
+        std::copy(mesh.lodErrors.begin(), mesh.lodErrors.begin() + header.numLodErrors, header.lodErrors);
+
+        std::vector<MeshCacheBuffer> buffers(mesh.buffers.size());
+        size_t offset = sizeof(header) +
+                        buffers.size() * sizeof(MeshCacheBuffer) +
+                        mesh.shapes.size() * sizeof(MeshCacheShape);
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            std::memset(&buffers[i], 0, sizeof(buffers[i]));
+            copyMeshCacheName(buffers[i].name, mesh.buffers[i].name);
+            buffers[i].target = mesh.buffers[i].target;
+            buffers[i].size = mesh.buffers[i].data.size();
+            offset = alignMeshCacheOffset(offset);
+            buffers[i].offset = offset;
+            offset += buffers[i].size;
+        }
+
+        std::vector<MeshCacheShape> shapes(mesh.shapes.size());
+        for (size_t i = 0; i < shapes.size(); i++)
+        {
+            const auto &src = mesh.shapes[i];
+            auto &dst = shapes[i];
+            std::memset(&dst, 0, sizeof(dst));
+            copyMeshCacheName(dst.name, src.name);
+            dst.drawMode = src.elArDescr.drawMode;
+            dst.indexType = src.elArDescr.type;
+            dst.numElements = (uint32_t)src.elArDescr.numElements;
+            dst.indexBuffer = (uint32_t)src.indexBuffer;
+            dst.numAttribs = (uint32_t)std::min(src.attribs.size(), meshCacheMaxAttribs);
+            for (uint32_t a = 0; a < dst.numAttribs; a++)
+            {
+                const auto &descr = src.attribs[a].descr;
+                dst.attribs[a] = {(uint32_t)src.attribs[a].buffer,
+                                  descr.index,
+                                  (uint32_t)descr.size,
+                                  descr.type,
+                                  descr.normalized,
+                                  (uint32_t)descr.stride,
+                                  (uint32_t)(uintptr_t)descr.pointer,
+                                  descr.attribDivisor};
+            }
+            dst.numLods = (uint32_t)std::min(src.lods.size(), meshCacheMaxLods);
+            for (uint32_t l = 0; l < dst.numLods; l++)
+            {
+                dst.lods[l] = {(uint32_t)src.lods[l].firstElement, (uint32_t)src.lods[l].numElements};
+            }
+        }
+
+        std::vector<uint8_t> data(offset, 0);
+        uint8_t *p = data.data();
+        std::memcpy(p, &header, sizeof(header));
+        p += sizeof(header);
+        if (!buffers.empty())
+        {
+            std::memcpy(p, buffers.data(), buffers.size() * sizeof(MeshCacheBuffer));
+            p += buffers.size() * sizeof(MeshCacheBuffer);
+        }
+        if (!shapes.empty())
+        {
+            std::memcpy(p, shapes.data(), shapes.size() * sizeof(MeshCacheShape));
+        }
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            if (buffers[i].size > 0)
+            {
+                std::memcpy(data.data() + buffers[i].offset, mesh.buffers[i].data.data(), buffers[i].size);
+            }
+        }
+        return data;
+    }
+
+    /* reads .ygmesh data to dst, except for the buffer data,
+    which is provided as views into data */
+    bool decodeMeshCache(const uint8_t *data, size_t size, yourgame::gl::MeshData &dst, std::vector<BufferView> &bufferViews)
+    {
+        MeshCacheHeader header;
+        if (size < sizeof(header))
+        {
+            yourgame::log::error("loadGeometry(): mesh cache too small");
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != meshCacheMagic || header.version != meshCacheVersion)
+        {
+            yourgame::log::error("loadGeometry(): unknown mesh cache format (version %v)", header.version);
+            return false;
+        }
+
+        uint64_t recordsSize = (uint64_t)header.numBuffers * sizeof(MeshCacheBuffer) +
+                               (uint64_t)header.numShapes * sizeof(MeshCacheShape);
+        if (recordsSize > size - sizeof(header))
+        {
+            yourgame::log::error("loadGeometry(): mesh cache truncated");
+            return false;
+        }
+
+        std::vector<MeshCacheBuffer> buffers(header.numBuffers);
+        std::vector<MeshCacheShape> shapes(header.numShapes);
+        const uint8_t *p = data + sizeof(header);
+        if (!buffers.empty())
+        {
+            std::memcpy(buffers.data(), p, buffers.size() * sizeof(MeshCacheBuffer));
+            p += buffers.size() * sizeof(MeshCacheBuffer);
+        }
+        if (!shapes.empty())
+        {
+            std::memcpy(shapes.data(), p, shapes.size() * sizeof(MeshCacheShape));
+        }
+
+        dst = yourgame::gl::MeshData();
+        std::copy(header.boundsMin, header.boundsMin + 3, dst.boundsMin);
+        std::copy(header.boundsMax, header.boundsMax + 3, dst.boundsMax);
+        std::copy(header.positionOffset, header.positionOffset + 3, dst.positionOffset);
+        std::copy(header.positionScale, header.positionScale + 3, dst.positionScale);
+        dst.lodErrors.assign(header.lodErrors, header.lodErrors + std::min((size_t)header.numLodErrors, meshCacheMaxLods + 1));
+        bufferViews.clear();
+
+        for (const auto &buf : buffers)
+        {
+            if (buf.offset > size || buf.size > size - buf.offset)
+            {
+                yourgame::log::error("loadGeometry(): mesh cache buffer out of range");
+                return false;
+            }
+            dst.buffers.push_back({getMeshCacheName(buf.name), buf.target, {}});
+            bufferViews.push_back(std::make_pair(data + buf.offset, (size_t)buf.size));
+        }
+
+        for (const auto &shape : shapes)
+        {
+            if (shape.indexBuffer >= buffers.size() || shape.numAttribs > meshCacheMaxAttribs ||
+                shape.numLods > meshCacheMaxLods)
+            {
+                yourgame::log::error("loadGeometry(): mesh cache shape invalid");
+                return false;
+            }
+
+            yourgame::gl::MeshData::ShapeData shapeData;
+            shapeData.name = getMeshCacheName(shape.name);
+            shapeData.elArDescr = {shape.indexType, shape.drawMode, (GLsizei)shape.numElements};
+            shapeData.indexBuffer = shape.indexBuffer;
+            for (uint32_t a = 0; a < shape.numAttribs; a++)
+            {
+                const auto &attr = shape.attribs[a];
+                if (attr.buffer >= buffers.size())
+                {
+                    yourgame::log::error("loadGeometry(): mesh cache shape invalid");
+                    return false;
+                }
+                shapeData.attribs.push_back({attr.buffer,
+                                             {attr.location,
+                                              (GLint)attr.size,
+                                              attr.type,
+                                              (GLboolean)attr.normalized,
+                                              (GLsizei)attr.stride,
+                                              (const GLvoid *)(uintptr_t)attr.offset,
+                                              attr.divisor}});
+            }
+            for (uint32_t l = 0; l < shape.numLods; l++)
+            {
+                shapeData.lods.push_back({(GLsizei)shape.lods[l].firstElement, (GLsizei)shape.lods[l].numElements});
+            }
+            dst.shapes.push_back(shapeData);
+        }
+
+        return true;
+    }
+
+    /* makes a Geometry from the buffer and shape descriptions of mesh,
+    uploading the buffers from bufferViews */
+    yourgame::gl::Geometry *uploadGeometry(const yourgame::gl::MeshData &mesh, const std::vector<BufferView> &bufferViews)
+    {
+        using namespace yourgame::gl;
+
+        for (const auto &shape : mesh.shapes)
+        {
+            bool valid = shape.indexBuffer < mesh.buffers.size();
+            for (const auto &attr : shape.attribs)
+            {
+                valid = valid && (attr.buffer < mesh.buffers.size());
+            }
+            if (!valid)
+            {
+                yourgame::log::error("makeGeometry(): shape %v references unknown buffer", shape.name);
+                return nullptr;
+            }
+        }
+
+        Geometry *newGeo = Geometry::make();
+
+        for (size_t i = 0; i < mesh.buffers.size(); i++)
+        {
+            newGeo->addBuffer(mesh.buffers[i].name,
+                              mesh.buffers[i].target,
+                              (GLsizeiptr)bufferViews[i].second,
+                              bufferViews[i].first,
+                              GL_STATIC_DRAW);
+        }
+
+        for (const auto &shape : mesh.shapes)
+        {
+            std::vector<Shape::ArrBufferDescr> arDescrs;
+            std::vector<std::string> arBufferNames;
+            for (const auto &attr : shape.attribs)
+            {
+                arDescrs.push_back(attr.descr);
+                arBufferNames.push_back(mesh.buffers[attr.buffer].name);
+            }
+            newGeo->addShape(shape.name,
+                             arDescrs,
+                             arBufferNames,
+                             shape.elArDescr,
+                             mesh.buffers[shape.indexBuffer].name);
+            if (!shape.lods.empty())
+            {
+                newGeo->setShapeLods(shape.name, shape.lods);
+            }
+        }
+
+        // bounds and LOD errors in object space, drawGeo() applies the dequantization of positions
+        newGeo->setBounds(mesh.boundsMin, mesh.boundsMax);
+        newGeo->setLodErrors(mesh.lodErrors);
+        newGeo->setPositionDequantization(mesh.positionOffset, mesh.positionScale);
+
+        return newGeo;
+    }
+
+    /* hash of a unique obj vertex: vertex, normal, texcoord and material index */
+    struct ObjVertexKeyHash
+    {
+        size_t operator()(const std::array<int, 4> &key) const
+        {
+            uint64_t h = 14695981039346656037ULL;
+            for (auto k : key)
+            {
+                h = (h ^ (uint32_t)k) * 1099511628211ULL;
+            }
+            return (size_t)(h ^ (h >> 32));
+        }
+    };
+
+    bool parseObj(std::istream &objStream, std::istream &mtlStream, yourgame::gl::MeshData &dst)
+    {
+        using namespace yourgame::gl;
+
+        tinyobj::attrib_t attribs;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn;
+        std::string err;
+        tinyobj::MaterialStreamReader mtlReader(mtlStream);
+
+        // triangulate, vertex colors
+        if (!tinyobj::LoadObj(&attribs, &shapes, &materials, &warn, &err, &objStream, &mtlReader, true, true))
+        {
+            yourgame::log::error("tinyobj::LoadObj failed: %v", err);
+            return false;
+        }
+
+        yourgame::log::debug("%v shape(s), %v material(s)", shapes.size(), materials.size());
+
+        const bool hasNormals = attribs.normals.size() > 0;
+        const bool hasTexcoords = attribs.texcoords.size() > 0;
+        const int numPositions = (int)(attribs.vertices.size() / 3);
+        const int numColors = (int)(attribs.colors.size() / 3);
+        const int numNormals = (int)(attribs.normals.size() / 3);
+        const int numTexcoords = (int)(attribs.texcoords.size() / 2);
+
+        // interleaved vertex layout: position, color, normal (optional), texcoords (optional)
+        const size_t vertNumFloats = 6 + (hasNormals ? 3 : 0) + (hasTexcoords ? 2 : 0);
+
+        std::vector<GLfloat> objVertData;
+        std::vector<GLuint> objIdxData;
+        std::vector<GLuint> objLineIdxData;
+
+        float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+        float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+
+        // each mesh index (here: 3 of them form a triangle (face)), references:
+        //   (1) vertex position (and color),
+        //   (2) normal,
+        //   (3) texture coordinates and
+        //   (4) meterial index (of the face),
+        // that are parsed separately.
+        // uniqueIdxMap is used to track unique combinations of (1-4)
+        size_t numIndices = 0;
+        for (auto const &shape : shapes)
+        {
+            numIndices += shape.mesh.indices.size() + shape.lines.indices.size();
+        }
+        std::unordered_map<std::array<int, 4>, GLuint, ObjVertexKeyHash> uniqueIdxMap;
+        uniqueIdxMap.reserve(numIndices);
+        objIdxData.reserve(numIndices);
+        GLuint uniqueVertCount = 0U;
+
+        // returns the index of the unique vertex, or false if the obj index is faulty
+        auto addVertex = [&](const tinyobj::index_t &idx, int materialId, GLuint &vertIdx) -> bool
+        {
+            auto mapRet = uniqueIdxMap.emplace(
+                std::array<int, 4>{idx.vertex_index, idx.normal_index, idx.texcoord_index, materialId}, uniqueVertCount);
+            if (!mapRet.second) // reuse unique vertex index
+            {
+                vertIdx = mapRet.first->second;
+                return true;
+            }
+
+            // new unique vertex
+            if (idx.vertex_index < 0 || idx.vertex_index >= numPositions || idx.vertex_index >= numColors ||
+                (hasNormals && (idx.normal_index < 0 || idx.normal_index >= numNormals)) ||
+                (hasTexcoords && (idx.texcoord_index < 0 || idx.texcoord_index >= numTexcoords)))
+            {
+                return false;
+            }
+
+            const GLfloat *pos = &attribs.vertices[idx.vertex_index * 3];
+            objVertData.insert(objVertData.end(), pos, pos + 3);
+            for (int c = 0; c < 3; c++)
+            {
+                if (uniqueVertCount == 0U || pos[c] < boundsMin[c])
+                {
+                    boundsMin[c] = pos[c];
+                }
+                if (uniqueVertCount == 0U || pos[c] > boundsMax[c])
+                {
+                    boundsMax[c] = pos[c];
+                }
+            }
+
+            // if material available, use diffuse color as vertex color. if not, use the
+            // (always available, but maybe default) parsed vertex color
+            if (materialId > -1 && materialId < (int)materials.size())
+            {
+                const GLfloat *diffuse = materials[materialId].diffuse;
+                objVertData.insert(objVertData.end(), diffuse, diffuse + 3);
+                // todo: optionally, make geometry buffers for other material components:
+                // ambient, specular, emissive colors, specular exponent ... ?
+            }
+            else
+            {
+                const GLfloat *color = &attribs.colors[idx.vertex_index * 3];
+                objVertData.insert(objVertData.end(), color, color + 3);
+            }
+
+            if (hasNormals)
+            {
+                const GLfloat *normal = &attribs.normals[idx.normal_index * 3];
+                objVertData.insert(objVertData.end(), normal, normal + 3);
+            }
+
+            if (hasTexcoords)
+            {
+                const GLfloat *texcoords = &attribs.texcoords[idx.texcoord_index * 2];
+                objVertData.insert(objVertData.end(), texcoords, texcoords + 2);
+            }
+
+            vertIdx = uniqueVertCount++;
+            return true;
+        };
+
+        // we merge all obj meshes (triangle shapes) into one GLGeometry shape,
+        // and all obj line shapes into another GLGeometry shape
+        for (auto const &shape : shapes)
+        {
+            yourgame::log::debug("shape: %v", shape.name);
+
+            GLuint shapeMeshReadIdx = 0U;
+            for (auto const &idx : shape.mesh.indices)
+            {
+                // assuming all faces are triangles (triangulation is requested above),
+                // get the material id for that face (-1, if no material is assigned)
+                auto faceIdx = shapeMeshReadIdx / 3U;
+                int materialId = (faceIdx < shape.mesh.material_ids.size()) ? shape.mesh.material_ids[faceIdx] : -1;
+                GLuint vertIdx;
+                if (!addVertex(idx, materialId, vertIdx))
+                {
+                    yourgame::log::error("loadGeometry(): faulty obj vertex data");
+                    return false;
+                }
+                objIdxData.push_back(vertIdx);
+                shapeMeshReadIdx++;
+            }
+
+            // lines. todo: work in progress.
+            // - new unique vertices (for lines) are created with material = -1.
+            //   (lines do not have material)
+            // - as the line vertices share buffers with triangle face vertices,
+            //   they must also reference texcoords/normals (if triangle faces do),
+            //   in order to keep the vertex data "aligned"
+            // - assumption: vertices per line: always 2
+            for (auto const &idx : shape.lines.indices)
+            {
+                GLuint vertIdx;
+                if (!addVertex(idx, -1, vertIdx))
+                {
+                    yourgame::log::error("loadGeometry(): faulty line obj vertex data");
+                    return false;
+                }
+                objLineIdxData.push_back(vertIdx);
+            }
+        }
+
+        auto toBytes = [](const void *data, size_t size)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            return std::vector<uint8_t>(bytes, bytes + size);
+        };
+
+        dst = MeshData();
+        std::copy(boundsMin, boundsMin + 3, dst.boundsMin);
+        std::copy(boundsMax, boundsMax + 3, dst.boundsMax);
+        dst.buffers.push_back({"vertices", GL_ARRAY_BUFFER, toBytes(objVertData.data(), objVertData.size() * sizeof(objVertData[0]))});
+        dst.buffers.push_back({"idx", GL_ELEMENT_ARRAY_BUFFER, toBytes(objIdxData.data(), objIdxData.size() * sizeof(objIdxData[0]))});
+        dst.buffers.push_back({"idxLines", GL_ELEMENT_ARRAY_BUFFER, toBytes(objLineIdxData.data(), objLineIdxData.size() * sizeof(objLineIdxData[0]))});
+
+        const GLsizei stride = (GLsizei)(vertNumFloats * sizeof(GLfloat));
+        size_t offset = 0U;
+        std::vector<MeshData::AttribData> meshAttribs;
+        meshAttribs.push_back({0, {attrLocPosition, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offset, 0}});
+        offset += 3 * sizeof(GLfloat);
+        meshAttribs.push_back({0, {attrLocColor, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offset, 0}});
+        offset += 3 * sizeof(GLfloat);
+        if (hasNormals)
+        {
+            meshAttribs.push_back({0, {attrLocNormal, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offset, 0}});
+            offset += 3 * sizeof(GLfloat);
+        }
+        if (hasTexcoords)
+        {
+            meshAttribs.push_back({0, {attrLocTexcoords, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offset, 0}});
+            offset += 2 * sizeof(GLfloat);
+        }
+
+        // all obj triangle shapes
+        dst.shapes.push_back({"main", meshAttribs, {GL_UNSIGNED_INT, GL_TRIANGLES, (GLsizei)objIdxData.size()}, 1, {}});
+
+        // all obj line shapes
+        dst.shapes.push_back({"lines", meshAttribs, {GL_UNSIGNED_INT, GL_LINES, (GLsizei)objLineIdxData.size()}, 2, {}});
+
+        return true;
+    }
+
+    /* returns 0 on success, -1 if the obj/mtl file failed to load, -2 if parsing failed */
+    int parseObjFiles(const std::string &objFilename, const std::string &mtlFilename, yourgame::gl::MeshData &dst)
+    {
+        // obj files can be large. they are parsed while being streamed
+        std::unique_ptr<yourgame::file::Stream> objData(yourgame::file::Stream::open(objFilename));
+        if (!objData)
+        {
+            yourgame::log::error("loadGeometry(): failed to load obj file %v", objFilename);
+            return -1;
+        }
+
+        yourgame::file::FileView mtlData;
+        if (!mtlFilename.empty())
+        {
+            if (yourgame::file::mapFile(mtlFilename, mtlData))
+            {
+                yourgame::log::error("loadGeometry(): failed to load mtl file %v", mtlFilename);
+                return -1;
+            }
+        }
+
+        ChunkedStreamBuf objBuf(objData.get());
+        MemoryStreamBuf mtlBuf(mtlData.data(), mtlData.size());
+        std::istream objStream(&objBuf);
+        std::istream mtlStream(&mtlBuf);
+
+        return parseObj(objStream, mtlStream, dst) ? 0 : -2;
+    }
+
+    bool isMeshCacheFile(const std::string &filename)
+    {
+        return yourgame::file::getFileExtension(filename) == "ygmesh";
+    }
+
+    bool isProcessing(const yourgame::gl::MeshProcessing &cfg)
+    {
+        const auto &q = cfg.quantization;
+        const auto &o = cfg.optimization;
+        return q.positions != yourgame::gl::MeshQuantization::Positions::FLOAT ||
+               q.normals || q.colors || q.texcoords || q.indices ||
+               o.vertexCache || o.vertexFetch || o.overdraw ||
+               cfg.lods.numLods > 0;
+    }
+
+    std::vector<std::pair<GLenum, GLint>> getTextureParameters(const yourgame::gl::TextureConfig &cfg, bool cubemap, size_t numLevels = 1)
+    {
+        std::vector<std::pair<GLenum, GLint>> texParamI = {{GL_TEXTURE_MIN_FILTER, cfg.minMagFilter},
+                                                           {GL_TEXTURE_MAG_FILTER, cfg.minMagFilter},
+                                                           {GL_TEXTURE_WRAP_S, cfg.wrapMode},
+                                                           {GL_TEXTURE_WRAP_T, cfg.wrapMode}};
+        if (cubemap)
+        {
+            texParamI.push_back({GL_TEXTURE_WRAP_R, cfg.wrapMode});
+        }
+        if (numLevels > 1)
+        {
+            // prebuilt mipmaps, possibly not down to 1x1
+            texParamI.push_back({GL_TEXTURE_MAX_LEVEL, (GLint)numLevels - 1});
+        }
+        texParamI.insert(texParamI.end(), cfg.parameteri.begin(), cfg.parameteri.end());
+        return texParamI;
+    }
+
+    bool isKtxFile(const std::string &filename)
+    {
+        return yourgame::file::getFileExtension(filename) == "ktx";
+    }
+
+    /* reads a KTX (version 1) file: 2d textures and cubemaps, with all mipmap levels,
+    see https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html */
+    bool parseKtx(const uint8_t *data, size_t size, yourgame::gl::TextureData &dst)
+    {
+        static const uint8_t identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        const size_t headerSize = 64;
+        if (size < headerSize || std::memcmp(data, identifier, sizeof(identifier)) != 0)
+        {
+            yourgame::log::error("loadTextureData(): not a KTX file");
+            return false;
+        }
+
+        uint32_t header[13]; // endianness, glType, ..., bytesOfKeyValueData
+        std::memcpy(header, data + sizeof(identifier), sizeof(header));
+        if (header[0] != 0x04030201U)
+        {
+            yourgame::log::error("loadTextureData(): KTX file of foreign byte order");
+            return false;
+        }
+        uint32_t glType = header[1];
+        uint32_t glFormat = header[3];
+        uint32_t glInternalFormat = header[4];
+        uint32_t width = header[6];
+        uint32_t height = header[7];
+        uint32_t depth = header[8];
+        uint32_t numArrayElements = header[9];
+        uint32_t numFaces = header[10];
+        uint32_t numLevels = std::max(header[11], 1U);
+        uint32_t keyValueSize = header[12];
+
+        if (width == 0 || height == 0 || depth != 0 || numArrayElements != 0 ||
+            (numFaces != 1 && numFaces != 6) || numLevels > 32)
+        {
+            yourgame::log::error("loadTextureData(): KTX texture type not supported (only 2d textures and cubemaps)");
+            return false;
+        }
+
+        dst = yourgame::gl::TextureData();
+        dst.target = (numFaces == 6) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+        dst.internalFormat = (GLint)glInternalFormat;
+        dst.format = glFormat;
+        dst.type = glType;
+
+        size_t offset = headerSize + (size_t)keyValueSize;
+        for (uint32_t l = 0; l < numLevels; l++)
+        {
+            if (offset + 4 > size)
+            {
+                yourgame::log::error("loadTextureData(): KTX file truncated");
+                return false;
+            }
+            uint32_t imageSize;
+            std::memcpy(&imageSize, data + offset, 4);
+            offset += 4;
+
+            yourgame::gl::TextureData::Level level;
+            level.width = (GLsizei)std::max(width >> l, 1U);
+            level.height = (GLsizei)std::max(height >> l, 1U);
+            for (uint32_t f = 0; f < numFaces; f++)
+            {
+                if (imageSize > size - std::min(offset, size))
+                {
+                    yourgame::log::error("loadTextureData(): KTX file truncated");
+                    return false;
+                }
+                level.faces.emplace_back(data + offset, data + offset + imageSize);
+                offset += (imageSize + 3U) & ~(size_t)3U; // cube padding and mip padding
+            }
+            dst.levels.push_back(std::move(level));
+        }
+        return true;
+    }
+
+    /* uploads all levels (and faces) of data to texture. faceTarget is the target of 2d data
+    (GL_TEXTURE_2D, or a face of a cubemap). if pboOffsets is not nullptr, the data is read from
+    the bound pixel unpack buffer, at the offset of each level (and face), see stageTextureData() */
+    void uploadTextureData(yourgame::gl::Texture *texture,
+                           const yourgame::gl::TextureData &data,
+                           GLenum faceTarget,
+                           bool generateMipmap,
+                           const std::vector<GLintptr> *pboOffsets = nullptr)
+    {
+        size_t i = 0;
+        for (size_t l = 0; l < data.levels.size(); l++)
+        {
+            const auto &level = data.levels[l];
+            for (size_t f = 0; f < level.faces.size(); f++, i++)
+            {
+                const auto &face = level.faces[f];
+                GLenum target = (data.target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)f : faceTarget;
+                const void *pixels = pboOffsets ? (const void *)(*pboOffsets)[i] : (const void *)face.data();
+
+                if (data.isCompressed())
+                {
+                    texture->updateCompressedData(target, (GLint)l, (GLenum)data.internalFormat,
+                                                  level.width, level.height, (GLsizei)face.size(), pixels);
+                }
+                else
+                {
+                    texture->updateData(target, (GLint)l, data.internalFormat, level.width, level.height, 0,
+                                        data.format, data.type, pixels, generateMipmap && data.levels.size() == 1);
+                }
+            }
+        }
+    }
+
+    /* pixel unpack buffers for stageTextureData(), reused (orphaned) across uploads.
+    buffers larger than pboPoolMaxCapacity are not kept. main thread only */
+    const size_t pboPoolMaxSize = 4;
+    const GLsizeiptr pboPoolMaxCapacity = 16 * 1024 * 1024;
+    std::vector<yourgame::gl::Buffer *> pboPool;
+
+    /* returns a pixel unpack buffer of at least size bytes, bound. nullptr on failure */
+    yourgame::gl::Buffer *acquirePbo(GLsizeiptr size)
+    {
+        if (pboPool.empty())
+        {
+            return yourgame::gl::Buffer::make(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+        yourgame::gl::Buffer *pbo = pboPool.back();
+        pboPool.pop_back();
+        if (!pbo->bufferData(size, nullptr))
+        {
+            pbo->unbindTarget();
+            delete pbo;
+            return nullptr;
+        }
+        return pbo;
+    }
+
+    void releasePbo(yourgame::gl::Buffer *pbo)
+    {
+        if (pboPool.size() < pboPoolMaxSize && pbo->getCapacity() <= pboPoolMaxCapacity)
+        {
+            pboPool.push_back(pbo);
+        }
+        else
+        {
+            delete pbo;
+        }
+    }
+
+    /* stages data for uploading through a pixel unpack buffer: the buffer is mapped on the main
+    thread, filled by a worker job and unmapped on the main thread again, where upload() is called
+    with the buffer bound and the offset of each level (and face), see uploadTextureData(). the
+    driver then copies from the buffer asynchronously. if staging is not possible, upload() is
+    called with nullptr (upload from client memory). call on the main thread */
+    void stageTextureData(std::shared_ptr<const yourgame::gl::TextureData> data,
+                          int priority,
+                          std::function<void(const std::vector<GLintptr> *)> upload)
+    {
+#ifdef __EMSCRIPTEN__
+        // WebGL does not map buffers
+        (void)data;
+        (void)priority;
+        upload(nullptr);
+#else
+        // faces aligned to 16 bytes, like StreamBuffer
+        std::vector<GLintptr> offsets;
+        GLsizeiptr size = 0;
+        for (const auto &level : data->levels)
+        {
+            for (const auto &face : level.faces)
+            {
+                offsets.push_back(size);
+                size += ((GLsizeiptr)face.size() + 15) & ~(GLsizeiptr)15;
+            }
+        }
+
+        yourgame::gl::Buffer *pbo = (size > 0) ? acquirePbo(size) : nullptr;
+        void *dst = nullptr;
+        if (pbo)
+        {
+            dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            pbo->unbindTarget();
+        }
+        if (!dst)
+        {
+            if (pbo)
+            {
+                releasePbo(pbo);
+            }
+            upload(nullptr);
+            return;
+        }
+
+        yourgame_internal::worker::post(
+            [data, dst, offsets, pbo, upload]()
+            {
+                uint8_t *bytes = static_cast<uint8_t *>(dst);
+                size_t i = 0;
+                for (const auto &level : data->levels)
+                {
+                    for (const auto &face : level.faces)
+                    {
+                        std::memcpy(bytes + offsets[i++], face.data(), face.size());
+                    }
+                }
+
+                yourgame_internal::worker::postToMain(
+                    [data, offsets, pbo, upload]()
+                    {
+                        pbo->bind();
+                        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+                        {
+                            upload(&offsets);
+                            pbo->unbindTarget();
+                        }
+                        else
+                        {
+                            // the buffer content got lost (display mode change, ...)
+                            pbo->unbindTarget();
+                            upload(nullptr);
+                        }
+                        releasePbo(pbo);
+                    });
+            },
+            priority);
+#endif
+    }
+
+    /* makes a texture of data, which has to be uploadable (see makeUploadable()). see uploadTextureData() */
+    yourgame::gl::Texture *createTexture(const yourgame::gl::TextureData &data,
+                                         const yourgame::gl::TextureConfig &cfg,
+                                         const std::vector<GLintptr> *pboOffsets = nullptr)
+    {
+        if (data.levels.empty())
+        {
+            yourgame::log::error("makeTexture(): no texture data");
+            return nullptr;
+        }
+
+        yourgame::gl::Texture *texture = yourgame::gl::Texture::make(data.target,
+                                                                      cfg.unit,
+                                                                      getTextureParameters(cfg, data.target == GL_TEXTURE_CUBE_MAP, data.levels.size()));
+        uploadTextureData(texture, data, GL_TEXTURE_2D, cfg.generateMipmap, pboOffsets);
+        return texture;
+    }
+
+    /* 1x1 mid grey, for textures that are still loading */
+    void uploadPlaceholder(yourgame::gl::Texture *texture, GLenum target)
+    {
+        const uint8_t texel[4] = {128, 128, 128, 255};
+        texture->updateData(target, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel, false);
+    }
+
+    /* .ygatlas: subtextures of a texture atlas, with pre-grouped sequences. layout:
+    header, frame records, sequence records, sequence frame records, sequence names.
+    all values are stored in native byte order */
+    const uint32_t atlasCacheMagic = 0x41475921U; // "!YGA"
+    const uint32_t atlasCacheVersion = 1U;
+
+    struct AtlasCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numFrames;
+        uint32_t numSequences;
+        uint32_t numSequenceFrames;
+        uint32_t namesSize;
+    };
+
+    struct AtlasCacheFrame
+    {
+        uint64_t id; // AssetId of the name
+        int32_t x;
+        int32_t y;
+        int32_t width;
+        int32_t height;
+        uint32_t cwRot;
+        uint32_t reserved;
+    };
+
+    struct AtlasCacheSequence
+    {
+        uint64_t id;
+        uint32_t nameOffset;
+        uint32_t nameSize;
+        uint32_t firstFrame; // index of the first sequence frame record
+        uint32_t numFrames;
+    };
+
+    struct AtlasCacheSequenceFrame
+    {
+        int32_t index; // frame index in the sequence
+        uint32_t frame; // index of the frame record
+    };
+
+    static_assert(sizeof(AtlasCacheHeader) == 24, "unexpected size of AtlasCacheHeader");
+    static_assert(sizeof(AtlasCacheFrame) == 32, "unexpected size of AtlasCacheFrame");
+    static_assert(sizeof(AtlasCacheSequence) == 24, "unexpected size of AtlasCacheSequence");
+    static_assert(sizeof(AtlasCacheSequenceFrame) == 8, "unexpected size of AtlasCacheSequenceFrame");
+
+    bool isAtlasCacheFile(const std::string &filename)
+    {
+        return yourgame::file::getFileExtension(filename) == "ygatlas";
+    }
+
+    /* serializes atlas data as .ygatlas */
+    std::vector<uint8_t> encodeAtlasCache(const yourgame::gl::AtlasData &atlas)
+    {
+        std::vector<AtlasCacheFrame> frames;
+        frames.reserve(atlas.frames.size());
+        for (const auto &f : atlas.frames)
+        {
+            frames.push_back({f.id.value(), f.x, f.y, f.width, f.height, f.cwRot ? 1U : 0U, 0U});
+        }
+
+        std::vector<AtlasCacheSequence> sequences;
+        std::vector<AtlasCacheSequenceFrame> sequenceFrames;
+        std::string names;
+        for (const auto &seq : atlas.sequences)
+        {
+            sequences.push_back({seq.id.value(),
+                                 (uint32_t)names.size(),
+                                 (uint32_t)seq.name.size(),
+                                 (uint32_t)sequenceFrames.size(),
+                                 (uint32_t)seq.frames.size()});
+            names += seq.name;
+            for (const auto &f : seq.frames)
+            {
+                sequenceFrames.push_back({f.first, f.second});
+            }
+        }
+
+        AtlasCacheHeader header = {atlasCacheMagic,
+                                   atlasCacheVersion,
+                                   (uint32_t)frames.size(),
+                                   (uint32_t)sequences.size(),
+                                   (uint32_t)sequenceFrames.size(),
+                                   (uint32_t)names.size()};
+
+        std::vector<uint8_t> data(sizeof(header) +
+                                  frames.size() * sizeof(AtlasCacheFrame) +
+                                  sequences.size() * sizeof(AtlasCacheSequence) +
+                                  sequenceFrames.size() * sizeof(AtlasCacheSequenceFrame) +
+                                  names.size());
+        uint8_t *p = data.data();
+        std::memcpy(p, &header, sizeof(header));
+        p += sizeof(header);
+        if (!frames.empty())
+        {
+            std::memcpy(p, frames.data(), frames.size() * sizeof(AtlasCacheFrame));
+            p += frames.size() * sizeof(AtlasCacheFrame);
+        }
+        if (!sequences.empty())
+        {
+            std::memcpy(p, sequences.data(), sequences.size() * sizeof(AtlasCacheSequence));
+            p += sequences.size() * sizeof(AtlasCacheSequence);
+        }
+        if (!sequenceFrames.empty())
+        {
+            std::memcpy(p, sequenceFrames.data(), sequenceFrames.size() * sizeof(AtlasCacheSequenceFrame));
+            p += sequenceFrames.size() * sizeof(AtlasCacheSequenceFrame);
+        }
+        if (!names.empty())
+        {
+            std::memcpy(p, names.data(), names.size());
+        }
+        return data;
+    }
+
+    /* reads .ygatlas data to dst */
+    bool decodeAtlasCache(const uint8_t *data, size_t size, yourgame::gl::AtlasData &dst)
+    {
+        AtlasCacheHeader header;
+        if (size < sizeof(header))
+        {
+            yourgame::log::error("loadAtlasData(): atlas cache too small");
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != atlasCacheMagic || header.version != atlasCacheVersion)
+        {
+            yourgame::log::error("loadAtlasData(): unknown atlas cache format (version %v)", header.version);
+            return false;
+        }
+
+        uint64_t framesSize = (uint64_t)header.numFrames * sizeof(AtlasCacheFrame);
+        uint64_t sequencesSize = (uint64_t)header.numSequences * sizeof(AtlasCacheSequence);
+        uint64_t sequenceFramesSize = (uint64_t)header.numSequenceFrames * sizeof(AtlasCacheSequenceFrame);
+        if (framesSize + sequencesSize + sequenceFramesSize + header.namesSize > size - sizeof(header))
+        {
+            yourgame::log::error("loadAtlasData(): atlas cache truncated");
+            return false;
+        }
+
+        const uint8_t *p = data + sizeof(header);
+        std::vector<AtlasCacheFrame> frames(header.numFrames);
+        std::vector<AtlasCacheSequence> sequences(header.numSequences);
+        std::vector<AtlasCacheSequenceFrame> sequenceFrames(header.numSequenceFrames);
+        if (!frames.empty())
+        {
+            std::memcpy(frames.data(), p, (size_t)framesSize);
+        }
+        p += framesSize;
+        if (!sequences.empty())
+        {
+            std::memcpy(sequences.data(), p, (size_t)sequencesSize);
+        }
+        p += sequencesSize;
+        if (!sequenceFrames.empty())
+        {
+            std::memcpy(sequenceFrames.data(), p, (size_t)sequenceFramesSize);
+        }
+        p += sequenceFramesSize;
+        const char *names = (const char *)p;
+
+        dst = yourgame::gl::AtlasData();
+        dst.frames.reserve(frames.size());
+        for (const auto &f : frames)
+        {
+            dst.frames.push_back({yourgame::AssetId::fromValue(f.id), f.x, f.y, f.width, f.height, f.cwRot != 0});
+        }
+        for (const auto &seq : sequences)
+        {
+            if ((uint64_t)seq.nameOffset + seq.nameSize > header.namesSize ||
+                (uint64_t)seq.firstFrame + seq.numFrames > header.numSequenceFrames)
+            {
+                yourgame::log::error("loadAtlasData(): atlas cache sequence invalid");
+                return false;
+            }
+            yourgame::gl::AtlasData::Sequence sequence;
+            sequence.name.assign(names + seq.nameOffset, seq.nameSize);
+            sequence.id = yourgame::AssetId::fromValue(seq.id);
+            for (uint32_t i = seq.firstFrame; i < seq.firstFrame + seq.numFrames; i++)
+            {
+                if (sequenceFrames[i].frame >= dst.frames.size())
+                {
+                    yourgame::log::error("loadAtlasData(): atlas cache sequence invalid");
+                    return false;
+                }
+                sequence.frames.push_back({sequenceFrames[i].index, sequenceFrames[i].frame});
+            }
+            dst.sequences.push_back(std::move(sequence));
+        }
+        return true;
+    }
+
+    /* reads the subtextures from a json atlas file (Free Texture Packer "array" or "hash", Crunch).
+    returns false if the data could not be parsed (completely) */
+    bool parseAtlasJson(const uint8_t *data,
+                        size_t size,
+                        const std::string &imgFilename,
+                        const std::string &atlasFilename,
+                        yourgame::gl::AtlasData &dst)
+    {
+        json jAtlas;
+        bool jParsed = false;
+
+        try
+        {
+            jAtlas = json::parse(data, data + size);
+            jParsed = true;
+        }
+        catch (std::exception &e)
+        {
+            yourgame::log::warn("loadAtlasData(): failed to parse atlas file %v (json): %v", atlasFilename, e.what());
+        }
+
+        bool ok = jParsed;
+        if (jParsed)
+        {
+            // FTP "array"
+            if (jAtlas.contains("frames") && jAtlas["frames"].is_array())
+            {
+                try
+                {
+                    for (auto &jFrame : jAtlas["frames"])
+                    {
+                        bool rotated = jFrame.at("rotated").get<bool>();
+                        int pixelWidth;
+                        int pixelHeight;
+
+                        // FTP reports the original width and height of a frame,
+                        // even if rotated. Therefore, width and height need to
+                        // be swapped here to represent the actual dimensions
+                        // of the frame in the texture image.
+                        if (rotated)
+                        {
+                            pixelWidth = jFrame.at("frame").at("h").get<int>();
+                            pixelHeight = jFrame.at("frame").at("w").get<int>();
+                        }
+                        else
+                        {
+                            pixelWidth = jFrame.at("frame").at("w").get<int>();
+                            pixelHeight = jFrame.at("frame").at("h").get<int>();
+                        }
+
+                        dst.addFrame(jFrame.at("filename").get<std::string>(),
+                                     jFrame.at("frame").at("x").get<int>(),
+                                     jFrame.at("frame").at("y").get<int>(),
+                                     pixelWidth,
+                                     pixelHeight,
+                                     rotated);
+                    }
+                }
+                catch (std::exception &e)
+                {
+                    yourgame::log::warn("loadAtlasData(): failed to read frames from atlas file %v (json, FTP array): %v", atlasFilename, e.what());
+                    ok = false;
+                }
+            }
+            // FTP "hash"
+            else if (jAtlas.contains("frames") && jAtlas["frames"].is_object())
+            {
+                try
+                {
+                    for (auto &jFrame : jAtlas["frames"].items())
+                    {
+                        bool rotated = jFrame.value().at("rotated").get<bool>();
+                        int pixelWidth;
+                        int pixelHeight;
+
+                        // FTP reports the original width and height of a frame,
+                        // even if rotated. Therefore, width and height need to
+                        // be swapped here to represent the actual dimensions
+                        // of the frame in the texture image.
+                        if (rotated)
+                        {
+                            pixelWidth = jFrame.value().at("frame").at("h").get<int>();
+                            pixelHeight = jFrame.value().at("frame").at("w").get<int>();
+                        }
+                        else
+                        {
+                            pixelWidth = jFrame.value().at("frame").at("w").get<int>();
+                            pixelHeight = jFrame.value().at("frame").at("h").get<int>();
+                        }
+
+                        dst.addFrame(jFrame.key(),
+                                     jFrame.value().at("frame").at("x").get<int>(),
+                                     jFrame.value().at("frame").at("y").get<int>(),
+                                     pixelWidth,
+                                     pixelHeight,
+                                     rotated);
+                    }
+                }
+                catch (std::exception &e)
+                {
+                    yourgame::log::warn("loadAtlasData(): failed to read frames from atlas file %v (json, FTP hash): %v", atlasFilename, e.what());
+                    ok = false;
+                }
+            }
+            // Crunch
+            else if (jAtlas.contains("textures") && jAtlas["textures"].is_array())
+            {
+                try
+                {
+                    // crunch atlas files contain information for multiple
+                    // image files, but we only want the current texture to load.
+                    for (auto &jTex : jAtlas["textures"])
+                    {
+                        if (yourgame::file::getFileNameWithoutExtension(imgFilename) ==
+                            jTex.at("name").get<std::string>())
+                        {
+                            for (auto &jImg : jTex.at("images"))
+                            {
+                                dst.addFrame(jImg.at("n").get<std::string>(),
+                                             jImg.at("x").get<int>(),
+                                             jImg.at("y").get<int>(),
+                                             jImg.at("w").get<int>(),
+                                             jImg.at("h").get<int>(),
+                                             false);
+                            }
+                            break;
+                        }
+                    }
+                }
+                catch (std::exception &e)
+                {
+                    yourgame::log::warn("loadAtlasData(): failed to read frames from atlas file %v (json, Crunch): %v", atlasFilename, e.what());
+                    ok = false;
+                }
+            }
+            else
+            {
+                yourgame::log::warn("loadAtlasData(): unknown atlas file format %v", atlasFilename);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    /* parses an include directive line (#include "path" or #include <path>), returns false if it is none */
+    bool parseIncludeDirective(const std::string &line, std::string &path)
+    {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line[i] != '#')
+        {
+            return false;
+        }
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string::npos || line.compare(i, 7, "include") != 0)
+        {
+            return false;
+        }
+        i = line.find_first_not_of(" \t", i + 7);
+        if (i == std::string::npos || (line[i] != '"' && line[i] != '<'))
+        {
+            return false;
+        }
+        size_t end = line.find((line[i] == '"') ? '"' : '>', i + 1);
+        if (end == std::string::npos)
+        {
+            return false;
+        }
+        path = line.substr(i + 1, end - i - 1);
+        return !path.empty();
+    }
+
+    /* path of an included file: as given if it has a prefix ("a//", ...) or is absolute,
+    relative to the directory of the including file otherwise */
+    std::string getIncludeFilename(const std::string &includingFilename, const std::string &path)
+    {
+        if ((path.length() > 3 && path.compare(1, 2, "//") == 0) || path[0] == '/')
+        {
+            return path;
+        }
+        return includingFilename.substr(0, includingFilename.rfind('/') + 1) + path;
+    }
+
+    /* appends source (of file filename) to dst, replacing include directives by the (resolved)
+    content of the included files. files in included are skipped, each file is inserted once */
+    int resolveIncludes(const std::string &source,
+                        const std::string &filename,
+                        std::vector<std::string> &included,
+                        std::string &dst)
+    {
+        size_t pos = 0;
+        int lineNumber = 0;
+        while (pos < source.size())
+        {
+            size_t end = source.find('\n', pos);
+            size_t next = (end == std::string::npos) ? source.size() : end + 1;
+            lineNumber++;
+
+            std::string path;
+            if (!parseIncludeDirective(source.substr(pos, next - pos), path))
+            {
+                dst.append(source, pos, next - pos);
+                pos = next;
+                continue;
+            }
+            pos = next;
+
+            std::string includeFilename = getIncludeFilename(filename, path);
+            if (std::find(included.begin(), included.end(), includeFilename) != included.end())
+            {
+                continue;
+            }
+            included.push_back(includeFilename);
+
+            yourgame::file::FileView includeData;
+            if (yourgame::file::mapFile(includeFilename, includeData) != 0)
+            {
+                yourgame::log::error("loadShaderSource(): %v:%v: failed to include %v", filename, lineNumber, includeFilename);
+                return -1;
+            }
+            std::string includeSource(includeData.data(), includeData.data() + includeData.size());
+            if (resolveIncludes(includeSource, includeFilename, included, dst) != 0)
+            {
+                return -1;
+            }
+            if (!dst.empty() && dst.back() != '\n')
+            {
+                dst += '\n';
+            }
+        }
+        return 0;
+    }
+} // namespace
+
 namespace yourgame
 {
     namespace gl
     {
-        Texture *loadTexture(const std::string &imgFilename,
-                             const std::string &atlasFilename,
-                             const yourgame::gl::TextureConfig &cfg)
+        int loadTextureData(const std::string &filename,
+                            TextureData &dst,
+                            bool flipVertically,
+                            bool premultiplyAlpha)
         {
-            Texture *texture = nullptr;
+            yourgame::file::FileView fileData;
+            if (yourgame::file::mapFile(filename, fileData))
+            {
+                yourgame::log::error("loadTextureData(): failed to load file %v", filename);
+                return -1;
+            }
+
+            if (isKtxFile(filename))
+            {
+                return parseKtx(fileData.data(), fileData.size(), dst) ? 0 : -2;
+            }
+
+            std::unique_ptr<yourgame::util::Image> img(
+                yourgame::util::Image::fromMemoryEncoded(fileData.data(), fileData.size(), flipVertically));
+            if (!img)
+            {
+                yourgame::log::error("loadTextureData(): failed to decode image file %v", filename);
+                return -2;
+            }
+            if (premultiplyAlpha)
+            {
+                img->premultiplyAlpha();
+            }
+
+            dst = TextureData();
+            dst.levels.push_back({img->getWidth(),
+                                  img->getHeight(),
+                                  {std::vector<uint8_t>(img->getData(), img->getData() + img->getNumDemandedBytes())}});
+            return 0;
+        }
 
-            std::vector<uint8_t> imgData;
-            yourgame::file::readFile(imgFilename, imgData);
+        const std::vector<GLint> &getCompressedTextureFormats()
+        {
+            static std::vector<GLint> formats;
+            static bool queried = false;
+            if (!queried)
+            {
+                GLint numFormats = 0;
+                glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numFormats);
+                formats.resize((size_t)std::max(numFormats, 0));
+                if (numFormats > 0)
+                {
+                    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+                }
+                queried = true;
+            }
+            return formats;
+        }
 
-            yourgame::util::Image *img =
-                yourgame::util::Image::fromMemoryEncoded(imgData.data(), imgData.size(), true);
+        bool makeUploadable(TextureData &data, const std::vector<GLint> &supportedFormats)
+        {
+            if (!data.isCompressed() ||
+                std::find(supportedFormats.begin(), supportedFormats.end(), data.internalFormat) != supportedFormats.end())
+            {
+                return true;
+            }
+            yourgame::log::info("compressed texture format %v not supported, decompressing", data.internalFormat);
+            if (!data.decompress())
+            {
+                yourgame::log::error("compressed texture format %v can not be decompressed", data.internalFormat);
+                return false;
+            }
+            return true;
+        }
 
-            if (img)
+        Texture *makeTexture(const TextureData &data, const yourgame::gl::TextureConfig &cfg)
+        {
+            // copied only if it needs to be decompressed
+            const TextureData *uploadData = &data;
+            TextureData decompressed;
+            const auto &formats = getCompressedTextureFormats();
+            if (data.isCompressed() && std::find(formats.begin(), formats.end(), data.internalFormat) == formats.end())
             {
-                if (cfg.premultiplyAlpha)
+                decompressed = data;
+                if (!makeUploadable(decompressed, formats))
                 {
-                    img->premultiplyAlpha();
+                    return nullptr;
                 }
+                uploadData = &decompressed;
+            }
+            return createTexture(*uploadData, cfg);
+        }
 
-                std::vector<std::pair<GLenum, GLint>> texParamI = {{GL_TEXTURE_MIN_FILTER, cfg.minMagFilter},
-                                                                   {GL_TEXTURE_MAG_FILTER, cfg.minMagFilter},
-                                                                   {GL_TEXTURE_WRAP_S, cfg.wrapMode},
-                                                                   {GL_TEXTURE_WRAP_T, cfg.wrapMode}};
-                texParamI.insert(texParamI.end(), cfg.parameteri.begin(), cfg.parameteri.end());
+        Texture *loadTexture(const std::string &imgFilename,
+                             const std::string &atlasFilename,
+                             const yourgame::gl::TextureConfig &cfg)
+        {
+            Texture *texture = nullptr;
 
-                texture = Texture::make(GL_TEXTURE_2D, cfg.unit, texParamI);
-                texture->updateData(GL_TEXTURE_2D,
-                                    0,
-                                    GL_RGBA8,
-                                    img->getWidth(),
-                                    img->getHeight(),
-                                    0,
-                                    GL_RGBA,
-                                    GL_UNSIGNED_BYTE,
-                                    img->getData(),
-                                    cfg.generateMipmap);
-                delete img;
+            TextureData data;
+            if (loadTextureData(imgFilename, data, true, cfg.premultiplyAlpha) == 0)
+            {
+                texture = makeTexture(data, cfg);
             }
-            else
+            if (!texture)
             {
                 yourgame::log::warn("loadTexture(): failed to load image file %v", imgFilename);
             }
 
-            // process atlas file
             if (texture && atlasFilename != "")
             {
-                std::vector<uint8_t> atlasFile;
-                json jAtlas;
-                bool jParsed = false;
+                // frames read before a failure are inserted as well
+                AtlasData atlas;
+                loadAtlasData(imgFilename, atlasFilename, atlas);
+                texture->insertAtlas(atlas);
+            }
+
+            return texture;
+        }
+
+        int loadAtlasData(const std::string &imgFilename,
+                          const std::string &atlasFilename,
+                          AtlasData &dst)
+        {
+            dst = AtlasData();
+
+            yourgame::file::FileView atlasFile;
+            if (yourgame::file::mapFile(atlasFilename, atlasFile))
+            {
+                yourgame::log::warn("loadAtlasData(): failed to load atlas file %v for image file %v", atlasFilename, imgFilename);
+                return -1;
+            }
+
+            if (isAtlasCacheFile(atlasFilename))
+            {
+                return decodeAtlasCache(atlasFile.data(), atlasFile.size(), dst) ? 0 : -2;
+            }
+
+            bool parsed = parseAtlasJson(atlasFile.data(), atlasFile.size(), imgFilename, atlasFilename, dst);
+            dst.sortSequences();
+            return parsed ? 0 : -2;
+        }
+
+        int saveAtlasData(const AtlasData &atlas, const std::string &cacheFilename)
+        {
+            std::vector<uint8_t> atlasCache = encodeAtlasCache(atlas);
+            if (yourgame::file::writeFile(cacheFilename, atlasCache.data(), atlasCache.size()))
+            {
+                yourgame::log::error("saveAtlasData(): failed to write atlas cache %v", cacheFilename);
+                return -3;
+            }
+            return 0;
+        }
+
+        int saveAtlasCache(const std::string &imgFilename,
+                           const std::string &atlasFilename,
+                           const std::string &cacheFilename)
+        {
+            AtlasData atlas;
+            int ret = loadAtlasData(imgFilename, atlasFilename, atlas);
+            if (ret)
+            {
+                return ret;
+            }
+            return saveAtlasData(atlas, cacheFilename);
+        }
 
-                if (yourgame::file::readFile(atlasFilename, atlasFile))
+        Texture *loadCubemap(const std::vector<std::string> &filenames,
+                             const yourgame::gl::TextureConfig &cfg)
+        {
+            // all faces are loaded first, the parameters depend on their number of mipmap levels
+            std::vector<TextureData> faces(filenames.size());
+            size_t numLevels = 0;
+            for (int i = 0; i < filenames.size(); i++)
+            {
+                if (loadTextureData(filenames[i], faces[i], false, cfg.premultiplyAlpha) == 0 &&
+                    faces[i].target == GL_TEXTURE_2D &&
+                    makeUploadable(faces[i], getCompressedTextureFormats()))
                 {
-                    yourgame::log::warn("loadTexture(): failed to load atlas file %v for image file %v", atlasFilename, imgFilename);
+                    numLevels = (i == 0) ? faces[i].levels.size() : std::min(numLevels, faces[i].levels.size());
                 }
                 else
                 {
-                    try
-                    {
-                        jAtlas = json::parse(atlasFile);
-                        jParsed = true;
-                    }
-                    catch (std::exception &e)
-                    {
-                        yourgame::log::warn("loadTexture(): failed to parse atlas file %v (json): %v", atlasFilename, e.what());
-                    }
+                    yourgame::log::warn("image %v failed to load", filenames[i]);
+                    return nullptr;
                 }
+            }
+
+            Texture *texture = Texture::make(GL_TEXTURE_CUBE_MAP, cfg.unit, getTextureParameters(cfg, true, numLevels));
+            for (int i = 0; i < faces.size(); i++)
+            {
+                uploadTextureData(texture, faces[i], GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, cfg.generateMipmap);
+            }
 
-                if (jParsed)
+            return texture;
+        }
+
+        std::shared_ptr<AsyncTexture> loadTextureAsync(const std::string &imgFilename,
+                                                       const std::string &atlasFilename,
+                                                       const yourgame::gl::TextureConfig &cfg,
+                                                       std::function<void(AsyncTexture &)> callback,
+                                                       int priority,
+                                                       bool placeholder)
+        {
+            auto handle = std::make_shared<AsyncTexture>();
+            handle->filename = imgFilename;
+            Texture *placeholderTexture = nullptr;
+            if (placeholder)
+            {
+                placeholderTexture = Texture::make(GL_TEXTURE_2D, cfg.unit, getTextureParameters(cfg, false));
+                uploadPlaceholder(placeholderTexture, GL_TEXTURE_2D);
+                handle->texture = placeholderTexture;
+            }
+
+            // the formats are queried here, as the worker thread has no GL context
+            std::vector<GLint> supportedFormats = getCompressedTextureFormats();
+
+            yourgame_internal::worker::post(
+                [handle, placeholderTexture, imgFilename, atlasFilename, cfg, callback, supportedFormats, priority]()
                 {
-                    // FTP "array"
-                    if (jAtlas.contains("frames") && jAtlas["frames"].is_array())
+                    // decoding (or decompression) and atlas parsing on the worker thread
+                    auto data = std::make_shared<TextureData>();
+                    bool loaded = loadTextureData(imgFilename, *data, true, cfg.premultiplyAlpha) == 0 &&
+                                  makeUploadable(*data, supportedFormats);
+                    auto atlas = std::make_shared<AtlasData>();
+                    if (loaded && atlasFilename != "")
                     {
-                        try
+                        loadAtlasData(imgFilename, atlasFilename, *atlas);
+                    }
+
+                    // upload on the main thread, staged through a pixel unpack buffer
+                    yourgame_internal::worker::postToMain(
+                        [handle, placeholderTexture, data, atlas, loaded, imgFilename, cfg, callback, priority]()
                         {
-                            for (auto &jFrame : jAtlas["frames"])
+                            auto finish = [handle, placeholderTexture, data, atlas, loaded, imgFilename, cfg, callback](const std::vector<GLintptr> *pboOffsets)
                             {
-                                bool rotated = jFrame.at("rotated").get<bool>();
-                                int pixelWidth;
-                                int pixelHeight;
-
-                                // FTP reports the original width and height of a frame,
-                                // even if rotated. Therefore, width and height need to
-                                // be swapped here to represent the actual dimensions
-                                // of the frame in the texture image.
-                                if (rotated)
+                                Texture *texture = nullptr;
+                                if (loaded && placeholderTexture)
                                 {
-                                    pixelWidth = jFrame.at("frame").at("h").get<int>();
-                                    pixelHeight = jFrame.at("frame").at("w").get<int>();
+                                    // the data replaces the placeholder (2d only)
+                                    if (data->target == GL_TEXTURE_2D)
+                                    {
+                                        texture = placeholderTexture;
+                                        if (data->levels.size() > 1)
+                                        {
+                                            texture->setParameteri(GL_TEXTURE_MAX_LEVEL, (GLint)data->levels.size() - 1);
+                                        }
+                                        uploadTextureData(texture, *data, GL_TEXTURE_2D, cfg.generateMipmap, pboOffsets);
+                                    }
                                 }
-                                else
+                                else if (loaded)
                                 {
-                                    pixelWidth = jFrame.at("frame").at("w").get<int>();
-                                    pixelHeight = jFrame.at("frame").at("h").get<int>();
+                                    texture = createTexture(*data, cfg, pboOffsets);
                                 }
 
-                                texture->insertCoords(jFrame.at("filename").get<std::string>(),
-                                                      jFrame.at("frame").at("x").get<int>(),
-                                                      jFrame.at("frame").at("y").get<int>(),
-                                                      pixelWidth,
-                                                      pixelHeight,
-                                                      rotated);
-                            }
-                        }
-                        catch (std::exception &e)
-                        {
-                            yourgame::log::warn("loadTexture(): failed to read frames from atlas file %v (json, FTP array): %v", atlasFilename, e.what());
-                        }
-                    }
-                    // FTP "hash"
-                    else if (jAtlas.contains("frames") && jAtlas["frames"].is_object())
-                    {
-                        try
-                        {
-                            for (auto &jFrame : jAtlas["frames"].items())
-                            {
-                                bool rotated = jFrame.value().at("rotated").get<bool>();
-                                int pixelWidth;
-                                int pixelHeight;
-
-                                // FTP reports the original width and height of a frame,
-                                // even if rotated. Therefore, width and height need to
-                                // be swapped here to represent the actual dimensions
-                                // of the frame in the texture image.
-                                if (rotated)
+                                if (texture)
                                 {
-                                    pixelWidth = jFrame.value().at("frame").at("h").get<int>();
-                                    pixelHeight = jFrame.value().at("frame").at("w").get<int>();
+                                    texture->insertAtlas(*atlas);
+                                    handle->texture = texture;
+                                    handle->result = 0;
                                 }
                                 else
                                 {
-                                    pixelWidth = jFrame.value().at("frame").at("w").get<int>();
-                                    pixelHeight = jFrame.value().at("frame").at("h").get<int>();
+                                    yourgame::log::warn("loadTextureAsync(): failed to load image file %v", imgFilename);
+                                }
+                                handle->done = true;
+                                if (callback)
+                                {
+                                    callback(*handle);
                                 }
+                            };
 
-                                texture->insertCoords(jFrame.key(),
-                                                      jFrame.value().at("frame").at("x").get<int>(),
-                                                      jFrame.value().at("frame").at("y").get<int>(),
-                                                      pixelWidth,
-                                                      pixelHeight,
-                                                      rotated);
+                            if (loaded)
+                            {
+                                stageTextureData(data, priority, finish);
                             }
-                        }
-                        catch (std::exception &e)
+                            else
+                            {
+                                finish(nullptr);
+                            }
+                        });
+                },
+                priority);
+
+            return handle;
+        }
+
+        std::shared_ptr<AsyncTexture> loadCubemapAsync(const std::vector<std::string> &filenames,
+                                                       const yourgame::gl::TextureConfig &cfg,
+                                                       std::function<void(AsyncTexture &)> callback,
+                                                       int priority,
+                                                       bool placeholder)
+        {
+            auto handle = std::make_shared<AsyncTexture>();
+            handle->filename = filenames.empty() ? "" : filenames[0];
+            Texture *texture = Texture::make(GL_TEXTURE_CUBE_MAP, cfg.unit, getTextureParameters(cfg, true));
+            if (placeholder)
+            {
+                for (GLenum i = 0; i < 6; i++)
+                {
+                    uploadPlaceholder(texture, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+                }
+                handle->texture = texture;
+            }
+
+            // the faces are decoded in parallel, and uploaded as they arrive.
+            // numPending, numLevels and failed are only accessed on the main thread
+            auto numPending = std::make_shared<size_t>(filenames.size());
+            auto numLevels = std::make_shared<size_t>(0);
+            auto failed = std::make_shared<bool>(filenames.empty());
+            auto finish = [handle, texture, cfg, numLevels, failed, callback]()
+            {
+                if (!*failed)
+                {
+                    if (*numLevels > 1)
+                    {
+                        // the texture was made before the number of mipmap levels was known
+                        for (const auto &param : getTextureParameters(cfg, true, *numLevels))
                         {
-                            yourgame::log::warn("loadTexture(): failed to read frames from atlas file %v (json, FTP hash): %v", atlasFilename, e.what());
+                            texture->setParameteri(param.first, param.second);
                         }
                     }
-                    // Crunch
-                    else if (jAtlas.contains("textures") && jAtlas["textures"].is_array())
+                    handle->texture = texture;
+                    handle->result = 0;
+                }
+                else if (!handle->texture)
+                {
+                    delete texture;
+                }
+                handle->done = true;
+                if (callback)
+                {
+                    callback(*handle);
+                }
+            };
+
+            if (filenames.empty())
+            {
+                yourgame_internal::worker::postToMain(finish);
+            }
+
+            std::vector<GLint> supportedFormats = getCompressedTextureFormats();
+            for (size_t i = 0; i < filenames.size(); i++)
+            {
+                auto f = filenames[i];
+                yourgame_internal::worker::post(
+                    [texture, f, i, cfg, numPending, numLevels, failed, finish, supportedFormats, priority]()
                     {
-                        try
-                        {
-                            // crunch atlas files contain information for multiple
-                            // image files, but we only want the current texture to load.
-                            for (auto &jTex : jAtlas["textures"])
+                        auto data = std::make_shared<TextureData>();
+                        bool loaded = loadTextureData(f, *data, false, cfg.premultiplyAlpha) == 0 &&
+                                      data->target == GL_TEXTURE_2D &&
+                                      makeUploadable(*data, supportedFormats);
+
+                        yourgame_internal::worker::postToMain(
+                            [texture, f, i, data, loaded, cfg, numPending, numLevels, failed, finish, priority]()
                             {
-                                if (yourgame::file::getFileNameWithoutExtension(imgFilename) ==
-                                    jTex.at("name").get<std::string>())
+                                auto uploadFace = [texture, i, data, cfg, numPending, numLevels, failed, finish](const std::vector<GLintptr> *pboOffsets)
                                 {
-                                    for (auto &jImg : jTex.at("images"))
+                                    if (!*failed)
+                                    {
+                                        *numLevels = (*numLevels == 0) ? data->levels.size() : std::min(*numLevels, data->levels.size());
+                                        uploadTextureData(texture, *data, GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)i, cfg.generateMipmap, pboOffsets);
+                                    }
+                                    if (--*numPending == 0)
                                     {
-                                        texture->insertCoords(jImg.at("n").get<std::string>(),
-                                                              jImg.at("x").get<int>(),
-                                                              jImg.at("y").get<int>(),
-                                                              jImg.at("w").get<int>(),
-                                                              jImg.at("h").get<int>(),
-                                                              false);
+                                        finish();
                                     }
-                                    break;
+                                };
+
+                                if (!loaded)
+                                {
+                                    yourgame::log::warn("loadCubemapAsync(): image %v failed to load", f);
+                                    *failed = true;
+                                    uploadFace(nullptr);
                                 }
-                            }
-                        }
-                        catch (std::exception &e)
-                        {
-                            yourgame::log::warn("loadTexture(): failed to read frames from atlas file %v (json, Crunch): %v", atlasFilename, e.what());
-                        }
-                    }
-                    else
-                    {
-                        yourgame::log::warn("loadTexture(): unknown atlas file format %v", atlasFilename);
-                    }
-                }
+                                else
+                                {
+                                    stageTextureData(data, priority, uploadFace);
+                                }
+                            });
+                    },
+                    priority);
             }
 
-            return texture;
+            return handle;
         }
 
-        Texture *loadCubemap(const std::vector<std::string> &filenames,
-                             const yourgame::gl::TextureConfig &cfg)
+        int loadShaderSource(const std::string &filename, std::string &dst)
         {
-            std::vector<std::pair<GLenum, GLint>> texParamI = {{GL_TEXTURE_MIN_FILTER, cfg.minMagFilter},
-                                                               {GL_TEXTURE_MAG_FILTER, cfg.minMagFilter},
-                                                               {GL_TEXTURE_WRAP_S, cfg.wrapMode},
-                                                               {GL_TEXTURE_WRAP_T, cfg.wrapMode},
-                                                               {GL_TEXTURE_WRAP_R, cfg.wrapMode}};
-            texParamI.insert(texParamI.end(), cfg.parameteri.begin(), cfg.parameteri.end());
+            yourgame::file::FileView shdrCode;
+            if (yourgame::file::mapFile(filename, shdrCode) != 0)
+            {
+                yourgame::log::error("loadShaderSource(): failed to load %v", filename);
+                return -1;
+            }
+            std::string source(shdrCode.data(), shdrCode.data() + shdrCode.size());
 
-            Texture *texture = Texture::make(GL_TEXTURE_CUBE_MAP, cfg.unit, texParamI);
+            std::vector<std::string> included = {filename};
+            std::string resolved;
+            if (resolveIncludes(source, filename, included, resolved) != 0)
+            {
+                return -1;
+            }
+            dst = std::move(resolved);
+            return 0;
+        }
 
-            for (int i = 0; i < filenames.size(); i++)
+        Shader *loadShader(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                           const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                           const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+        {
+            return loadShaderVariant(shaderFilenames, {}, attrLocs, fragDataLocs);
+        }
+
+        Shader *loadShaderVariant(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                                  const std::vector<std::string> &defines,
+                                  const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                  const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+        {
+            std::vector<std::pair<GLenum, std::string>> shaderCodes;
+
+            for (const auto &shdrFile : shaderFilenames)
             {
-                auto f = filenames[i];
-                std::vector<uint8_t> imgData;
-                yourgame::file::readFile(f, imgData);
+                std::string shdrStr;
+                if (loadShaderSource(shdrFile.second, shdrStr) != 0)
+                {
+                    return nullptr;
+                }
+                shaderCodes.push_back(std::make_pair(shdrFile.first, shdrStr));
+            }
+
+            return loadShaderFromStrings(shaderCodes, attrLocs, fragDataLocs, defines);
+        }
 
-                yourgame::util::Image *img =
-                    yourgame::util::Image::fromMemoryEncoded(imgData.data(), imgData.size(), false);
+        std::vector<Shader *> loadShaders(const std::vector<std::vector<std::pair<GLenum, std::string>>> &programs)
+        {
+            std::vector<Shader *> shaders(programs.size(), nullptr);
+            std::vector<size_t> programIndices; // per batch index
+            const std::string prologue = getShaderPrologue({});
 
-                if (img)
+            ShaderBatch batch;
+            for (size_t i = 0; i < programs.size(); i++)
+            {
+                std::vector<std::pair<GLenum, std::string>> shaderCodes;
+                bool loaded = true;
+                for (const auto &shdrFile : programs[i])
                 {
-                    if (cfg.premultiplyAlpha)
+                    std::string shdrStr;
+                    if (loadShaderSource(shdrFile.second, shdrStr) != 0)
                     {
-                        img->premultiplyAlpha();
+                        loaded = false;
+                        break;
                     }
-
-                    texture->updateData(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                                        0,
-                                        GL_RGBA8,
-                                        img->getWidth(),
-                                        img->getHeight(),
-                                        0,
-                                        GL_RGBA,
-                                        GL_UNSIGNED_BYTE,
-                                        img->getData(),
-                                        cfg.generateMipmap);
-                    delete img;
+                    shaderCodes.push_back(std::make_pair(shdrFile.first, prologue + shdrStr));
                 }
-                else
+
+                if (loaded)
                 {
-                    yourgame::log::warn("image %v failed to load", f);
-                    delete texture;
-                    return nullptr;
+                    batch.submit(shaderCodes);
+                    programIndices.push_back(i);
                 }
             }
 
-            return texture;
+            // everything is submitted, finishing in order lets the driver compile the rest meanwhile
+            batch.poll([&](size_t index, Shader *shader, const std::string &errorLog)
+                       {
+                           if (!shader)
+                           {
+                               yourgame::log::error("shader failed to make: %v", errorLog);
+                           }
+                           shaders[programIndices[index]] = shader; },
+                       true);
+
+            return shaders;
         }
 
-        Shader *loadShader(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
-                           const std::vector<std::pair<GLuint, std::string>> &attrLocs,
-                           const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+        ShaderVariants *loadShaderVariants(const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                                           const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                           const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
         {
             std::vector<std::pair<GLenum, std::string>> shaderCodes;
 
             for (const auto &shdrFile : shaderFilenames)
             {
-                std::vector<uint8_t> shdrCode;
-                yourgame::file::readFile(shdrFile.second, shdrCode);
-                std::string shdrStr = std::string(shdrCode.begin(), shdrCode.end());
+                std::string shdrStr;
+                if (loadShaderSource(shdrFile.second, shdrStr) != 0)
+                {
+                    return nullptr;
+                }
                 shaderCodes.push_back(std::make_pair(shdrFile.first, shdrStr));
             }
 
-            return loadShaderFromStrings(shaderCodes, attrLocs, fragDataLocs);
+            return ShaderVariants::make(shaderCodes, attrLocs, fragDataLocs);
+        }
+
+        std::string getShaderPrologue(const std::vector<std::string> &defines)
+        {
+            std::string prologue = std::string(YOURGAME_GLSL_VERSION_STRING) + "\n";
+            for (const auto &define : defines)
+            {
+                std::string line = define;
+                std::replace(line.begin(), line.end(), '=', ' ');
+                prologue += "#define " + line + "\n";
+            }
+            return prologue;
         }
 
         Shader *loadShaderFromStrings(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
                                       const std::vector<std::pair<GLuint, std::string>> &attrLocs,
-                                      const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+                                      const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
+                                      const std::vector<std::string> &defines)
         {
             std::string shaderErrLog;
 
+            const std::string prologue = getShaderPrologue(defines);
             auto shaderCodesWithVersion = shaderCodes;
             for (auto &shaderCode : shaderCodesWithVersion)
             {
-                shaderCode.second = std::string(YOURGAME_GLSL_VERSION_STRING) + "\n" + shaderCode.second;
+                shaderCode.second = prologue + shaderCode.second;
             }
 
             Shader *newShader = Shader::make(shaderCodesWithVersion, attrLocs, fragDataLocs, shaderErrLog);
@@ -312,233 +1897,158 @@ namespace yourgame
             return newShader;
         }
 
-        Geometry *loadGeometry(const std::string &objFilename,
-                               const std::string &mtlFilename)
+        int loadMeshData(const std::string &filename,
+                         const std::string &mtlFilename,
+                         MeshData &dst)
         {
-            yourgame::log::debug("loading geometry %v...", objFilename);
+            if (isMeshCacheFile(filename))
+            {
+                yourgame::file::FileView cacheData;
+                if (yourgame::file::mapFile(filename, cacheData))
+                {
+                    yourgame::log::error("loadMeshData(): failed to load mesh cache %v", filename);
+                    return -1;
+                }
+                std::vector<BufferView> bufferViews;
+                if (!decodeMeshCache(cacheData.data(), cacheData.size(), dst, bufferViews))
+                {
+                    return -2;
+                }
+                for (size_t i = 0; i < bufferViews.size(); i++)
+                {
+                    dst.buffers[i].data.assign(bufferViews[i].first, bufferViews[i].first + bufferViews[i].second);
+                }
+                return 0;
+            }
+
+            return parseObjFiles(filename, mtlFilename, dst);
+        }
 
-            std::vector<uint8_t> objData;
-            if (yourgame::file::readFile(objFilename, objData))
+        Geometry *makeGeometry(const MeshData &meshData)
+        {
+            std::vector<BufferView> bufferViews;
+            for (const auto &buf : meshData.buffers)
             {
-                yourgame::log::error("loadGeometry(): failed to load obj file %v", objFilename);
-                return nullptr;
+                bufferViews.push_back(std::make_pair(buf.data.data(), buf.data.size()));
             }
-            std::string objStr(objData.begin(), objData.end());
+            return uploadGeometry(meshData, bufferViews);
+        }
+
+        Geometry *loadGeometry(const std::string &objFilename,
+                               const std::string &mtlFilename,
+                               const MeshProcessing &processing)
+        {
+            yourgame::log::debug("loading geometry %v...", objFilename);
 
-            std::string mtlStr = "";
-            if (!mtlFilename.empty())
+            // mesh caches are uploaded directly from the mapped file
+            if (isMeshCacheFile(objFilename) && !isProcessing(processing))
             {
-                std::vector<uint8_t> mtlData;
-                if (yourgame::file::readFile(mtlFilename, mtlData))
+                yourgame::file::FileView cacheData;
+                if (yourgame::file::mapFile(objFilename, cacheData))
+                {
+                    yourgame::log::error("loadGeometry(): failed to load mesh cache %v", objFilename);
+                    return nullptr;
+                }
+                MeshData meshData;
+                std::vector<BufferView> bufferViews;
+                if (!decodeMeshCache(cacheData.data(), cacheData.size(), meshData, bufferViews))
                 {
-                    yourgame::log::error("loadGeometry(): failed to load mtl file %v", mtlFilename);
                     return nullptr;
                 }
-                mtlStr = std::string(mtlData.begin(), mtlData.end());
+                return uploadGeometry(meshData, bufferViews);
             }
 
-            return loadGeometryFromStrings(objStr, mtlStr);
-        }
-
-        Geometry *loadGeometryFromStrings(const std::string &objCode,
-                                          const std::string &mtlCode)
-        {
-            tinyobj::ObjReader objRdr;
-            tinyobj::ObjReaderConfig objRdrCfg;
-            objRdrCfg.triangulate = true;
-            objRdrCfg.vertex_color = true;
-            if (!objRdr.ParseFromString(objCode, mtlCode, objRdrCfg))
+            MeshData meshData;
+            if (loadMeshData(objFilename, mtlFilename, meshData))
             {
-                yourgame::log::error("tinyobj::ObjReader::ParseFromString failed");
                 return nullptr;
             }
+            meshData.process(processing);
+            return makeGeometry(meshData);
+        }
 
-            auto shapes = objRdr.GetShapes();
-            auto attribs = objRdr.GetAttrib();
-            auto materials = objRdr.GetMaterials();
-
-            yourgame::log::debug("%v shape(s), %v material(s)", shapes.size(), materials.size());
-
-            std::vector<GLuint> objIdxData;
-            std::vector<GLuint> objLineIdxData;
-            std::vector<GLfloat> objPosData;
-            std::vector<GLfloat> objNormalData;
-            std::vector<GLfloat> objTexCoordData;
-            std::vector<GLfloat> objColordData;
-
-            // each mesh index (here: 3 of them form a triangle (face)), references:
-            //   (1) vertex position (and color),
-            //   (2) normal,
-            //   (3) texture coordinates and
-            //   (4) meterial index (of the face),
-            // that are parsed separately.
-            // uniqueIdxMap is used to track unique combinations of (1-4)
-            std::map<std::array<int, 4>, int> uniqueIdxMap;
-            GLuint uniqueVertCount = 0U;
-
-            // we merge all obj meshes (triangle shapes) into one GLGeometry shape,
-            // and all obj line shapes into another GLGeometry shape
-            for (auto const &shape : shapes)
-            {
-                yourgame::log::debug("shape: %v", shape.name);
-
-                GLuint shapeMeshReadIdx = 0U;
-                for (auto const &idx : shape.mesh.indices)
-                {
-                    // assuming all faces are triangles (objRdrCfg.triangulate is set above),
-                    // get the material id for that face (-1, if no material is assigned)
-                    int materialId = (shape.mesh.material_ids.at(shapeMeshReadIdx / 3U));
-                    auto mapRet = uniqueIdxMap.emplace(
-                        std::array<int, 4>{idx.vertex_index, idx.normal_index, idx.texcoord_index, materialId}, uniqueVertCount);
-                    if (mapRet.second) // new unique vertex
-                    {
-                        try
-                        {
-                            objIdxData.push_back(uniqueVertCount);
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3));
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3 + 1));
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3 + 2));
-
-                            // if material available, use diffuse color as vertex color. if not, use the
-                            // (always available, but maybe default) parsed vertex color
-                            if (materialId > -1 && materialId < materials.size())
-                            {
-                                objColordData.push_back((GLfloat)materials.at(materialId).diffuse[0]);
-                                objColordData.push_back((GLfloat)materials.at(materialId).diffuse[1]);
-                                objColordData.push_back((GLfloat)materials.at(materialId).diffuse[2]);
-                                // todo: optionally, make geometry buffers for other material components:
-                                // ambient, specular, emissive colors, specular exponent ... ?
-                            }
-                            else
-                            {
-                                objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3));
-                                objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3 + 1));
-                                objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3 + 2));
-                            }
-
-                            // if normals available, use them
-                            if (attribs.normals.size() > 0)
-                            {
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3));
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3 + 1));
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3 + 2));
-                            }
+        std::shared_ptr<AsyncGeometry> loadGeometryAsync(const std::string &objFilename,
+                                                         const std::string &mtlFilename,
+                                                         std::function<void(AsyncGeometry &)> callback,
+                                                         int priority,
+                                                         const MeshProcessing &processing)
+        {
+            auto handle = std::make_shared<AsyncGeometry>();
+            handle->filename = objFilename;
 
-                            // if texture coordinates available, use them
-                            if (attribs.texcoords.size() > 0)
-                            {
-                                objTexCoordData.push_back((GLfloat)attribs.texcoords.at(idx.texcoord_index * 2));
-                                objTexCoordData.push_back((GLfloat)attribs.texcoords.at(idx.texcoord_index * 2 + 1));
-                            }
-                        }
-                        catch (...)
-                        {
-                            yourgame::log::error("loadGeometry(): faulty obj vertex data");
-                            return nullptr;
-                        }
-                        uniqueVertCount++;
-                    }
-                    else // reuse unique vertex index
+            yourgame_internal::worker::post(
+                [handle, objFilename, mtlFilename, callback, processing]()
+                {
+                    // cpu stage on the worker thread
+                    auto meshData = std::make_shared<MeshData>();
+                    int result = loadMeshData(objFilename, mtlFilename, *meshData);
+                    if (result == 0)
                     {
-                        objIdxData.push_back((GLuint)(mapRet.first->second));
+                        meshData->process(processing);
                     }
-                    shapeMeshReadIdx++;
-                }
-
-                // lines. todo: work in progress.
-                // - new unique vertices (for lines) are created with material = -1.
-                //   (lines do not have material)
-                // - as the line vertices share buffers with triangle face vertices,
-                //   they must also reference texcoords/normals (if triangle faces do),
-                //   in order to keep the vertex data "aligned"
-                // - assumption: vertices per line: always 2
-                for (auto const &idx : shape.lines.indices)
-                {
-                    int materialId = -1;
-                    auto mapRet = uniqueIdxMap.emplace(
-                        std::array<int, 4>{idx.vertex_index, idx.normal_index, idx.texcoord_index, materialId}, uniqueVertCount);
-                    if (mapRet.second) // new unique vertex
-                    {
-                        try
+
+                    // gl stage on the main thread, the handle is only written there
+                    yourgame_internal::worker::postToMain(
+                        [handle, meshData, result, callback]()
                         {
-                            objLineIdxData.push_back(uniqueVertCount);
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3));
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3 + 1));
-                            objPosData.push_back((GLfloat)attribs.vertices.at(idx.vertex_index * 3 + 2));
-                            objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3));
-                            objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3 + 1));
-                            objColordData.push_back((GLfloat)attribs.colors.at(idx.vertex_index * 3 + 2));
-
-                            // if normals available, use them
-                            if (attribs.normals.size() > 0)
+                            handle->result = result;
+                            if (result == 0)
                             {
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3));
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3 + 1));
-                                objNormalData.push_back((GLfloat)attribs.normals.at(idx.normal_index * 3 + 2));
+                                handle->geometry = makeGeometry(*meshData);
+                                if (!handle->geometry)
+                                {
+                                    handle->result = -3;
+                                }
                             }
-
-                            // if texture coordinates available, use them
-                            if (attribs.texcoords.size() > 0)
+                            handle->done = true;
+                            if (callback)
                             {
-                                objTexCoordData.push_back((GLfloat)attribs.texcoords.at(idx.texcoord_index * 2));
-                                objTexCoordData.push_back((GLfloat)attribs.texcoords.at(idx.texcoord_index * 2 + 1));
+                                callback(*handle);
                             }
-                        }
-                        catch (...)
-                        {
-                            yourgame::log::error("loadGeometry(): faulty line obj vertex data");
-                            return nullptr;
-                        }
-                        uniqueVertCount++;
-                    }
-                    else // reuse unique vertex index
-                    {
-                        objLineIdxData.push_back((GLuint)(mapRet.first->second));
-                    }
-                }
-            }
-
-            Geometry *newGeo = Geometry::make();
+                        });
+                },
+                priority);
 
-            auto vertPosSize = objPosData.size() * sizeof(objPosData[0]);
-            auto vertNormSize = objNormalData.size() * sizeof(objNormalData[0]);
-            auto vertTexcoordsSize = objTexCoordData.size() * sizeof(objTexCoordData[0]);
-            auto vertColorSize = objColordData.size() * sizeof(objColordData[0]);
-            auto vertIdxSize = objIdxData.size() * sizeof(objIdxData[0]);
-            auto vertLineIdxSize = objLineIdxData.size() * sizeof(objLineIdxData[0]);
-
-            // add available buffers to new Geometry and configure
-            // the Geometry shape...
-            std::vector<Shape::ArrBufferDescr> arDescrs =
-                {{attrLocPosition, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0},
-                 {attrLocColor, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}};
-
-            std::vector<std::string> arBufferNames = {"pos", "color"};
+            return handle;
+        }
 
-            newGeo->addBuffer("pos", GL_ARRAY_BUFFER, vertPosSize, objPosData.data(), GL_STATIC_DRAW);
-            newGeo->addBuffer("color", GL_ARRAY_BUFFER, vertColorSize, objColordData.data(), GL_STATIC_DRAW);
-            newGeo->addBuffer("idx", GL_ELEMENT_ARRAY_BUFFER, vertIdxSize, objIdxData.data(), GL_STATIC_DRAW);
-            newGeo->addBuffer("idxLines", GL_ELEMENT_ARRAY_BUFFER, vertLineIdxSize, objLineIdxData.data(), GL_STATIC_DRAW);
-            if (vertNormSize > 0)
+        int saveGeometryCache(const std::string &objFilename,
+                              const std::string &mtlFilename,
+                              const std::string &cacheFilename,
+                              const MeshProcessing &processing)
+        {
+            MeshData meshData;
+            int ret = parseObjFiles(objFilename, mtlFilename, meshData);
+            if (ret)
             {
-                newGeo->addBuffer("norm", GL_ARRAY_BUFFER, vertNormSize, objNormalData.data(), GL_STATIC_DRAW);
-                arDescrs.push_back({attrLocNormal, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0});
-                arBufferNames.push_back("norm");
+                return ret;
             }
-            if (vertTexcoordsSize > 0)
+            meshData.process(processing);
+            return saveMeshData(meshData, cacheFilename);
+        }
+
+        int saveMeshData(const MeshData &meshData, const std::string &cacheFilename)
+        {
+            std::vector<uint8_t> meshCache = encodeMeshCache(meshData);
+            if (yourgame::file::writeFile(cacheFilename, meshCache.data(), meshCache.size()))
             {
-                newGeo->addBuffer("texcoords", GL_ARRAY_BUFFER, vertTexcoordsSize, objTexCoordData.data(), GL_STATIC_DRAW);
-                arDescrs.push_back({attrLocTexcoords, 2, GL_FLOAT, GL_FALSE, 0, (void *)0, 0});
-                arBufferNames.push_back("texcoords");
+                yourgame::log::error("saveMeshData(): failed to write mesh cache %v", cacheFilename);
+                return -3;
             }
+            return 0;
+        }
 
-            // all obj triangle shapes
-            newGeo->addShape("main", arDescrs, arBufferNames, {GL_UNSIGNED_INT, GL_TRIANGLES, (GLsizei)objIdxData.size()}, "idx");
-
-            // all obj line shapes
-            newGeo->addShape("lines", arDescrs, arBufferNames, {GL_UNSIGNED_INT, GL_LINES, (GLsizei)objLineIdxData.size()}, "idxLines");
-
-            return newGeo;
+        Geometry *loadGeometryFromStrings(const std::string &objCode,
+                                          const std::string &mtlCode)
+        {
+            std::istringstream objStream(objCode);
+            std::istringstream mtlStream(mtlCode);
+            MeshData meshData;
+            if (!parseObj(objStream, mtlStream, meshData))
+            {
+                return nullptr;
+            }
+            return makeGeometry(meshData);
         }
     } // namespace gl
 } // namespace yourgame
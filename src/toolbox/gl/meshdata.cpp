@@ -0,0 +1,1333 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "yourgame/gl/conventions.h"
+#include "yourgame/gl/meshdata.h"
+#include "yourgame/log.h"
+
+namespace
+{
+    /* size of one vertex attribute in bytes (0: unknown type) */
+    size_t getAttribSize(GLenum type, GLint numComponents)
+    {
+        switch (type)
+        {
+        case GL_FLOAT:
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+            return 4 * numComponents;
+        case GL_HALF_FLOAT:
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2 * numComponents;
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return numComponents;
+        case GL_INT_2_10_10_10_REV:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    size_t alignAttribSize(size_t size)
+    {
+        return (size + 3) & ~size_t(3);
+    }
+
+    /* one attribute of an (interleaved) vertex buffer, shared by any number of shapes */
+    struct VertexField
+    {
+        yourgame::gl::Shape::ArrBufferDescr oldDescr;
+        size_t oldSize;
+        GLenum newType;
+        GLboolean newNormalized;
+        size_t newSize;
+        size_t newOffset;
+    };
+
+    size_t getIndexSize(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_INT:
+            return 4;
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    std::vector<uint32_t> readIndices(const std::vector<uint8_t> &data, GLenum type)
+    {
+        size_t idxSize = getIndexSize(type);
+        std::vector<uint32_t> indices(idxSize ? data.size() / idxSize : 0);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            switch (type)
+            {
+            case GL_UNSIGNED_INT:
+                std::memcpy(&indices[i], data.data() + i * 4, 4);
+                break;
+            case GL_UNSIGNED_SHORT:
+            {
+                uint16_t idx;
+                std::memcpy(&idx, data.data() + i * 2, 2);
+                indices[i] = idx;
+                break;
+            }
+            default:
+                indices[i] = data[i];
+                break;
+            }
+        }
+        return indices;
+    }
+
+    void writeIndices(std::vector<uint8_t> &data, GLenum type, const std::vector<uint32_t> &indices)
+    {
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            switch (type)
+            {
+            case GL_UNSIGNED_INT:
+                std::memcpy(data.data() + i * 4, &indices[i], 4);
+                break;
+            case GL_UNSIGNED_SHORT:
+            {
+                uint16_t idx = (uint16_t)indices[i];
+                std::memcpy(data.data() + i * 2, &idx, 2);
+                break;
+            }
+            default:
+                data[i] = (uint8_t)indices[i];
+                break;
+            }
+        }
+    }
+
+    size_t getNumVertices(const std::vector<uint32_t> &indices)
+    {
+        return indices.empty() ? 0 : (size_t)(*std::max_element(indices.begin(), indices.end())) + 1;
+    }
+
+    /* number of vertices transformed for the triangle list, with a FIFO vertex cache of cacheSize.
+    misses (optional) receives the number of cache misses per triangle */
+    size_t simulateVertexCache(const std::vector<uint32_t> &indices, unsigned int cacheSize, std::vector<uint8_t> *misses = nullptr)
+    {
+        // a vertex is cached, if less than cacheSize vertices were inserted after it
+        std::vector<size_t> insertedAt(getNumVertices(indices), 0);
+        size_t numInserted = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            auto v = indices[i];
+            bool miss = (insertedAt[v] == 0) || (numInserted - insertedAt[v] >= cacheSize);
+            if (miss)
+            {
+                insertedAt[v] = ++numInserted;
+            }
+            if (misses)
+            {
+                if (i % 3 == 0)
+                {
+                    misses->push_back(0);
+                }
+                misses->back() += miss ? 1 : 0;
+            }
+        }
+        return numInserted;
+    }
+
+    /* reorders triangles for the post-transform vertex cache, see
+    Tom Forsyth: "Linear-Speed Vertex Cache Optimisation" (2006) */
+    std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t> &indices, unsigned int cacheSize)
+    {
+        const float cacheDecayPower = 1.5f;
+        const float lastTriScore = 0.75f;
+        const float valenceBoostScale = 2.0f;
+        const float valenceBoostPower = 0.5f;
+
+        const size_t numVerts = getNumVertices(indices);
+        const size_t numTris = indices.size() / 3;
+
+        // triangles of each vertex. the first numActive[v] of them are not yet emitted
+        std::vector<uint32_t> numActive(numVerts, 0);
+        for (size_t i = 0; i < numTris * 3; i++)
+        {
+            numActive[indices[i]]++;
+        }
+        std::vector<uint32_t> adjOffset(numVerts + 1, 0);
+        for (size_t v = 0; v < numVerts; v++)
+        {
+            adjOffset[v + 1] = adjOffset[v] + numActive[v];
+        }
+        std::vector<uint32_t> adj(numTris * 3);
+        std::vector<uint32_t> adjFill(adjOffset.begin(), adjOffset.end() - 1);
+        for (size_t i = 0; i < numTris * 3; i++)
+        {
+            adj[adjFill[indices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        std::vector<int> cachePos(numVerts, -1);
+        auto getVertexScore = [&](uint32_t v)
+        {
+            if (numActive[v] == 0)
+            {
+                return -1.0f;
+            }
+            float score = 0.0f;
+            int pos = cachePos[v];
+            if (pos >= 0 && pos < 3)
+            {
+                // the last triangle's vertices get a fixed score, to not favour one of them
+                score = lastTriScore;
+            }
+            else if (pos >= 3)
+            {
+                score = std::pow(1.0f - (float)(pos - 3) / (float)(cacheSize - 3), cacheDecayPower);
+            }
+            // favour vertices with few remaining triangles, to finish them off
+            return score + valenceBoostScale * std::pow((float)numActive[v], -valenceBoostPower);
+        };
+
+        std::vector<float> vertScore(numVerts);
+        for (size_t v = 0; v < numVerts; v++)
+        {
+            vertScore[v] = getVertexScore((uint32_t)v);
+        }
+
+        std::vector<float> triScore(numTris);
+        std::vector<char> emitted(numTris, 0);
+        int64_t bestTri = -1;
+        for (size_t t = 0; t < numTris; t++)
+        {
+            triScore[t] = vertScore[indices[t * 3]] + vertScore[indices[t * 3 + 1]] + vertScore[indices[t * 3 + 2]];
+            if (bestTri < 0 || triScore[t] > triScore[bestTri])
+            {
+                bestTri = (int64_t)t;
+            }
+        }
+
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> newCache;
+        std::vector<uint32_t> out;
+        out.reserve(numTris * 3);
+        size_t nextUnemitted = 0;
+
+        for (size_t n = 0; n < numTris; n++)
+        {
+            // no candidate in the cache: continue with the next triangle in the original order
+            if (bestTri < 0)
+            {
+                while (emitted[nextUnemitted])
+                {
+                    nextUnemitted++;
+                }
+                bestTri = (int64_t)nextUnemitted;
+            }
+
+            const uint32_t *tri = &indices[bestTri * 3];
+            emitted[bestTri] = 1;
+            out.insert(out.end(), tri, tri + 3);
+
+            // remove the triangle from the active triangles of its vertices
+            for (int c = 0; c < 3; c++)
+            {
+                auto v = tri[c];
+                uint32_t *vAdj = &adj[adjOffset[v]];
+                for (uint32_t a = 0; a < numActive[v]; a++)
+                {
+                    if (vAdj[a] == (uint32_t)bestTri)
+                    {
+                        std::swap(vAdj[a], vAdj[numActive[v] - 1]);
+                        numActive[v]--;
+                        break;
+                    }
+                }
+            }
+
+            // the triangle's vertices move to the front of the (LRU) cache
+            newCache.clear();
+            for (int c = 0; c < 3; c++)
+            {
+                if (std::find(newCache.begin(), newCache.end(), tri[c]) == newCache.end())
+                {
+                    newCache.push_back(tri[c]);
+                }
+            }
+            for (auto v : cache)
+            {
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                {
+                    newCache.push_back(v);
+                }
+            }
+            for (size_t i = 0; i < newCache.size(); i++)
+            {
+                cachePos[newCache[i]] = (i < cacheSize) ? (int)i : -1;
+            }
+            for (auto v : newCache)
+            {
+                vertScore[v] = getVertexScore(v);
+            }
+
+            // rescore the triangles touched, the best of them is next
+            bestTri = -1;
+            for (auto v : newCache)
+            {
+                for (uint32_t a = 0; a < numActive[v]; a++)
+                {
+                    auto t = adj[adjOffset[v] + a];
+                    triScore[t] = vertScore[indices[t * 3]] + vertScore[indices[t * 3 + 1]] + vertScore[indices[t * 3 + 2]];
+                    if (bestTri < 0 || triScore[t] > triScore[bestTri])
+                    {
+                        bestTri = t;
+                    }
+                }
+            }
+
+            if (newCache.size() > cacheSize)
+            {
+                newCache.resize(cacheSize);
+            }
+            cache.swap(newCache);
+        }
+
+        return out;
+    }
+
+    /* sorts clusters of triangles, outward-facing first, so that they tend to occlude the inner ones.
+    clusters start where the vertex cache is restarted (all vertices of a triangle missed),
+    so the vertex cache efficiency is mostly retained */
+    void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, unsigned int cacheSize)
+    {
+        const size_t numTris = indices.size() / 3;
+        if (numTris == 0 || positions.size() < getNumVertices(indices))
+        {
+            return;
+        }
+
+        std::vector<uint8_t> misses;
+        simulateVertexCache(indices, cacheSize, &misses);
+
+        std::vector<size_t> clusterStart;
+        for (size_t t = 0; t < numTris; t++)
+        {
+            if (t == 0 || misses[t] == 3)
+            {
+                clusterStart.push_back(t);
+            }
+        }
+        clusterStart.push_back(numTris);
+
+        glm::vec3 meshCenter(0.0f);
+        for (size_t i = 0; i < numTris * 3; i++)
+        {
+            meshCenter += positions[indices[i]];
+        }
+        meshCenter /= (float)(numTris * 3);
+
+        std::vector<std::pair<float, size_t>> clusterScores;
+        for (size_t c = 0; c + 1 < clusterStart.size(); c++)
+        {
+            glm::vec3 centroid(0.0f);
+            glm::vec3 normal(0.0f);
+            float area = 0.0f;
+            for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++)
+            {
+                const auto &p0 = positions[indices[t * 3]];
+                const auto &p1 = positions[indices[t * 3 + 1]];
+                const auto &p2 = positions[indices[t * 3 + 2]];
+                glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // length: 2 * area
+                float a = glm::length(n);
+                centroid += (p0 + p1 + p2) * (a / 3.0f);
+                normal += n;
+                area += a;
+            }
+            centroid = (area > 0.0f) ? centroid / area : positions[indices[clusterStart[c] * 3]];
+            float normalLength = glm::length(normal);
+            float score = (normalLength > 0.0f) ? glm::dot(centroid - meshCenter, normal / normalLength) : 0.0f;
+            clusterScores.push_back(std::make_pair(-score, c));
+        }
+        std::stable_sort(clusterScores.begin(), clusterScores.end(),
+                         [](const std::pair<float, size_t> &l, const std::pair<float, size_t> &r)
+                         { return l.first < r.first; });
+
+        std::vector<uint32_t> out;
+        out.reserve(indices.size());
+        for (const auto &cs : clusterScores)
+        {
+            out.insert(out.end(), indices.begin() + clusterStart[cs.second] * 3, indices.begin() + clusterStart[cs.second + 1] * 3);
+        }
+        out.insert(out.end(), indices.begin() + numTris * 3, indices.end());
+        indices.swap(out);
+    }
+
+    /* float positions of the vertices of shape. returns false if there are none */
+    bool readPositions(const yourgame::gl::MeshData &mesh,
+                       const yourgame::gl::MeshData::ShapeData &shape,
+                       std::vector<glm::vec3> &positions)
+    {
+        for (const auto &attr : shape.attribs)
+        {
+            if (attr.descr.index != yourgame::gl::attrLocPosition || attr.descr.type != GL_FLOAT ||
+                attr.descr.size < 3 || attr.buffer >= mesh.buffers.size())
+            {
+                continue;
+            }
+            const auto &data = mesh.buffers[attr.buffer].data;
+            size_t stride = attr.descr.stride ? attr.descr.stride : 3 * sizeof(float);
+            positions.clear();
+            for (size_t o = (size_t)attr.descr.pointer; o + 3 * sizeof(float) <= data.size(); o += stride)
+            {
+                glm::vec3 p;
+                std::memcpy(&p[0], data.data() + o, 3 * sizeof(float));
+                positions.push_back(p);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /* squared distance to a set of planes, as symmetric matrix, see
+    Garland, Heckbert: "Surface Simplification Using Quadric Error Metrics" (1997).
+    w is the sum of the plane weights, see eval() */
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double w = 0.0;
+
+        void addPlane(const glm::dvec3 &n, double d, double weight)
+        {
+            a00 += weight * n.x * n.x;
+            a01 += weight * n.x * n.y;
+            a02 += weight * n.x * n.z;
+            a11 += weight * n.y * n.y;
+            a12 += weight * n.y * n.z;
+            a22 += weight * n.z * n.z;
+            b0 += weight * n.x * d;
+            b1 += weight * n.y * d;
+            b2 += weight * n.z * d;
+            c += weight * d * d;
+            w += weight;
+        }
+
+        void add(const Quadric &q)
+        {
+            a00 += q.a00;
+            a01 += q.a01;
+            a02 += q.a02;
+            a11 += q.a11;
+            a12 += q.a12;
+            a22 += q.a22;
+            b0 += q.b0;
+            b1 += q.b1;
+            b2 += q.b2;
+            c += q.c;
+            w += q.w;
+        }
+
+        /* weighted mean of the squared distances of p to the planes. normalizing by the
+        weights (areas) keeps it a squared distance, scaling with the mesh */
+        double eval(const glm::vec3 &p) const
+        {
+            if (w <= 0.0)
+            {
+                return 0.0;
+            }
+            double x = p.x, y = p.y, z = p.z;
+            double r = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return std::max(r, 0.0) / w;
+        }
+    };
+
+    struct PositionKey
+    {
+        uint32_t bits[3];
+        bool operator==(const PositionKey &other) const
+        {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey &key) const
+        {
+            return (size_t)(key.bits[0] * 73856093U ^ key.bits[1] * 19349663U ^ key.bits[2] * 83492791U);
+        }
+    };
+
+    /* simplifies a triangle list towards targetNumIndices by collapsing edges, moving a vertex onto
+    its neighbor (no new vertices). vertices of the same position are welded, vertices at attribute
+    seams (a position with multiple vertices) and at borders are kept. error receives the
+    largest error (distance) of the collapses */
+    std::vector<uint32_t> simplify(const std::vector<uint32_t> &indices,
+                                   const std::vector<glm::vec3> &positions,
+                                   size_t targetNumIndices,
+                                   float maxError,
+                                   float &error)
+    {
+        error = 0.0f;
+        const size_t numVerts = positions.size();
+
+        // weld vertices of the same position
+        std::vector<uint32_t> weld(numVerts);
+        {
+            std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstOfPosition;
+            firstOfPosition.reserve(numVerts);
+            for (size_t v = 0; v < numVerts; v++)
+            {
+                PositionKey key;
+                std::memcpy(key.bits, &positions[v][0], sizeof(key.bits));
+                weld[v] = firstOfPosition.emplace(key, (uint32_t)v).first->second;
+            }
+        }
+
+        // lock positions of attribute seams, ...
+        std::vector<uint8_t> locked(numVerts, 0);
+        {
+            std::vector<uint8_t> used(numVerts, 0);
+            std::vector<uint32_t> numUsedAtPosition(numVerts, 0);
+            for (auto v : indices)
+            {
+                if (!used[v])
+                {
+                    used[v] = 1;
+                    if (++numUsedAtPosition[weld[v]] > 1)
+                    {
+                        locked[weld[v]] = 1;
+                    }
+                }
+            }
+        }
+
+        // ... and of border (and non-manifold) edges
+        {
+            std::unordered_map<uint64_t, uint32_t> edgeCount;
+            edgeCount.reserve(indices.size());
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                for (int e = 0; e < 3; e++)
+                {
+                    uint64_t a = weld[indices[i + e]];
+                    uint64_t b = weld[indices[i + (e + 1) % 3]];
+                    edgeCount[(std::min(a, b) << 32) | std::max(a, b)]++;
+                }
+            }
+            for (const auto &ec : edgeCount)
+            {
+                if (ec.second != 2)
+                {
+                    locked[ec.first >> 32] = 1;
+                    locked[ec.first & 0xFFFFFFFFULL] = 1;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(numVerts);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            uint32_t c[3] = {weld[indices[i]], weld[indices[i + 1]], weld[indices[i + 2]]};
+            glm::dvec3 p0 = positions[c[0]];
+            glm::dvec3 n = glm::cross(glm::dvec3(positions[c[1]]) - p0, glm::dvec3(positions[c[2]]) - p0);
+            double area2 = glm::length(n);
+            if (area2 > 0.0)
+            {
+                n /= area2;
+                Quadric q;
+                q.addPlane(n, -glm::dot(n, p0), 0.5 * area2);
+                for (int k = 0; k < 3; k++)
+                {
+                    quadrics[c[k]].add(q);
+                }
+            }
+        }
+
+        struct Collapse
+        {
+            double cost;
+            uint32_t from; // vertex (not welded)
+            uint32_t to;   // vertex (not welded)
+        };
+
+        std::vector<uint32_t> current = indices;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> remap(numVerts);
+        std::vector<uint8_t> touched(numVerts);
+        std::vector<uint32_t> triOffset(numVerts + 1);
+        std::vector<uint32_t> triOfPosition;
+        const double maxCost = (double)maxError * (double)maxError;
+
+        while (current.size() > targetNumIndices)
+        {
+            // candidates: both directions of each edge, from unlocked positions
+            collapses.clear();
+            for (size_t i = 0; i + 2 < current.size(); i += 3)
+            {
+                for (int e = 0; e < 3; e++)
+                {
+                    uint32_t a = current[i + e];
+                    uint32_t b = current[i + (e + 1) % 3];
+                    for (int dir = 0; dir < 2; dir++)
+                    {
+                        uint32_t from = dir ? b : a;
+                        uint32_t to = dir ? a : b;
+                        uint32_t wFrom = weld[from];
+                        uint32_t wTo = weld[to];
+                        if (wFrom != wTo && !locked[wFrom])
+                        {
+                            Quadric q = quadrics[wFrom];
+                            q.add(quadrics[wTo]);
+                            double cost = q.eval(positions[wTo]);
+                            if (cost <= maxCost)
+                            {
+                                collapses.push_back({cost, from, to});
+                            }
+                        }
+                    }
+                }
+            }
+            if (collapses.empty())
+            {
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end(),
+                      [](const Collapse &l, const Collapse &r)
+                      { return l.cost < r.cost; });
+
+            // triangles of each (welded) position
+            std::fill(triOffset.begin(), triOffset.end(), 0);
+            for (auto v : current)
+            {
+                triOffset[weld[v] + 1]++;
+            }
+            for (size_t v = 0; v < numVerts; v++)
+            {
+                triOffset[v + 1] += triOffset[v];
+            }
+            triOfPosition.resize(current.size());
+            {
+                std::vector<uint32_t> fill(triOffset.begin(), triOffset.end() - 1);
+                for (size_t i = 0; i < current.size(); i++)
+                {
+                    triOfPosition[fill[weld[current[i]]]++] = (uint32_t)(i / 3);
+                }
+            }
+
+            // collapse independent edges, cheapest first. each collapse removes about 2 triangles
+            for (size_t v = 0; v < numVerts; v++)
+            {
+                remap[v] = (uint32_t)v;
+            }
+            std::fill(touched.begin(), touched.end(), 0);
+            size_t numCollapsesNeeded = (current.size() - targetNumIndices) / 6 + 1;
+            size_t numCollapsed = 0;
+
+            for (const auto &col : collapses)
+            {
+                if (numCollapsed >= numCollapsesNeeded)
+                {
+                    break;
+                }
+                uint32_t wFrom = weld[col.from];
+                uint32_t wTo = weld[col.to];
+                if (touched[wFrom] || touched[wTo])
+                {
+                    continue;
+                }
+
+                // reject collapses that flip triangles around from
+                bool flips = false;
+                const glm::vec3 &pTo = positions[wTo];
+                for (uint32_t t = triOffset[wFrom]; t < triOffset[wFrom + 1] && !flips; t++)
+                {
+                    const uint32_t *tri = &current[triOfPosition[t] * 3];
+                    glm::vec3 p[3];
+                    bool hasTo = false;
+                    for (int k = 0; k < 3; k++)
+                    {
+                        p[k] = positions[weld[tri[k]]];
+                        hasTo = hasTo || (weld[tri[k]] == wTo);
+                    }
+                    if (hasTo)
+                    {
+                        continue; // degenerates, and is removed
+                    }
+                    glm::vec3 nBefore = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (weld[tri[k]] == wFrom)
+                        {
+                            p[k] = pTo;
+                        }
+                    }
+                    glm::vec3 nAfter = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    flips = glm::dot(nBefore, nAfter) <= 0.0f;
+                }
+                if (flips)
+                {
+                    continue;
+                }
+
+                // the neighborhood of from changes: no further collapses there in this pass
+                for (uint32_t t = triOffset[wFrom]; t < triOffset[wFrom + 1]; t++)
+                {
+                    const uint32_t *tri = &current[triOfPosition[t] * 3];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        touched[weld[tri[k]]] = 1;
+                    }
+                }
+                touched[wTo] = 1;
+
+                remap[col.from] = col.to;
+                quadrics[wTo].add(quadrics[wFrom]);
+                error = std::max(error, (float)std::sqrt(col.cost));
+                numCollapsed++;
+            }
+
+            if (numCollapsed == 0)
+            {
+                break;
+            }
+
+            // apply, and remove degenerate triangles
+            size_t write = 0;
+            for (size_t i = 0; i + 2 < current.size(); i += 3)
+            {
+                uint32_t t0 = remap[current[i]];
+                uint32_t t1 = remap[current[i + 1]];
+                uint32_t t2 = remap[current[i + 2]];
+                if (weld[t0] != weld[t1] && weld[t1] != weld[t2] && weld[t2] != weld[t0])
+                {
+                    current[write++] = t0;
+                    current[write++] = t1;
+                    current[write++] = t2;
+                }
+            }
+            current.resize(write);
+        }
+
+        return current;
+    }
+} // namespace
+
+namespace yourgame
+{
+    namespace gl
+    {
+        int MeshData::findBuffer(const std::string &name) const
+        {
+            for (size_t i = 0; i < buffers.size(); i++)
+            {
+                if (buffers[i].name == name)
+                {
+                    return (int)i;
+                }
+            }
+            return -1;
+        }
+
+        size_t MeshData::quantize(const MeshQuantization &cfg)
+        {
+            size_t bytesSaved = 0;
+
+            auto isFloatAttrib = [](const Shape::ArrBufferDescr &descr, GLuint location)
+            {
+                return descr.index == location && descr.type == GL_FLOAT && !descr.normalized;
+            };
+
+            // positions are quantized to snorm16 within their bounds. the bounds
+            // are determined from the vertex data, that might have changed since loading
+            float posOffset[3] = {0.0f, 0.0f, 0.0f};
+            float posScale[3] = {1.0f, 1.0f, 1.0f};
+            bool quantizePositions = false;
+            bool positionsQuantized = false;
+            if (cfg.positions == MeshQuantization::Positions::SNORM16)
+            {
+                float posMin[3] = {std::numeric_limits<float>::max(),
+                                   std::numeric_limits<float>::max(),
+                                   std::numeric_limits<float>::max()};
+                float posMax[3] = {std::numeric_limits<float>::lowest(),
+                                   std::numeric_limits<float>::lowest(),
+                                   std::numeric_limits<float>::lowest()};
+                for (const auto &shape : shapes)
+                {
+                    for (const auto &attr : shape.attribs)
+                    {
+                        if (!isFloatAttrib(attr.descr, attrLocPosition) || attr.buffer >= buffers.size())
+                        {
+                            continue;
+                        }
+                        const auto &data = buffers[attr.buffer].data;
+                        size_t attrSize = getAttribSize(attr.descr.type, attr.descr.size);
+                        size_t stride = attr.descr.stride ? attr.descr.stride : attrSize;
+                        for (size_t o = (size_t)attr.descr.pointer; o + attrSize <= data.size(); o += stride)
+                        {
+                            const float *p = reinterpret_cast<const float *>(data.data() + o);
+                            for (int c = 0; c < std::min(attr.descr.size, 3); c++)
+                            {
+                                posMin[c] = std::min(posMin[c], p[c]);
+                                posMax[c] = std::max(posMax[c], p[c]);
+                                quantizePositions = true;
+                            }
+                        }
+                    }
+                }
+                for (int c = 0; quantizePositions && c < 3; c++)
+                {
+                    if (posMin[c] > posMax[c]) // less than 3 components
+                    {
+                        posMin[c] = posMax[c] = 0.0f;
+                    }
+                    posOffset[c] = 0.5f * (posMin[c] + posMax[c]);
+                    posScale[c] = std::max(0.5f * (posMax[c] - posMin[c]), 1.0e-20f);
+                }
+            }
+
+            for (size_t b = 0; b < buffers.size(); b++)
+            {
+                auto &buf = buffers[b];
+                if (buf.target != GL_ARRAY_BUFFER)
+                {
+                    continue;
+                }
+
+                // the distinct attributes of this buffer, referenced by the shapes
+                std::vector<VertexField> fields;
+                std::vector<std::pair<AttribData *, size_t>> refs;
+                for (auto &shape : shapes)
+                {
+                    for (auto &attr : shape.attribs)
+                    {
+                        if (attr.buffer != b)
+                        {
+                            continue;
+                        }
+                        size_t f = 0;
+                        for (; f < fields.size(); f++)
+                        {
+                            if (fields[f].oldDescr.index == attr.descr.index &&
+                                fields[f].oldDescr.pointer == attr.descr.pointer)
+                            {
+                                break;
+                            }
+                        }
+                        if (f == fields.size())
+                        {
+                            fields.push_back({attr.descr,
+                                              getAttribSize(attr.descr.type, attr.descr.size),
+                                              attr.descr.type,
+                                              attr.descr.normalized,
+                                              0,
+                                              0});
+                        }
+                        refs.push_back(std::make_pair(&attr, f));
+                    }
+                }
+
+                if (fields.empty())
+                {
+                    continue;
+                }
+
+                // all fields need the same stride (0: tightly packed, single attribute)
+                size_t oldStride = fields[0].oldDescr.stride;
+                if (oldStride == 0 && fields.size() == 1)
+                {
+                    oldStride = fields[0].oldSize;
+                }
+                bool layoutValid = oldStride > 0;
+                for (const auto &field : fields)
+                {
+                    layoutValid = layoutValid && field.oldSize > 0 &&
+                                  (field.oldDescr.stride == 0 ? fields.size() == 1 : (size_t)field.oldDescr.stride == oldStride) &&
+                                  (size_t)field.oldDescr.pointer + field.oldSize <= oldStride;
+                }
+                if (!layoutValid || buf.data.size() % oldStride != 0)
+                {
+                    continue;
+                }
+                size_t numVerts = buf.data.size() / oldStride;
+
+                bool changed = false;
+                for (auto &field : fields)
+                {
+                    const auto &descr = field.oldDescr;
+                    if (cfg.positions == MeshQuantization::Positions::HALF_FLOAT && isFloatAttrib(descr, attrLocPosition))
+                    {
+                        field.newType = GL_HALF_FLOAT;
+                    }
+                    else if (quantizePositions && isFloatAttrib(descr, attrLocPosition))
+                    {
+                        field.newType = GL_SHORT;
+                        field.newNormalized = GL_TRUE;
+                        positionsQuantized = true;
+                    }
+                    else if (cfg.normals && isFloatAttrib(descr, attrLocNormal) && descr.size == 3)
+                    {
+                        field.newType = GL_INT_2_10_10_10_REV;
+                        field.newNormalized = GL_TRUE;
+                    }
+                    else if (cfg.colors && isFloatAttrib(descr, attrLocColor))
+                    {
+                        field.newType = GL_UNSIGNED_BYTE;
+                        field.newNormalized = GL_TRUE;
+                    }
+                    else if (cfg.texcoords && isFloatAttrib(descr, attrLocTexcoords))
+                    {
+                        field.newType = GL_HALF_FLOAT;
+                    }
+                    changed = changed || (field.newType != descr.type);
+                    field.newSize = alignAttribSize(getAttribSize(field.newType, descr.size));
+                }
+
+                if (!changed)
+                {
+                    continue;
+                }
+
+                // new interleaved layout, in the order of the old offsets
+                std::vector<size_t> order(fields.size());
+                for (size_t f = 0; f < order.size(); f++)
+                {
+                    order[f] = f;
+                }
+                std::sort(order.begin(), order.end(), [&fields](size_t l, size_t r)
+                          { return fields[l].oldDescr.pointer < fields[r].oldDescr.pointer; });
+                size_t newStride = 0;
+                for (auto f : order)
+                {
+                    fields[f].newOffset = newStride;
+                    newStride += fields[f].newSize;
+                }
+
+                std::vector<uint8_t> newData(numVerts * newStride, 0);
+                for (size_t v = 0; v < numVerts; v++)
+                {
+                    const uint8_t *src = buf.data.data() + v * oldStride;
+                    uint8_t *dst = newData.data() + v * newStride;
+                    for (const auto &field : fields)
+                    {
+                        const uint8_t *srcField = src + (size_t)field.oldDescr.pointer;
+                        uint8_t *dstField = dst + field.newOffset;
+                        const float *f = reinterpret_cast<const float *>(srcField);
+                        GLint numComponents = field.oldDescr.size;
+
+                        if (field.newType == field.oldDescr.type)
+                        {
+                            std::memcpy(dstField, srcField, field.oldSize);
+                        }
+                        else if (field.newType == GL_HALF_FLOAT)
+                        {
+                            for (GLint c = 0; c < numComponents; c++)
+                            {
+                                uint16_t h = glm::packHalf1x16(f[c]);
+                                std::memcpy(dstField + 2 * c, &h, 2);
+                            }
+                        }
+                        else if (field.newType == GL_SHORT)
+                        {
+                            for (GLint c = 0; c < numComponents; c++)
+                            {
+                                float q = (c < 3) ? (f[c] - posOffset[c]) / posScale[c] : f[c];
+                                uint16_t s = glm::packSnorm1x16(q);
+                                std::memcpy(dstField + 2 * c, &s, 2);
+                            }
+                        }
+                        else if (field.newType == GL_INT_2_10_10_10_REV)
+                        {
+                            uint32_t n = glm::packSnorm3x10_1x2(glm::vec4(f[0], f[1], f[2], 0.0f));
+                            std::memcpy(dstField, &n, 4);
+                        }
+                        else if (field.newType == GL_UNSIGNED_BYTE)
+                        {
+                            for (GLint c = 0; c < numComponents; c++)
+                            {
+                                dstField[c] = glm::packUnorm1x8(f[c]);
+                            }
+                        }
+                    }
+                }
+
+                bytesSaved += buf.data.size() - newData.size();
+                buf.data.swap(newData);
+
+                for (auto &ref : refs)
+                {
+                    const auto &field = fields[ref.second];
+                    ref.first->descr.type = field.newType;
+                    ref.first->descr.normalized = field.newNormalized;
+                    ref.first->descr.stride = (GLsizei)newStride;
+                    ref.first->descr.pointer = (const GLvoid *)field.newOffset;
+                }
+            }
+
+            // only if positions got converted, those of skipped buffers stay float
+            if (positionsQuantized)
+            {
+                std::copy(posOffset, posOffset + 3, positionOffset);
+                std::copy(posScale, posScale + 3, positionScale);
+            }
+
+            // 16 bit indices, if all indices of the buffer fit (0xFFFF is left
+            // out, as it is the primitive restart index)
+            if (cfg.indices)
+            {
+                for (size_t b = 0; b < buffers.size(); b++)
+                {
+                    auto &buf = buffers[b];
+                    if (buf.target != GL_ELEMENT_ARRAY_BUFFER || buf.data.size() % sizeof(GLuint) != 0)
+                    {
+                        continue;
+                    }
+
+                    bool convertible = false;
+                    for (const auto &shape : shapes)
+                    {
+                        if (shape.indexBuffer == b)
+                        {
+                            convertible = (shape.elArDescr.type == GL_UNSIGNED_INT);
+                            if (!convertible)
+                            {
+                                break;
+                            }
+                        }
+                    }
+
+                    size_t numIdx = buf.data.size() / sizeof(GLuint);
+                    std::vector<uint8_t> newData(numIdx * sizeof(GLushort));
+                    for (size_t i = 0; convertible && i < numIdx; i++)
+                    {
+                        GLuint idx;
+                        std::memcpy(&idx, buf.data.data() + i * sizeof(GLuint), sizeof(GLuint));
+                        convertible = idx < 0xFFFFU;
+                        GLushort idx16 = (GLushort)idx;
+                        std::memcpy(newData.data() + i * sizeof(GLushort), &idx16, sizeof(GLushort));
+                    }
+
+                    if (convertible)
+                    {
+                        bytesSaved += buf.data.size() - newData.size();
+                        buf.data.swap(newData);
+                        for (auto &shape : shapes)
+                        {
+                            if (shape.indexBuffer == b)
+                            {
+                                shape.elArDescr.type = GL_UNSIGNED_SHORT;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return bytesSaved;
+        }
+
+        MeshOptimizationStats MeshData::optimize(const MeshOptimization &cfg)
+        {
+            MeshOptimizationStats stats;
+            const unsigned int cacheSize = std::max(cfg.cacheSize, 4U);
+            size_t missesBefore = 0;
+            size_t missesAfter = 0;
+
+            for (size_t s = 0; s < shapes.size(); s++)
+            {
+                const auto &shape = shapes[s];
+                size_t idxSize = getIndexSize(shape.elArDescr.type);
+                if (shape.elArDescr.drawMode != GL_TRIANGLES || idxSize == 0 || shape.indexBuffer >= buffers.size())
+                {
+                    continue;
+                }
+
+                // the index buffer must only be used by (all of) this shape
+                auto &idxBuf = buffers[shape.indexBuffer];
+                bool exclusive = (size_t)shape.elArDescr.numElements * idxSize == idxBuf.data.size() &&
+                                 shape.elArDescr.numElements % 3 == 0;
+                for (size_t other = 0; other < shapes.size(); other++)
+                {
+                    exclusive = exclusive && (other == s || shapes[other].indexBuffer != shape.indexBuffer);
+                }
+                if (!exclusive || idxBuf.data.empty())
+                {
+                    continue;
+                }
+
+                std::vector<uint32_t> indices = readIndices(idxBuf.data, shape.elArDescr.type);
+                stats.numTriangles += indices.size() / 3;
+                missesBefore += simulateVertexCache(indices, cacheSize);
+
+                if (cfg.vertexCache)
+                {
+                    indices = optimizeVertexCache(indices, cacheSize);
+
+                    // overdraw sorting needs float positions
+                    std::vector<glm::vec3> positions;
+                    if (cfg.overdraw && readPositions(*this, shape, positions))
+                    {
+                        optimizeOverdraw(indices, positions, cacheSize);
+                    }
+                }
+
+                missesAfter += simulateVertexCache(indices, cacheSize);
+                writeIndices(idxBuf.data, shape.elArDescr.type, indices);
+            }
+
+            if (stats.numTriangles > 0)
+            {
+                stats.acmrBefore = (float)missesBefore / (float)stats.numTriangles;
+                stats.acmrAfter = (float)missesAfter / (float)stats.numTriangles;
+            }
+
+            if (cfg.vertexFetch)
+            {
+                reorderVertices();
+            }
+
+            return stats;
+        }
+
+        void MeshData::generateLods(const MeshLodConfig &cfg, unsigned int vertexCacheSize)
+        {
+            const size_t maxLods = 7;
+            const size_t numLods = std::min((size_t)cfg.numLods, maxLods);
+            lodErrors.assign(1, 0.0f);
+            if (numLods == 0 || !(cfg.ratio > 0.0f && cfg.ratio < 1.0f))
+            {
+                return;
+            }
+
+            glm::vec3 extent = glm::make_vec3(boundsMax) - glm::make_vec3(boundsMin);
+            const float maxError = cfg.maxError * 0.5f * glm::length(extent);
+
+            for (size_t s = 0; s < shapes.size(); s++)
+            {
+                auto &shape = shapes[s];
+                size_t idxSize = getIndexSize(shape.elArDescr.type);
+                if (shape.elArDescr.drawMode != GL_TRIANGLES || idxSize == 0 ||
+                    shape.indexBuffer >= buffers.size() || !shape.lods.empty())
+                {
+                    continue;
+                }
+
+                // the levels are appended to the index buffer: it must only be used by this shape
+                auto &idxBuf = buffers[shape.indexBuffer];
+                bool exclusive = (size_t)shape.elArDescr.numElements * idxSize == idxBuf.data.size() &&
+                                 shape.elArDescr.numElements % 3 == 0;
+                for (size_t other = 0; other < shapes.size(); other++)
+                {
+                    exclusive = exclusive && (other == s || shapes[other].indexBuffer != shape.indexBuffer);
+                }
+                std::vector<glm::vec3> positions;
+                if (!exclusive || idxBuf.data.empty() || !readPositions(*this, shape, positions))
+                {
+                    continue;
+                }
+
+                std::vector<uint32_t> indices = readIndices(idxBuf.data, shape.elArDescr.type);
+                bool valid = true;
+                for (auto idx : indices)
+                {
+                    valid = valid && idx < positions.size();
+                }
+                if (!valid)
+                {
+                    continue;
+                }
+
+                // each level is simplified from level 0, so its error is relative to the original surface
+                std::vector<uint32_t> all = indices;
+                size_t prevNumIndices = indices.size();
+                float prevError = 0.0f;
+                for (size_t l = 1; l <= numLods; l++)
+                {
+                    size_t target = (size_t)((float)(prevNumIndices / 3) * cfg.ratio) * 3;
+                    float error = 0.0f;
+                    std::vector<uint32_t> lod = simplify(indices, positions, target, maxError, error);
+                    if (lod.empty() || lod.size() * 20 > prevNumIndices * 19) // less than 5% reduction
+                    {
+                        break;
+                    }
+                    if (vertexCacheSize > 0)
+                    {
+                        lod = optimizeVertexCache(lod, vertexCacheSize);
+                    }
+
+                    shape.lods.push_back({(GLsizei)all.size(), (GLsizei)lod.size()});
+                    all.insert(all.end(), lod.begin(), lod.end());
+                    prevNumIndices = lod.size();
+                    prevError = std::max(prevError, error);
+                    if (lodErrors.size() <= l)
+                    {
+                        lodErrors.push_back(prevError);
+                    }
+                    else
+                    {
+                        lodErrors[l] = std::max(lodErrors[l], prevError);
+                    }
+                }
+
+                if (!shape.lods.empty())
+                {
+                    idxBuf.data.resize(all.size() * idxSize);
+                    writeIndices(idxBuf.data, shape.elArDescr.type, all);
+                }
+            }
+
+            // a level missing in some shape draws that shape at its coarsest level
+            for (size_t l = 1; l < lodErrors.size(); l++)
+            {
+                lodErrors[l] = std::max(lodErrors[l], lodErrors[l - 1]);
+            }
+        }
+
+        void MeshData::process(const MeshProcessing &cfg)
+        {
+            const auto &opt = cfg.optimization;
+            if (opt.vertexCache || opt.vertexFetch || opt.overdraw)
+            {
+                auto stats = optimize(opt);
+                if (stats.numTriangles > 0)
+                {
+                    yourgame::log::info("mesh optimized: %v triangles, ACMR %v -> %v (cache size %v)",
+                                        stats.numTriangles, stats.acmrBefore, stats.acmrAfter, opt.cacheSize);
+                }
+            }
+            if (cfg.lods.numLods > 0)
+            {
+                generateLods(cfg.lods, opt.vertexCache ? std::max(opt.cacheSize, 4U) : 0U);
+            }
+            quantize(cfg.quantization);
+        }
+
+        bool MeshData::reorderVertices()
+        {
+            // all vertex buffers (referenced by the shapes) must hold the same number of vertices,
+            // as they are reordered together
+            std::vector<size_t> strides(buffers.size(), 0);
+            size_t numVerts = 0;
+            bool first = true;
+            for (const auto &shape : shapes)
+            {
+                if (shape.indexBuffer >= buffers.size() || getIndexSize(shape.elArDescr.type) == 0)
+                {
+                    return false;
+                }
+                for (const auto &attr : shape.attribs)
+                {
+                    if (attr.buffer >= buffers.size() || attr.descr.attribDivisor != 0)
+                    {
+                        return false;
+                    }
+                    size_t stride = attr.descr.stride ? attr.descr.stride : getAttribSize(attr.descr.type, attr.descr.size);
+                    if (stride == 0 || (strides[attr.buffer] != 0 && strides[attr.buffer] != stride))
+                    {
+                        return false;
+                    }
+                    strides[attr.buffer] = stride;
+                    size_t n = buffers[attr.buffer].data.size() / stride;
+                    if (!first && n != numVerts)
+                    {
+                        return false;
+                    }
+                    numVerts = n;
+                    first = false;
+                }
+            }
+
+            // new vertex order: order of first use in the index buffers
+            const uint32_t unused = std::numeric_limits<uint32_t>::max();
+            std::vector<uint32_t> remap(numVerts, unused);
+            uint32_t numRemapped = 0;
+            std::vector<bool> remapped(buffers.size(), false);
+            std::vector<GLenum> indexTypes(buffers.size(), GL_UNSIGNED_INT);
+            std::vector<std::vector<uint32_t>> indexLists(buffers.size());
+            for (const auto &shape : shapes)
+            {
+                if (remapped[shape.indexBuffer])
+                {
+                    continue;
+                }
+                remapped[shape.indexBuffer] = true;
+                indexTypes[shape.indexBuffer] = shape.elArDescr.type;
+                auto &indices = indexLists[shape.indexBuffer];
+                indices = readIndices(buffers[shape.indexBuffer].data, shape.elArDescr.type);
+                for (auto &idx : indices)
+                {
+                    if (idx >= numVerts)
+                    {
+                        return false;
+                    }
+                    if (remap[idx] == unused)
+                    {
+                        remap[idx] = numRemapped++;
+                    }
+                    idx = remap[idx];
+                }
+            }
+            for (auto &r : remap) // unused vertices are kept, at the end
+            {
+                if (r == unused)
+                {
+                    r = numRemapped++;
+                }
+            }
+
+            for (size_t b = 0; b < buffers.size(); b++)
+            {
+                if (remapped[b])
+                {
+                    writeIndices(buffers[b].data, indexTypes[b], indexLists[b]);
+                }
+            }
+            for (size_t b = 0; b < buffers.size(); b++)
+            {
+                if (strides[b] == 0)
+                {
+                    continue;
+                }
+                const auto &src = buffers[b].data;
+                std::vector<uint8_t> dst(src.size());
+                for (size_t v = 0; v < numVerts; v++)
+                {
+                    std::memcpy(dst.data() + remap[v] * strides[b], src.data() + v * strides[b], strides[b]);
+                }
+                std::copy(src.begin() + numVerts * strides[b], src.end(), dst.begin() + numVerts * strides[b]);
+                buffers[b].data.swap(dst);
+            }
+            return true;
+        }
+    } // namespace gl
+} // namespace yourgame
@@ -20,6 +20,7 @@ freely, subject to the following restrictions:
 #include <glm/glm.hpp>
 #include "yourgame/gl/particles.h"
 #include "yourgame/gl/conventions.h"
+#include "yourgame/log.h"
 
 namespace yourgame
 {
@@ -34,12 +35,11 @@ namespace yourgame
 
             Particles *newParts = new Particles(cfg, geo);
 
-            GLsizei vec4Size = static_cast<GLsizei>(sizeof(glm::vec4));
-            // todo: handle errors during addBuffer()
-            newParts->m_geo->addBuffer("instModelPos", GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-            newParts->m_geo->addBuffer("instProgress", GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-            newParts->m_geo->addBufferToShape("main", {{gl::attrLocInstModelMatCol3, 4, GL_FLOAT, GL_FALSE, vec4Size, (void *)0, 1}}, "instModelPos");
-            newParts->m_geo->addBufferToShape("main", {{gl::attrLocInstProgress, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (void *)0, 1}}, "instProgress");
+            // per-instance data is streamed, the attribute pointers are set in tick()
+            if (!newParts->m_geo->addStreamBuffer("instance", GL_ARRAY_BUFFER, 16 * 1024))
+            {
+                yourgame::log::error("Particles::make(): failed to add the instance stream buffer");
+            }
 
             return newParts;
         }
@@ -52,9 +52,36 @@ namespace yourgame
         void Particles::tick(float dt)
         {
             yourgame::math::Particles::tick(dt);
-            m_geo->bufferData("instModelPos", m_positionData.size() * sizeof(m_positionData[0]), m_positionData.data());
-            m_geo->bufferData("instProgress", m_progressData.size() * sizeof(m_progressData[0]), m_progressData.data());
+
+            GLsizeiptr positionSize = m_positionData.size() * sizeof(m_positionData[0]);
+            GLsizeiptr progressSize = m_progressData.size() * sizeof(m_progressData[0]);
+
+            // nothing is drawn, until the instance data is uploaded
+            m_numUploaded = 0;
+            StreamBuffer *stream = m_geo->getStreamBuffer("instance");
+            if (!stream)
+            {
+                return;
+            }
+            stream->nextFrame();
+            if (!stream->reserve(positionSize + progressSize + StreamBuffer::alignment))
+            {
+                yourgame::log::error("Particles::tick(): failed to reserve %v bytes of instance data", positionSize + progressSize);
+                return;
+            }
+            GLintptr positionOffset = stream->upload(m_positionData.data(), positionSize);
+            GLintptr progressOffset = stream->upload(m_progressData.data(), progressSize);
+            if (positionOffset < 0 || progressOffset < 0)
+            {
+                return;
+            }
+
+            GLsizei vec4Size = static_cast<GLsizei>(sizeof(glm::vec4));
+            m_geo->addBufferToShape("main", {{gl::attrLocInstModelMatCol3, 4, GL_FLOAT, GL_FALSE, vec4Size, (void *)positionOffset, 1}}, "instance");
+            m_geo->addBufferToShape("main", {{gl::attrLocInstProgress, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (void *)progressOffset, 1}}, "instance");
+            m_numUploaded = static_cast<GLsizei>(m_positionData.size());
         }
+
         yourgame::gl::Geometry *Particles::geo()
         {
             return m_geo;
@@ -62,7 +89,7 @@ namespace yourgame
 
         GLsizei Particles::numParticles()
         {
-            return m_positionData.size();
+            return m_numUploaded;
         }
     } // namespace gl
 } // namespace yourgame
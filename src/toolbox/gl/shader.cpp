@@ -17,9 +17,15 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <string>
 #include "yourgame/gl/shader.h"
 #include "yourgame/gl/conventions.h"
+#include "yourgame/file.h"
+#include "yourgame/log.h"
 
 namespace yourgame
 {
@@ -27,92 +33,302 @@ namespace yourgame
     {
         namespace
         {
-            int compileShader(GLenum type, const GLchar *source, GLuint *handle, std::string &errorLog)
+            /* program binary cache file: header, followed by binarySize bytes of program binary */
+            struct ProgramCacheHeader
             {
-                const GLchar *glsrc = source;
-                *handle = glCreateShader(type);
-                glShaderSource(*handle, 1, &glsrc, NULL);
-                glCompileShader(*handle);
+                uint32_t magic;
+                uint32_t version;
+                uint64_t key;
+                uint32_t binaryFormat;
+                uint32_t binarySize;
+            };
+            static_assert(sizeof(ProgramCacheHeader) == 24, "unexpected program cache header padding");
 
-                GLint status;
-                glGetShaderiv(*handle, GL_COMPILE_STATUS, &status);
-                if (status == GL_FALSE)
+            const uint32_t programCacheMagic = 0x50475921U; // "!YGP"
+            const uint32_t programCacheVersion = 1U;
+
+            std::string binaryCacheDir; // empty: cache disabled
+
+            /* FNV-1a, continued from h */
+            uint64_t hashBytes(uint64_t h, const void *data, size_t numBytes)
+            {
+                const uint8_t *p = static_cast<const uint8_t *>(data);
+                for (size_t i = 0; i < numBytes; ++i)
                 {
-                    GLchar infoLog[1024];
-                    glGetShaderInfoLog(*handle, 1024, NULL, infoLog);
-                    errorLog += infoLog;
-                    glDeleteShader(*handle);
-                    return -1;
+                    h = (h ^ p[i]) * 1099511628211ULL;
                 }
+                return h;
+            }
 
-                return 0;
+            uint64_t hashString(uint64_t h, const std::string &str)
+            {
+                uint64_t numBytes = str.size(); // length first, so that concatenations differ
+                h = hashBytes(h, &numBytes, sizeof(numBytes));
+                return hashBytes(h, str.data(), str.size());
             }
-        } // namespace
 
-        Shader *Shader::make(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
-                             const std::vector<std::pair<GLuint, std::string>> &attrLocs,
-                             const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
-                             std::string &errorLog)
-        {
-            std::vector<GLuint> shdrHandles;
+            uint64_t hashGlString(uint64_t h, GLenum name)
+            {
+                const GLubyte *str = glGetString(name);
+                return hashString(h, str ? std::string(reinterpret_cast<const char *>(str)) : std::string());
+            }
+
+            /* the cache is used if enabled and the gl implementation provides at least one binary format */
+            bool isBinaryCacheUsable()
+            {
+                if (binaryCacheDir.empty())
+                {
+                    return false;
+                }
+#ifdef YOURGAME_GL_INCLUDE_GLAD
+                if (!GLAD_GL_ARB_get_program_binary)
+                {
+                    return false;
+                }
+#endif
+                GLint numFormats = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+                return numFormats > 0;
+            }
 
-            for (const auto &shdrDes : shaderCodes)
+            /* key of a program: everything that affects the linked binary. a driver update changes
+            GL_VERSION (and therefore the key), stale files are not read anymore */
+            uint64_t programKey(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                                const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
             {
-                GLuint handle;
-                if (compileShader(shdrDes.first, shdrDes.second.c_str(), &handle, errorLog) != 0)
+                uint64_t h = 14695981039346656037ULL;
+                h = hashBytes(h, &programCacheVersion, sizeof(programCacheVersion));
+                h = hashGlString(h, GL_VENDOR);
+                h = hashGlString(h, GL_RENDERER);
+                h = hashGlString(h, GL_VERSION);
+                for (const auto &shdr : shaderCodes)
                 {
-                    for (const auto &shdrHandle : shdrHandles)
+                    uint32_t type = shdr.first;
+                    h = hashBytes(h, &type, sizeof(type));
+                    h = hashString(h, shdr.second);
+                }
+                const std::vector<std::pair<GLuint, std::string>> *locLists[] = {&attrLocs, &fragDataLocs};
+                for (const auto locs : locLists)
+                {
+                    uint64_t numLocs = locs->size();
+                    h = hashBytes(h, &numLocs, sizeof(numLocs));
+                    for (const auto &loc : *locs)
                     {
-                        glDeleteShader(shdrHandle);
+                        uint32_t index = loc.first;
+                        h = hashBytes(h, &index, sizeof(index));
+                        h = hashString(h, loc.second);
                     }
-                    return nullptr;
                 }
-                shdrHandles.push_back(handle);
+                return h;
             }
 
-            GLuint progHandle = glCreateProgram();
+            std::string programCacheFile(uint64_t key)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx.ygprog", static_cast<unsigned long long>(key));
+                return binaryCacheDir + name;
+            }
 
-            for (const auto &shdrHandle : shdrHandles)
+            /* returns a linked program from the cache file of key, 0 if there is no (valid) file,
+            or the driver rejects the binary */
+            GLuint loadProgramBinary(uint64_t key)
             {
-                glAttachShader(progHandle, shdrHandle);
+                yourgame::file::FileView view;
+                if (yourgame::file::mapFile(programCacheFile(key), view) != 0)
+                {
+                    return 0;
+                }
+
+                ProgramCacheHeader header;
+                if (view.size() < sizeof(header))
+                {
+                    return 0;
+                }
+                std::memcpy(&header, view.data(), sizeof(header));
+                if (header.magic != programCacheMagic ||
+                    header.version != programCacheVersion ||
+                    header.key != key ||
+                    header.binarySize != view.size() - sizeof(header))
+                {
+                    return 0;
+                }
+
+                GLuint progHandle = glCreateProgram();
+                glProgramBinary(progHandle, header.binaryFormat, view.data() + sizeof(header), (GLsizei)header.binarySize);
+                GLint linkStatus = GL_FALSE;
+                glGetProgramiv(progHandle, GL_LINK_STATUS, &linkStatus);
+                if (linkStatus == GL_FALSE)
+                {
+                    yourgame::log::info("Shader::make(): program binary rejected, recompiling");
+                    glDeleteProgram(progHandle);
+                    return 0;
+                }
+                return progHandle;
             }
 
-            for (const auto &attr : attrLocs)
+            /* writes the binary of the linked program progHandle to the cache file of key (write-behind) */
+            void saveProgramBinary(GLuint progHandle, uint64_t key)
             {
-                glBindAttribLocation(progHandle, attr.first, attr.second.c_str());
+                GLint binarySize = 0;
+                glGetProgramiv(progHandle, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+                if (binarySize <= 0)
+                {
+                    return;
+                }
+
+                std::vector<uint8_t> data(sizeof(ProgramCacheHeader) + (size_t)binarySize);
+                GLsizei length = 0;
+                GLenum binaryFormat = 0;
+                glGetProgramBinary(progHandle, binarySize, &length, &binaryFormat, data.data() + sizeof(ProgramCacheHeader));
+                if (length <= 0)
+                {
+                    return;
+                }
+                data.resize(sizeof(ProgramCacheHeader) + (size_t)length);
+
+                ProgramCacheHeader header;
+                header.magic = programCacheMagic;
+                header.version = programCacheVersion;
+                header.key = key;
+                header.binaryFormat = binaryFormat;
+                header.binarySize = (uint32_t)length;
+                std::memcpy(data.data(), &header, sizeof(header));
+
+                std::string filename = programCacheFile(key);
+                yourgame::file::writeFileAsync(filename, std::move(data), [filename](int ret)
+                                               {
+                                                   if (ret != 0)
+                                                   {
+                                                       yourgame::log::warn("Shader::make(): failed to write %v", filename);
+                                                   } });
             }
 
-#ifndef YOURGAME_GL_API_GLES
-            for (const auto &frag : fragDataLocs)
+            const GLenum completionStatusKhr = 0x91B1; // GL_COMPLETION_STATUS_KHR (and _ARB)
+
+            /* GL_KHR_parallel_shader_compile (or the ARB variant) is available. the number of
+            compiler threads is left at its default (implementation-defined maximum) */
+            bool hasParallelCompile()
             {
-                glBindFragDataLocation(progHandle, frag.first, frag.second.c_str());
+                static bool supported = false;
+                static bool queried = false;
+                if (!queried)
+                {
+                    GLint numExtensions = 0;
+                    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+                    for (GLint i = 0; i < numExtensions && !supported; ++i)
+                    {
+                        const GLubyte *ext = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+                        supported = ext &&
+                                    (std::strcmp(reinterpret_cast<const char *>(ext), "GL_KHR_parallel_shader_compile") == 0 ||
+                                     std::strcmp(reinterpret_cast<const char *>(ext), "GL_ARB_parallel_shader_compile") == 0);
+                    }
+                    queried = true;
+                }
+                return supported;
             }
+
+            /* starts compiling the shaders and linking the program, without querying any status
+            (which would wait for the driver), see finishProgram() */
+            GLuint submitProgram(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                                 const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                 const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
+                                 bool retrievable,
+                                 std::vector<GLuint> &shdrHandles)
+            {
+                for (const auto &shdrDes : shaderCodes)
+                {
+                    const GLchar *glsrc = shdrDes.second.c_str();
+                    GLuint handle = glCreateShader(shdrDes.first);
+                    glShaderSource(handle, 1, &glsrc, NULL);
+                    glCompileShader(handle);
+                    shdrHandles.push_back(handle);
+                }
+
+                GLuint progHandle = glCreateProgram();
+
+                for (const auto &shdrHandle : shdrHandles)
+                {
+                    glAttachShader(progHandle, shdrHandle);
+                }
+
+                for (const auto &attr : attrLocs)
+                {
+                    glBindAttribLocation(progHandle, attr.first, attr.second.c_str());
+                }
+
+#ifndef YOURGAME_GL_API_GLES
+                for (const auto &frag : fragDataLocs)
+                {
+                    glBindFragDataLocation(progHandle, frag.first, frag.second.c_str());
+                }
 #endif
 
-            glLinkProgram(progHandle);
+                if (retrievable)
+                {
+                    glProgramParameteri(progHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                }
 
-            GLint linkStatus;
-            glGetProgramiv(progHandle, GL_LINK_STATUS, &linkStatus);
-            if (linkStatus == GL_FALSE)
-            {
-                GLchar infoLog[1024];
-                glGetProgramInfoLog(progHandle, 1024, NULL, infoLog);
-                errorLog += infoLog;
+                glLinkProgram(progHandle);
+                return progHandle;
             }
 
-            for (const auto &shdrHandle : shdrHandles)
+            /* true if the driver finished compiling and linking the program (querying its status does
+            not block then). always true without parallel compile support */
+            bool isProgramComplete(GLuint progHandle)
             {
-                glDetachShader(progHandle, shdrHandle);
-                glDeleteShader(shdrHandle);
+                if (!hasParallelCompile())
+                {
+                    return true;
+                }
+                GLint complete = GL_FALSE;
+                glGetProgramiv(progHandle, completionStatusKhr, &complete);
+                return complete != GL_FALSE;
             }
 
-            if (linkStatus == GL_FALSE)
+            /* queries the compile and link status of a submitted program and releases its shaders.
+            returns false on failure (the program is deleted then), errors are appended to errorLog */
+            bool finishProgram(GLuint progHandle, const std::vector<GLuint> &shdrHandles, std::string &errorLog)
             {
-                glDeleteProgram(progHandle);
-                return nullptr;
+                bool compiled = true;
+                for (const auto &shdrHandle : shdrHandles)
+                {
+                    GLint status;
+                    glGetShaderiv(shdrHandle, GL_COMPILE_STATUS, &status);
+                    if (status == GL_FALSE)
+                    {
+                        GLchar infoLog[1024];
+                        glGetShaderInfoLog(shdrHandle, 1024, NULL, infoLog);
+                        errorLog += infoLog;
+                        compiled = false;
+                    }
+                }
+
+                GLint linkStatus;
+                glGetProgramiv(progHandle, GL_LINK_STATUS, &linkStatus);
+                if (compiled && linkStatus == GL_FALSE)
+                {
+                    GLchar infoLog[1024];
+                    glGetProgramInfoLog(progHandle, 1024, NULL, infoLog);
+                    errorLog += infoLog;
+                }
+
+                for (const auto &shdrHandle : shdrHandles)
+                {
+                    glDetachShader(progHandle, shdrHandle);
+                    glDeleteShader(shdrHandle);
+                }
+
+                if (!compiled || linkStatus == GL_FALSE)
+                {
+                    glDeleteProgram(progHandle);
+                    return false;
+                }
+                return true;
             }
 
-            // set fixed uniform values for texture units
+            /* sets fixed uniform values for texture units */
+            void setTextureUnits(GLuint progHandle)
             {
                 glUseProgram(progHandle);
                 GLint unif;
@@ -154,6 +370,49 @@ namespace yourgame
 
                 glUseProgram(0);
             }
+        } // namespace
+
+        void Shader::setBinaryCacheDir(const std::string &cacheDir)
+        {
+            binaryCacheDir = cacheDir;
+        }
+
+        Shader *Shader::make(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                             const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                             const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
+                             std::string &errorLog)
+        {
+            const bool useCache = isBinaryCacheUsable();
+            uint64_t cacheKey = 0;
+            if (useCache)
+            {
+                cacheKey = programKey(shaderCodes, attrLocs, fragDataLocs);
+                GLuint progHandle = loadProgramBinary(cacheKey);
+                if (progHandle != 0)
+                {
+                    return fromProgram(progHandle);
+                }
+            }
+
+            std::vector<GLuint> shdrHandles;
+            GLuint progHandle = submitProgram(shaderCodes, attrLocs, fragDataLocs, useCache, shdrHandles);
+            if (!finishProgram(progHandle, shdrHandles, errorLog))
+            {
+                return nullptr;
+            }
+
+            if (useCache)
+            {
+                saveProgramBinary(progHandle, cacheKey);
+            }
+
+            return fromProgram(progHandle);
+        }
+
+        Shader *Shader::fromProgram(GLuint progHandle)
+        {
+            // uniform values are not part of a program binary, set them in any case
+            setTextureUnits(progHandle);
 
             Shader *newShader = new Shader();
             newShader->m_programHandle = progHandle;
@@ -229,5 +488,85 @@ namespace yourgame
                 return unifLoc;
             }
         }
+
+        bool ShaderBatch::isParallelCompileSupported()
+        {
+            return hasParallelCompile();
+        }
+
+        ShaderBatch::~ShaderBatch()
+        {
+            for (const auto &pending : m_pending)
+            {
+                for (const auto &shdrHandle : pending.shdrHandles)
+                {
+                    glDeleteShader(shdrHandle);
+                }
+                glDeleteProgram(pending.progHandle);
+            }
+        }
+
+        size_t ShaderBatch::submit(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                                   const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                   const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+        {
+            Pending pending;
+            pending.index = m_numSubmitted++;
+            pending.useCache = isBinaryCacheUsable();
+            pending.cacheKey = 0;
+            pending.progHandle = 0;
+            if (pending.useCache)
+            {
+                pending.cacheKey = programKey(shaderCodes, attrLocs, fragDataLocs);
+                pending.progHandle = loadProgramBinary(pending.cacheKey);
+            }
+
+            if (pending.progHandle != 0)
+            {
+                pending.useCache = false; // loaded from the cache, nothing to write
+            }
+            else
+            {
+                pending.progHandle = submitProgram(shaderCodes, attrLocs, fragDataLocs, pending.useCache, pending.shdrHandles);
+            }
+
+            m_pending.push_back(std::move(pending));
+            return m_pending.back().index;
+        }
+
+        size_t ShaderBatch::poll(const std::function<void(size_t, Shader *, const std::string &)> &ready, bool wait)
+        {
+            std::vector<Pending> stillPending;
+            for (auto &pending : m_pending)
+            {
+                if (!wait && !isProgramComplete(pending.progHandle))
+                {
+                    stillPending.push_back(std::move(pending));
+                    continue;
+                }
+
+                std::string errorLog;
+                Shader *shader = nullptr;
+                if (finishProgram(pending.progHandle, pending.shdrHandles, errorLog))
+                {
+                    if (pending.useCache)
+                    {
+                        saveProgramBinary(pending.progHandle, pending.cacheKey);
+                    }
+                    shader = Shader::fromProgram(pending.progHandle);
+                }
+
+                if (ready)
+                {
+                    ready(pending.index, shader, errorLog);
+                }
+                else
+                {
+                    delete shader;
+                }
+            }
+            m_pending = std::move(stillPending);
+            return m_pending.size();
+        }
     } // namespace gl
 } // namespace yourgame
@@ -0,0 +1,57 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include "yourgame/gl/shadervariants.h"
+#include "yourgame/gl/loading.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        ShaderVariants *ShaderVariants::make(const std::vector<std::pair<GLenum, std::string>> &shaderCodes,
+                                             const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                             const std::vector<std::pair<GLuint, std::string>> &fragDataLocs)
+        {
+            ShaderVariants *newVariants = new ShaderVariants();
+            newVariants->m_shaderCodes = shaderCodes;
+            newVariants->m_attrLocs = attrLocs;
+            newVariants->m_fragDataLocs = fragDataLocs;
+            return newVariants;
+        }
+
+        Shader *ShaderVariants::get(const std::vector<std::string> &defines)
+        {
+            // sorted, so that the same set of defines results in the same key (and source)
+            std::vector<std::string> key = defines;
+            std::sort(key.begin(), key.end());
+            key.erase(std::unique(key.begin(), key.end()), key.end());
+
+            auto variant = m_variants.find(key);
+            if (variant != m_variants.end())
+            {
+                return variant->second.get();
+            }
+
+            Shader *shader = loadShaderFromStrings(m_shaderCodes, m_attrLocs, m_fragDataLocs, key);
+            m_variants[key] = std::unique_ptr<Shader>(shader);
+            return shader;
+        }
+    } // namespace gl
+} // namespace yourgame
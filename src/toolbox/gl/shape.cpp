@@ -17,6 +17,7 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <algorithm>
 #include "yourgame/gl/shape.h"
 
 namespace yourgame
@@ -90,23 +91,45 @@ namespace yourgame
             return true;
         }
 
+        void Shape::setLods(std::vector<Lod> lods)
+        {
+            m_lods = lods;
+        }
+
+        Shape::Lod Shape::getLod(size_t lod) const
+        {
+            if (lod == 0 || m_lods.empty())
+            {
+                return {0, m_elArDescr.numElements};
+            }
+            return m_lods[std::min(lod, m_lods.size()) - 1];
+        }
+
         Shape::~Shape()
         {
             glDeleteVertexArrays(1, &m_vaoHandle);
         }
 
-        void Shape::draw()
+        void Shape::draw(size_t lod)
         {
+            auto l = getLod(lod);
             glBindVertexArray(m_vaoHandle);
-            glDrawElements(m_elArDescr.drawMode, m_elArDescr.numElements, m_elArDescr.type, 0);
+            glDrawElements(m_elArDescr.drawMode, l.numElements, m_elArDescr.type, getElementOffset(l.firstElement));
             glBindVertexArray(0);
         }
 
-        void Shape::drawInstanced(GLsizei instancecount)
+        void Shape::drawInstanced(GLsizei instancecount, size_t lod)
         {
+            auto l = getLod(lod);
             glBindVertexArray(m_vaoHandle);
-            glDrawElementsInstanced(m_elArDescr.drawMode, m_elArDescr.numElements, m_elArDescr.type, 0, instancecount);
+            glDrawElementsInstanced(m_elArDescr.drawMode, l.numElements, m_elArDescr.type, getElementOffset(l.firstElement), instancecount);
             glBindVertexArray(0);
         }
+
+        const GLvoid *Shape::getElementOffset(GLsizei firstElement) const
+        {
+            size_t elementSize = (m_elArDescr.type == GL_UNSIGNED_INT) ? 4 : ((m_elArDescr.type == GL_UNSIGNED_SHORT) ? 2 : 1);
+            return (const GLvoid *)(firstElement * elementSize);
+        }
     } // namespace gl
 } // namespace yourgame
@@ -17,7 +17,12 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
 #include "yourgame/gl/conventions.h"
+#include "yourgame/gl/loading.h"
 #include "yourgame/gl/spritegrid.h"
 
 namespace yourgame
@@ -30,7 +35,8 @@ namespace yourgame
                              const std::vector<std::string> &tiles,
                              unsigned int width,
                              float gridWidth,
-                             float gridHeight)
+                             float gridHeight,
+                             const MeshQuantization &quantization)
         {
             if (!atlas || tiles.empty())
             {
@@ -155,43 +161,66 @@ namespace yourgame
 
             // the data is prepared now...
 
-            auto vertPosSize = objPosData.size() * sizeof(objPosData[0]);
-            auto vertNormSize = objNormalData.size() * sizeof(objNormalData[0]);
-            auto vertTexcoordsSize = objTexCoordData.size() * sizeof(objTexCoordData[0]);
-            auto vertColorSize = objColordData.size() * sizeof(objColordData[0]);
-            auto vertIdxSize = objIdxData.size() * sizeof(objIdxData[0]);
-
-            if (!m_geo)
+            auto toBytes = [](const void *data, size_t size)
             {
-                m_geo = yourgame::gl::Geometry::make();
-                // todo: make buffer usage (GL_STATIC_DRAW) configurable
-                m_geo->addBuffer("pos", GL_ARRAY_BUFFER, vertPosSize, objPosData.data(), GL_STATIC_DRAW);
-                m_geo->addBuffer("norm", GL_ARRAY_BUFFER, vertNormSize, objNormalData.data(), GL_STATIC_DRAW);
-                m_geo->addBuffer("texcoords", GL_ARRAY_BUFFER, vertTexcoordsSize, objTexCoordData.data(), GL_STATIC_DRAW);
-                m_geo->addBuffer("color", GL_ARRAY_BUFFER, vertColorSize, objColordData.data(), GL_STATIC_DRAW);
-                m_geo->addBuffer("idx", GL_ELEMENT_ARRAY_BUFFER, vertIdxSize, objIdxData.data(), GL_STATIC_DRAW);
+                const uint8_t *bytes = static_cast<const uint8_t *>(data);
+                return std::vector<uint8_t>(bytes, bytes + size);
+            };
+
+            MeshData mesh;
+            mesh.buffers = {{"pos", GL_ARRAY_BUFFER, toBytes(objPosData.data(), objPosData.size() * sizeof(objPosData[0]))},
+                            {"norm", GL_ARRAY_BUFFER, toBytes(objNormalData.data(), objNormalData.size() * sizeof(objNormalData[0]))},
+                            {"texcoords", GL_ARRAY_BUFFER, toBytes(objTexCoordData.data(), objTexCoordData.size() * sizeof(objTexCoordData[0]))},
+                            {"color", GL_ARRAY_BUFFER, toBytes(objColordData.data(), objColordData.size() * sizeof(objColordData[0]))},
+                            {"idx", GL_ELEMENT_ARRAY_BUFFER, toBytes(objIdxData.data(), objIdxData.size() * sizeof(objIdxData[0]))}};
 
-                std::vector<std::string> arBufferNames = {"pos", "norm", "texcoords", "color"};
+            MeshData::ShapeData shape;
+            shape.name = "main";
+            shape.attribs = {{0, {gl::attrLocPosition, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}},
+                             {1, {gl::attrLocNormal, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}},
+                             {2, {gl::attrLocTexcoords, 2, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}},
+                             {3, {gl::attrLocColor, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}}};
+            shape.elArDescr = {GL_UNSIGNED_INT, GL_TRIANGLES, (GLsizei)objIdxData.size()};
+            shape.indexBuffer = 4;
+            mesh.shapes.push_back(shape);
 
-                std::vector<yourgame::gl::Shape::ArrBufferDescr> arDescrs =
-                    {{gl::attrLocPosition, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0},
-                     {gl::attrLocNormal, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0},
-                     {gl::attrLocTexcoords, 2, GL_FLOAT, GL_FALSE, 0, (void *)0, 0},
-                     {gl::attrLocColor, 3, GL_FLOAT, GL_FALSE, 0, (void *)0, 0}};
+            mesh.quantize(quantization);
+            std::copy(mesh.positionOffset, mesh.positionOffset + 3, m_positionOffset);
+            std::copy(mesh.positionScale, mesh.positionScale + 3, m_positionScale);
+
+            // keeping the texture coordinates for setTiles()
+            m_numTiles = numTiles;
+            m_texcoordData = mesh.buffers[2].data;
+            m_texcoordDescr = mesh.shapes[0].attribs[2].descr;
+
+            // the vertex formats of the existing geometry must match
+            if (m_geo && (m_quantization.positions != quantization.positions ||
+                          m_quantization.normals != quantization.normals ||
+                          m_quantization.colors != quantization.colors ||
+                          m_quantization.texcoords != quantization.texcoords))
+            {
+                delete m_geo;
+                m_geo = nullptr;
+            }
+            m_quantization = quantization;
 
-                m_geo->addShape("main", arDescrs, arBufferNames, {GL_UNSIGNED_INT, GL_TRIANGLES, (GLsizei)objIdxData.size()}, "idx");
+            if (!m_geo)
+            {
+                // todo: make buffer usage (GL_STATIC_DRAW) configurable
+                m_geo = makeGeometry(mesh);
 
                 // todo: leave m_geo in a valid state if buffer creation failed
             }
             else
             {
-                m_geo->bufferData("pos", vertPosSize, objPosData.data());
-                m_geo->bufferData("norm", vertNormSize, objNormalData.data());
-                m_geo->bufferData("texcoords", vertTexcoordsSize, objTexCoordData.data());
-                m_geo->bufferData("color", vertColorSize, objColordData.data());
-                m_geo->bufferData("idx", vertIdxSize, objIdxData.data());
-                // the shape needs to know how many elements to draw:
-                m_geo->setShapeElArDescr("main", {GL_UNSIGNED_INT, GL_TRIANGLES, (GLsizei)objIdxData.size()});
+                // the buffers only reallocate if the grid grew beyond their capacity
+                for (const auto &buf : mesh.buffers)
+                {
+                    m_geo->bufferData(buf.name, buf.data.size(), buf.data.data());
+                }
+                // the shape needs to know how many elements to draw (and their type):
+                m_geo->setShapeElArDescr("main", mesh.shapes[0].elArDescr);
+                m_geo->setPositionDequantization(mesh.positionOffset, mesh.positionScale);
 
                 // todo: leave m_geo in a valid state if buffer creation failed
             }
@@ -199,6 +228,59 @@ namespace yourgame
             return 0;
         }
 
+        int SpriteGrid::setTiles(const yourgame::gl::Texture *atlas,
+                                 const std::vector<std::pair<size_t, std::string>> &tiles)
+        {
+            if (!m_geo || !atlas)
+            {
+                return -1;
+            }
+            for (const auto &tile : tiles)
+            {
+                if (tile.first >= m_numTiles)
+                {
+                    return -1;
+                }
+            }
+
+            bool isHalf = (m_texcoordDescr.type == GL_HALF_FLOAT);
+            size_t componentSize = isHalf ? 2 : 4;
+            size_t stride = (m_texcoordDescr.stride != 0) ? (size_t)m_texcoordDescr.stride : 2 * componentSize;
+            size_t offset = (size_t)m_texcoordDescr.pointer;
+
+            for (const auto &tile : tiles)
+            {
+                auto coords = atlas->getCoords(tile.second);
+                const float uv[8] = {coords.uMin, coords.vMax,
+                                     coords.uMax, coords.vMax,
+                                     coords.uMax, coords.vMin,
+                                     coords.uMin, coords.vMin};
+
+                // 4 vertices per tile, see make()
+                size_t tileBegin = tile.first * 4 * stride;
+                for (size_t v = 0; v < 4; v++)
+                {
+                    uint8_t *dst = m_texcoordData.data() + tileBegin + v * stride + offset;
+                    for (size_t c = 0; c < 2; c++)
+                    {
+                        if (isHalf)
+                        {
+                            uint16_t h = glm::packHalf1x16(uv[v * 2 + c]);
+                            std::memcpy(dst + 2 * c, &h, 2);
+                        }
+                        else
+                        {
+                            std::memcpy(dst + 4 * c, &uv[v * 2 + c], 4);
+                        }
+                    }
+                }
+                m_geo->markDirty("texcoords", (GLintptr)tileBegin, (GLsizeiptr)(4 * stride));
+            }
+
+            m_geo->uploadDirty("texcoords", m_texcoordData.data());
+            return 0;
+        }
+
         SpriteGrid::~SpriteGrid()
         {
             delete m_geo;
@@ -0,0 +1,168 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cstring>
+#include "yourgame/gl/streambuffer.h"
+
+namespace yourgame
+{
+    namespace gl
+    {
+        namespace
+        {
+            GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment)
+            {
+                return (value + alignment - 1) / alignment * alignment;
+            }
+
+            /* waits for the GPU to pass fence and deletes it */
+            void waitAndDelete(GLsync fence)
+            {
+#ifndef __EMSCRIPTEN__
+                // WebGL fences are signaled between frames only (waiting would block forever),
+                // uploads are copies there, which do not need to wait for the GPU
+                while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+                {
+                }
+#endif
+                glDeleteSync(fence);
+            }
+        } // namespace
+
+        constexpr GLsizeiptr StreamBuffer::alignment;
+
+        StreamBuffer *StreamBuffer::make(GLenum target, GLsizeiptr regionSize, GLuint numRegions)
+        {
+            if (regionSize <= 0 || numRegions == 0)
+            {
+                return nullptr;
+            }
+
+            regionSize = alignUp(regionSize, alignment);
+            Buffer *buffer = Buffer::make(target, regionSize * numRegions, nullptr, GL_STREAM_DRAW);
+            if (!buffer)
+            {
+                return nullptr;
+            }
+            buffer->unbindTarget();
+
+            StreamBuffer *newBuf = new StreamBuffer();
+            newBuf->m_buffer = buffer;
+            newBuf->m_target = target;
+            newBuf->m_regionSize = regionSize;
+            newBuf->m_fences.resize(numRegions, nullptr);
+            return newBuf;
+        }
+
+        StreamBuffer::~StreamBuffer()
+        {
+            for (auto fence : m_fences)
+            {
+                if (fence)
+                {
+                    glDeleteSync(fence);
+                }
+            }
+            delete m_buffer;
+        }
+
+        void StreamBuffer::nextFrame()
+        {
+            if (m_regionUsed > 0)
+            {
+                m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+
+            m_region = (m_region + 1) % m_fences.size();
+            m_regionUsed = 0;
+
+            if (m_fences[m_region])
+            {
+                waitAndDelete(m_fences[m_region]);
+                m_fences[m_region] = nullptr;
+            }
+        }
+
+        bool StreamBuffer::reserve(GLsizeiptr size)
+        {
+            if (m_regionUsed + size <= m_regionSize)
+            {
+                return true;
+            }
+            if (m_regionUsed > 0)
+            {
+                return false;
+            }
+
+            // respecifying the storage orphans the old one, the GPU keeps reading from it
+            for (auto &fence : m_fences)
+            {
+                if (fence)
+                {
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+            m_regionSize = alignUp(std::max(size, 2 * m_regionSize), alignment);
+            m_region = 0;
+            bool ok = m_buffer->bufferData(m_regionSize * (GLsizeiptr)m_fences.size(), nullptr);
+            m_buffer->unbindTarget();
+            return ok;
+        }
+
+        GLintptr StreamBuffer::upload(const GLvoid *data, GLsizeiptr size)
+        {
+            if (m_regionUsed + size > m_regionSize)
+            {
+                return -1;
+            }
+
+            GLintptr offset = m_region * m_regionSize + m_regionUsed;
+            m_regionUsed = std::min(alignUp(m_regionUsed + size, alignment), m_regionSize);
+            if (size == 0)
+            {
+                return offset;
+            }
+
+            m_buffer->bind();
+#ifdef __EMSCRIPTEN__
+            glBufferSubData(m_target, offset, size, data);
+#else
+            // the range is not in use by the GPU (see nextFrame()), no need to synchronize
+            void *dst = glMapBufferRange(m_target, offset, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (!dst)
+            {
+                m_buffer->unbindTarget();
+                return -1;
+            }
+            std::memcpy(dst, data, size);
+            if (glUnmapBuffer(m_target) == GL_FALSE)
+            {
+                // the data store got corrupted while it was mapped
+                m_buffer->unbindTarget();
+                return -1;
+            }
+#endif
+            m_buffer->unbindTarget();
+            return offset;
+        }
+    } // namespace gl
+} // namespace yourgame
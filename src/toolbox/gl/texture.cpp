@@ -17,10 +17,30 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
-#include <regex>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include "yourgame/gl_include.h"
 #include "yourgame/gl/texture.h"
 
+namespace
+{
+    // sprite names that have indexes at the end (with - or _),
+    // like walking_01, or walking-01, but NOT: walking01
+    bool splitSequenceName(const std::string &name, std::string &seqName, int &seqFrameIdx)
+    {
+        size_t sep = name.find_last_not_of("0123456789");
+        if (sep != std::string::npos && sep > 0 && sep + 1 < name.size() &&
+            (name[sep] == '-' || name[sep] == '_'))
+        {
+            seqName = name.substr(0, sep);
+            seqFrameIdx = std::stoi(name.substr(sep + 1));
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
 namespace yourgame
 {
     namespace gl
@@ -64,6 +84,13 @@ namespace yourgame
             glBindTexture(m_target, 0);
         }
 
+        void Texture::setParameteri(GLenum pname, GLint param)
+        {
+            glBindTexture(m_target, m_handle);
+            glTexParameteri(m_target, pname, param);
+            glBindTexture(m_target, 0);
+        }
+
         void Texture::updateData(GLenum target,
                                  GLint level,
                                  GLint internalformat,
@@ -96,35 +123,102 @@ namespace yourgame
 
             glBindTexture(m_target, 0);
 
-            m_width = width;
-            m_height = height;
+            if (level == 0)
+            {
+                m_width = width;
+                m_height = height;
+            }
+        }
+
+        void Texture::updateCompressedData(GLenum target,
+                                           GLint level,
+                                           GLenum internalformat,
+                                           GLsizei width,
+                                           GLsizei height,
+                                           GLsizei imageSize,
+                                           const void *data)
+        {
+            glActiveTexture(m_unit);
+            glBindTexture(m_target, m_handle);
+
+            glCompressedTexImage2D(target, // target can be != m_target (cubemaps...)
+                                   level,
+                                   internalformat,
+                                   width,
+                                   height,
+                                   0,
+                                   imageSize,
+                                   data);
+
+            glBindTexture(m_target, 0);
+
+            if (level == 0)
+            {
+                m_width = width;
+                m_height = height;
+            }
         }
 
-        void Texture::insertCoords(std::string name, int x, int y, int width, int height, bool cwRot)
+        void Texture::insertCoords(const std::string &name, int x, int y, int width, int height, bool cwRot)
         {
             if (width == 0 || height == 0 || getWidth() == 0 || getHeight() == 0)
             {
                 return;
             }
 
-            m_coords[name] = TextureCoords(x, y, width, height, getWidth(), getHeight(), cwRot);
+            TextureCoords coords(x, y, width, height, getWidth(), getHeight(), cwRot);
+            m_coords[AssetId(name)] = coords;
 
-            // matches sprite names that have indexes at the end (with - or _),
-            // like walking_01, or walking-01, but NOT: walking01
-            static std::regex reSequence("^(.+)[-_](\\d+)$");
-            std::smatch reMatch;
-            if (std::regex_match(name, reMatch, reSequence) && reMatch.size() == 3)
+            std::string seqName;
+            int seqFrameIdx;
+            if (splitSequenceName(name, seqName, seqFrameIdx))
             {
-                // match 0: full string, 1: base, 2: index string
-                int seqFrameIdx = std::stoi(reMatch[2].str());
-                m_sequences[reMatch[1].str()].frames[seqFrameIdx] = m_coords[name];
+                Sequence &seq = m_sequences[AssetId(seqName)];
+                seq.frames[seqFrameIdx] = coords;
 
                 // make sure framesConsec of this Sequence gets updated
-                m_sequences[reMatch[1].str()].framesInvalidated = true;
+                seq.framesInvalidated = true;
+                m_sequenceNames.insert(seqName);
+            }
+        }
+
+        void Texture::insertAtlas(const AtlasData &atlas)
+        {
+            if (getWidth() == 0 || getHeight() == 0)
+            {
+                return;
+            }
+
+            std::vector<TextureCoords> coords;
+            coords.reserve(atlas.frames.size());
+            m_coords.reserve(m_coords.size() + atlas.frames.size());
+            for (const auto &f : atlas.frames)
+            {
+                coords.emplace_back(f.x, f.y, f.width, f.height, getWidth(), getHeight(), f.cwRot);
+                if (f.width != 0 && f.height != 0)
+                {
+                    m_coords[f.id] = coords.back();
+                }
+            }
+
+            for (const auto &s : atlas.sequences)
+            {
+                Sequence &seq = m_sequences[s.id];
+                for (const auto &f : s.frames)
+                {
+                    // like insertCoords(): zero-size frames are skipped, existing frames are replaced
+                    if (f.second < coords.size() && atlas.frames[f.second].width != 0 && atlas.frames[f.second].height != 0)
+                    {
+                        // ascending frame indices: appended at the end of the map
+                        seq.frames.emplace_hint(seq.frames.end(), f.first, coords[f.second])->second = coords[f.second];
+                    }
+                }
+                seq.framesInvalidated = true;
+                m_sequenceNames.insert(s.name);
             }
         }
 
-        TextureCoords Texture::getCoords(std::string name) const
+        TextureCoords Texture::getCoords(AssetId name) const
         {
             auto it = m_coords.find(name);
             if (it != m_coords.end())
@@ -135,7 +229,7 @@ namespace yourgame
             return getGridCoords(1, 1, 0);
         }
 
-        TextureCoords Texture::getFrameCoords(std::string sequenceName, int frame)
+        TextureCoords Texture::getFrameCoords(AssetId sequenceName, int frame)
         {
             auto it = m_sequences.find(sequenceName);
             if (it != m_sequences.end())
@@ -167,7 +261,7 @@ namespace yourgame
             return getGridCoords(1, 1, 0);
         }
 
-        int Texture::getNumFrames(std::string sequenceName) const
+        int Texture::getNumFrames(AssetId sequenceName) const
         {
             auto it = m_sequences.find(sequenceName);
             return (it == m_sequences.end()) ? 0 : it->second.frames.size();
@@ -175,12 +269,7 @@ namespace yourgame
 
         std::vector<std::string> Texture::getSequenceNames() const
         {
-            std::vector<std::string> names;
-            for (const auto &seq : m_sequences)
-            {
-                names.push_back(seq.first);
-            }
-            return names;
+            return std::vector<std::string>(m_sequenceNames.begin(), m_sequenceNames.end());
         }
 
         TextureCoords Texture::getGridCoords(int gridWidth, int gridHeight, int index) const
@@ -206,5 +295,67 @@ namespace yourgame
 
             return coords;
         }
+
+        void AtlasData::addFrame(const std::string &name, int x, int y, int width, int height, bool cwRot)
+        {
+            // zero-size frames are skipped, like in Texture::insertCoords()
+            if (width == 0 || height == 0)
+            {
+                return;
+            }
+
+            frames.push_back({AssetId(name), x, y, width, height, cwRot});
+
+            std::string seqName;
+            int seqFrameIdx;
+            if (splitSequenceName(name, seqName, seqFrameIdx))
+            {
+                AssetId seqId(seqName);
+                auto found = sequenceIndex.find(seqId);
+
+                // sequences added or reordered other than by addFrame(): rebuild the index
+                if ((found != sequenceIndex.end() && (found->second >= sequences.size() || sequences[found->second].id != seqId)) ||
+                    sequenceIndex.size() != sequences.size())
+                {
+                    sequenceIndex.clear();
+                    for (size_t i = 0; i < sequences.size(); i++)
+                    {
+                        sequenceIndex[sequences[i].id] = i;
+                    }
+                    found = sequenceIndex.find(seqId);
+                }
+
+                if (found == sequenceIndex.end())
+                {
+                    sequences.push_back({seqName, seqId, {}});
+                    found = sequenceIndex.emplace(seqId, sequences.size() - 1).first;
+                }
+                sequences[found->second].frames.push_back({seqFrameIdx, (uint32_t)(frames.size() - 1)});
+            }
+        }
+
+        void AtlasData::sortSequences()
+        {
+            for (auto &seq : sequences)
+            {
+                // stable: of frames with the same index, the last one wins (like in insertCoords())
+                std::stable_sort(seq.frames.begin(), seq.frames.end(),
+                                 [](const std::pair<int, uint32_t> &a, const std::pair<int, uint32_t> &b)
+                                 { return a.first < b.first; });
+                std::vector<std::pair<int, uint32_t>> unique;
+                for (const auto &f : seq.frames)
+                {
+                    if (!unique.empty() && unique.back().first == f.first)
+                    {
+                        unique.back() = f;
+                    }
+                    else
+                    {
+                        unique.push_back(f);
+                    }
+                }
+                seq.frames.swap(unique);
+            }
+        }
     } // namespace gl
 } // namespace yourgame
@@ -0,0 +1,491 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cstring>
+#include "yourgame/gl/texturedata.h"
+
+namespace
+{
+    // compressed formats (values of the GL registry, as the extension headers are optional)
+    const GLenum formatEtc1Rgb8 = 0x8D64;             // GL_ETC1_RGB8_OES
+    const GLenum formatEtc2Rgb8 = 0x9274;             // GL_COMPRESSED_RGB8_ETC2
+    const GLenum formatEtc2Srgb8 = 0x9275;            // GL_COMPRESSED_SRGB8_ETC2
+    const GLenum formatEtc2Rgba8 = 0x9278;            // GL_COMPRESSED_RGBA8_ETC2_EAC
+    const GLenum formatEtc2Srgb8Alpha8 = 0x9279;      // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+    const GLenum formatDxt1Rgb = 0x83F0;              // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    const GLenum formatDxt1Rgba = 0x83F1;             // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    const GLenum formatDxt3Rgba = 0x83F2;             // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+    const GLenum formatDxt5Rgba = 0x83F3;             // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    const GLenum formatDxt1Srgb = 0x8C4C;             // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    const GLenum formatDxt1SrgbAlpha = 0x8C4D;        // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    const GLenum formatDxt3SrgbAlpha = 0x8C4E;        // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+    const GLenum formatDxt5SrgbAlpha = 0x8C4F;        // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+
+    enum class BlockCodec
+    {
+        NONE,
+        ETC2_RGB,  // ETC1 is a subset
+        ETC2_RGBA, // EAC alpha block + ETC2 color block
+        BC1,
+        BC1_ALPHA,
+        BC2,
+        BC3
+    };
+
+    struct BlockFormat
+    {
+        BlockCodec codec;
+        size_t blockSize;
+        bool srgb;
+    };
+
+    BlockFormat getBlockFormat(GLenum internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case formatEtc1Rgb8:
+        case formatEtc2Rgb8:
+            return {BlockCodec::ETC2_RGB, 8, false};
+        case formatEtc2Srgb8:
+            return {BlockCodec::ETC2_RGB, 8, true};
+        case formatEtc2Rgba8:
+            return {BlockCodec::ETC2_RGBA, 16, false};
+        case formatEtc2Srgb8Alpha8:
+            return {BlockCodec::ETC2_RGBA, 16, true};
+        case formatDxt1Rgb:
+            return {BlockCodec::BC1, 8, false};
+        case formatDxt1Srgb:
+            return {BlockCodec::BC1, 8, true};
+        case formatDxt1Rgba:
+            return {BlockCodec::BC1_ALPHA, 8, false};
+        case formatDxt1SrgbAlpha:
+            return {BlockCodec::BC1_ALPHA, 8, true};
+        case formatDxt3Rgba:
+            return {BlockCodec::BC2, 16, false};
+        case formatDxt3SrgbAlpha:
+            return {BlockCodec::BC2, 16, true};
+        case formatDxt5Rgba:
+            return {BlockCodec::BC3, 16, false};
+        case formatDxt5SrgbAlpha:
+            return {BlockCodec::BC3, 16, true};
+        default:
+            return {BlockCodec::NONE, 0, false};
+        }
+    }
+
+    uint8_t clamp255(int v)
+    {
+        return (uint8_t)std::min(std::max(v, 0), 255);
+    }
+
+    uint8_t extend4(int v) { return (uint8_t)((v << 4) | v); }
+    uint8_t extend5(int v) { return (uint8_t)((v << 3) | (v >> 2)); }
+    uint8_t extend6(int v) { return (uint8_t)((v << 2) | (v >> 4)); }
+    uint8_t extend7(int v) { return (uint8_t)((v << 1) | (v >> 6)); }
+
+    /* decodes an ETC1/ETC2 RGB block (8 bytes) to 4x4 RGBA pixels (alpha is not written).
+    dst is the first pixel, rows are dstStride bytes apart. see the OpenGL ES 3.0 specification, C.1 */
+    void decodeEtc2ColorBlock(const uint8_t *b, uint8_t *dst, size_t dstStride)
+    {
+        static const int modifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+        static const int distances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+        // pixel indices, column-major: pixel (x, y) is bit x * 4 + y
+        uint32_t msb = ((uint32_t)b[4] << 8) | b[5];
+        uint32_t lsb = ((uint32_t)b[6] << 8) | b[7];
+        auto getIndex = [msb, lsb](int x, int y)
+        {
+            int i = x * 4 + y;
+            return (int)((((msb >> i) & 1U) << 1) | ((lsb >> i) & 1U));
+        };
+        auto setPixel = [dst, dstStride](int x, int y, int r, int g, int b)
+        {
+            uint8_t *px = dst + y * dstStride + x * 4;
+            px[0] = clamp255(r);
+            px[1] = clamp255(g);
+            px[2] = clamp255(b);
+        };
+
+        int base[2][3];
+        bool diff = (b[3] & 2) != 0;
+        if (diff)
+        {
+            int r = b[0] >> 3;
+            int g = b[1] >> 3;
+            int bl = b[2] >> 3;
+            int r2 = r + (((int)(b[0] & 7) ^ 4) - 4);
+            int g2 = g + (((int)(b[1] & 7) ^ 4) - 4);
+            int b2 = bl + (((int)(b[2] & 7) ^ 4) - 4);
+
+            if (r2 < 0 || r2 > 31) // T mode
+            {
+                int c[2][3] = {{extend4(((b[0] >> 1) & 0xC) | (b[0] & 3)), extend4(b[1] >> 4), extend4(b[1] & 0xF)},
+                               {extend4(b[2] >> 4), extend4(b[2] & 0xF), extend4(b[3] >> 4)}};
+                int d = distances[((b[3] >> 1) & 6) | (b[3] & 1)];
+                int paint[4][3] = {{c[0][0], c[0][1], c[0][2]},
+                                   {c[1][0] + d, c[1][1] + d, c[1][2] + d},
+                                   {c[1][0], c[1][1], c[1][2]},
+                                   {c[1][0] - d, c[1][1] - d, c[1][2] - d}};
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        const int *p = paint[getIndex(x, y)];
+                        setPixel(x, y, p[0], p[1], p[2]);
+                    }
+                }
+                return;
+            }
+            if (g2 < 0 || g2 > 31) // H mode
+            {
+                int c4[2][3] = {{(b[0] >> 3) & 0xF, ((b[0] & 7) << 1) | ((b[1] >> 4) & 1), (b[1] & 8) | ((b[1] & 3) << 1) | (b[2] >> 7)},
+                                {(b[2] >> 3) & 0xF, ((b[2] & 7) << 1) | (b[3] >> 7), (b[3] >> 3) & 0xF}};
+                int order = ((c4[0][0] << 8) | (c4[0][1] << 4) | c4[0][2]) >= ((c4[1][0] << 8) | (c4[1][1] << 4) | c4[1][2]) ? 1 : 0;
+                int d = distances[(b[3] & 4) | ((b[3] & 1) << 1) | order];
+                int paint[4][3];
+                for (int k = 0; k < 3; k++)
+                {
+                    paint[0][k] = extend4(c4[0][k]) + d;
+                    paint[1][k] = extend4(c4[0][k]) - d;
+                    paint[2][k] = extend4(c4[1][k]) + d;
+                    paint[3][k] = extend4(c4[1][k]) - d;
+                }
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        const int *p = paint[getIndex(x, y)];
+                        setPixel(x, y, p[0], p[1], p[2]);
+                    }
+                }
+                return;
+            }
+            if (b2 < 0 || b2 > 31) // planar mode
+            {
+                int o[3] = {extend6((b[0] >> 1) & 0x3F),
+                            extend7(((b[0] & 1) << 6) | ((b[1] >> 1) & 0x3F)),
+                            extend6(((b[1] & 1) << 5) | (((b[2] >> 3) & 3) << 3) | ((b[2] & 3) << 1) | (b[3] >> 7))};
+                int h[3] = {extend6((((b[3] >> 2) & 0x1F) << 1) | (b[3] & 1)),
+                            extend7(b[4] >> 1),
+                            extend6(((b[4] & 1) << 5) | (b[5] >> 3))};
+                int v[3] = {extend6(((b[5] & 7) << 3) | (b[6] >> 5)),
+                            extend7(((b[6] & 0x1F) << 2) | (b[7] >> 6)),
+                            extend6(b[7] & 0x3F)};
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int c[3];
+                        for (int k = 0; k < 3; k++)
+                        {
+                            c[k] = (x * (h[k] - o[k]) + y * (v[k] - o[k]) + 4 * o[k] + 2) >> 2;
+                        }
+                        setPixel(x, y, c[0], c[1], c[2]);
+                    }
+                }
+                return;
+            }
+
+            base[0][0] = extend5(r);
+            base[0][1] = extend5(g);
+            base[0][2] = extend5(bl);
+            base[1][0] = extend5(r2);
+            base[1][1] = extend5(g2);
+            base[1][2] = extend5(b2);
+        }
+        else
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                base[0][k] = extend4(b[k] >> 4);
+                base[1][k] = extend4(b[k] & 0xF);
+            }
+        }
+
+        // individual or differential mode: two sub-blocks, side by side (2x4) or on top of each other (4x2)
+        bool flip = (b[3] & 1) != 0;
+        int table[2] = {(b[3] >> 5) & 7, (b[3] >> 2) & 7};
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                int sub = flip ? (y >= 2) : (x >= 2);
+                int idx = getIndex(x, y);
+                int m = modifiers[table[sub]][idx & 1];
+                if (idx & 2)
+                {
+                    m = -m;
+                }
+                setPixel(x, y, base[sub][0] + m, base[sub][1] + m, base[sub][2] + m);
+            }
+        }
+    }
+
+    /* decodes an EAC alpha block (8 bytes) to the alpha of 4x4 RGBA pixels */
+    void decodeEacAlphaBlock(const uint8_t *b, uint8_t *dst, size_t dstStride)
+    {
+        static const int modifiers[16][8] = {{-3, -6, -9, -15, 2, 5, 8, 14},
+                                             {-3, -7, -10, -13, 2, 6, 9, 12},
+                                             {-2, -5, -8, -13, 1, 4, 7, 12},
+                                             {-2, -4, -6, -13, 1, 3, 5, 12},
+                                             {-3, -6, -8, -12, 2, 5, 7, 11},
+                                             {-3, -7, -9, -11, 2, 6, 8, 10},
+                                             {-4, -7, -8, -11, 3, 6, 7, 10},
+                                             {-3, -5, -8, -11, 2, 4, 7, 10},
+                                             {-2, -6, -8, -10, 1, 5, 7, 9},
+                                             {-2, -5, -8, -10, 1, 4, 7, 9},
+                                             {-2, -4, -8, -10, 1, 3, 7, 9},
+                                             {-2, -5, -7, -10, 1, 4, 6, 9},
+                                             {-3, -4, -7, -10, 2, 3, 6, 9},
+                                             {-1, -2, -3, -10, 0, 1, 2, 9},
+                                             {-4, -6, -8, -9, 3, 5, 7, 8},
+                                             {-3, -5, -7, -9, 2, 4, 6, 8}};
+        int base = b[0];
+        int multiplier = b[1] >> 4;
+        const int *table = modifiers[b[1] & 0xF];
+        uint64_t bits = 0;
+        for (int i = 2; i < 8; i++)
+        {
+            bits = (bits << 8) | b[i];
+        }
+        for (int x = 0; x < 4; x++)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                int idx = (int)((bits >> (45 - 3 * (x * 4 + y))) & 7);
+                dst[y * dstStride + x * 4 + 3] = clamp255(base + table[idx] * multiplier);
+            }
+        }
+    }
+
+    /* decodes an S3TC/BC1 color block (8 bytes) to 4x4 RGBA pixels. alpha is written
+    (0 for the transparent index of 3-color blocks, if alpha1bit), unless colorOnly */
+    void decodeBc1Block(const uint8_t *b, uint8_t *dst, size_t dstStride, bool alpha1bit, bool colorOnly)
+    {
+        int c0 = b[0] | (b[1] << 8);
+        int c1 = b[2] | (b[3] << 8);
+        int colors[4][4];
+        for (int k = 0; k < 2; k++)
+        {
+            int c = k ? c1 : c0;
+            colors[k][0] = extend5(c >> 11);
+            colors[k][1] = extend6((c >> 5) & 0x3F);
+            colors[k][2] = extend5(c & 0x1F);
+            colors[k][3] = 255;
+        }
+        bool fourColors = colorOnly || c0 > c1;
+        for (int k = 0; k < 3; k++)
+        {
+            if (fourColors)
+            {
+                colors[2][k] = (2 * colors[0][k] + colors[1][k]) / 3;
+                colors[3][k] = (colors[0][k] + 2 * colors[1][k]) / 3;
+            }
+            else
+            {
+                colors[2][k] = (colors[0][k] + colors[1][k]) / 2;
+                colors[3][k] = 0;
+            }
+        }
+        colors[2][3] = 255;
+        colors[3][3] = (fourColors || !alpha1bit) ? 255 : 0;
+
+        uint32_t indices = b[4] | (b[5] << 8) | (b[6] << 16) | ((uint32_t)b[7] << 24);
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                const int *c = colors[(indices >> (2 * (y * 4 + x))) & 3];
+                uint8_t *px = dst + y * dstStride + x * 4;
+                px[0] = (uint8_t)c[0];
+                px[1] = (uint8_t)c[1];
+                px[2] = (uint8_t)c[2];
+                if (!colorOnly)
+                {
+                    px[3] = (uint8_t)c[3];
+                }
+            }
+        }
+    }
+
+    /* decodes the explicit alpha of a BC2 block (8 bytes) */
+    void decodeBc2AlphaBlock(const uint8_t *b, uint8_t *dst, size_t dstStride)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                int i = y * 4 + x;
+                int a = (b[i / 2] >> ((i & 1) * 4)) & 0xF;
+                dst[y * dstStride + x * 4 + 3] = extend4(a);
+            }
+        }
+    }
+
+    /* decodes the interpolated alpha of a BC3 block (8 bytes) */
+    void decodeBc3AlphaBlock(const uint8_t *b, uint8_t *dst, size_t dstStride)
+    {
+        int a[8];
+        a[0] = b[0];
+        a[1] = b[1];
+        if (a[0] > a[1])
+        {
+            for (int k = 1; k < 7; k++)
+            {
+                a[k + 1] = ((7 - k) * a[0] + k * a[1]) / 7;
+            }
+        }
+        else
+        {
+            for (int k = 1; k < 5; k++)
+            {
+                a[k + 1] = ((5 - k) * a[0] + k * a[1]) / 5;
+            }
+            a[6] = 0;
+            a[7] = 255;
+        }
+        uint64_t bits = 0;
+        for (int i = 7; i >= 2; i--)
+        {
+            bits = (bits << 8) | b[i];
+        }
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                dst[y * dstStride + x * 4 + 3] = (uint8_t)a[(bits >> (3 * (y * 4 + x))) & 7];
+            }
+        }
+    }
+
+    /* decodes a compressed image of width x height pixels to RGBA */
+    bool decodeImage(const BlockFormat &fmt, const std::vector<uint8_t> &src, GLsizei width, GLsizei height, std::vector<uint8_t> &dst)
+    {
+        size_t blocksX = ((size_t)width + 3) / 4;
+        size_t blocksY = ((size_t)height + 3) / 4;
+        if (src.size() < blocksX * blocksY * fmt.blockSize)
+        {
+            return false;
+        }
+
+        // blocks are decoded to a buffer of whole blocks, and cropped afterwards
+        size_t stride = blocksX * 16;
+        std::vector<uint8_t> blocks(stride * blocksY * 4, 255);
+        const uint8_t *b = src.data();
+        for (size_t by = 0; by < blocksY; by++)
+        {
+            for (size_t bx = 0; bx < blocksX; bx++, b += fmt.blockSize)
+            {
+                uint8_t *px = blocks.data() + by * 4 * stride + bx * 16;
+                switch (fmt.codec)
+                {
+                case BlockCodec::ETC2_RGB:
+                    decodeEtc2ColorBlock(b, px, stride);
+                    break;
+                case BlockCodec::ETC2_RGBA:
+                    decodeEacAlphaBlock(b, px, stride);
+                    decodeEtc2ColorBlock(b + 8, px, stride);
+                    break;
+                case BlockCodec::BC1:
+                    decodeBc1Block(b, px, stride, false, false);
+                    break;
+                case BlockCodec::BC1_ALPHA:
+                    decodeBc1Block(b, px, stride, true, false);
+                    break;
+                case BlockCodec::BC2:
+                    decodeBc2AlphaBlock(b, px, stride);
+                    decodeBc1Block(b + 8, px, stride, false, true);
+                    break;
+                case BlockCodec::BC3:
+                    decodeBc3AlphaBlock(b, px, stride);
+                    decodeBc1Block(b + 8, px, stride, false, true);
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+
+        dst.resize((size_t)width * (size_t)height * 4);
+        for (GLsizei y = 0; y < height; y++)
+        {
+            std::memcpy(dst.data() + (size_t)y * width * 4, blocks.data() + (size_t)y * stride, (size_t)width * 4);
+        }
+        return true;
+    }
+} // namespace
+
+namespace yourgame
+{
+    namespace gl
+    {
+        bool TextureData::canDecompress() const
+        {
+            return getBlockFormat(internalFormat).codec != BlockCodec::NONE;
+        }
+
+        bool TextureData::decompress()
+        {
+            if (!isCompressed())
+            {
+                return true;
+            }
+
+            BlockFormat fmt = getBlockFormat(internalFormat);
+            if (fmt.codec == BlockCodec::NONE)
+            {
+                return false;
+            }
+
+            std::vector<Level> decoded = levels;
+            for (auto &level : decoded)
+            {
+                for (auto &face : level.faces)
+                {
+                    std::vector<uint8_t> rgba;
+                    if (!decodeImage(fmt, face, level.width, level.height, rgba))
+                    {
+                        return false;
+                    }
+                    face.swap(rgba);
+                }
+            }
+
+            levels.swap(decoded);
+            internalFormat = fmt.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+            format = GL_RGBA;
+            type = GL_UNSIGNED_BYTE;
+            return true;
+        }
+
+        size_t TextureData::getNumBytes() const
+        {
+            size_t numBytes = 0;
+            for (const auto &level : levels)
+            {
+                for (const auto &face : level.faces)
+                {
+                    numBytes += face.size();
+                }
+            }
+            return numBytes;
+        }
+    } // namespace gl
+} // namespace yourgame
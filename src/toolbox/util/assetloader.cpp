@@ -0,0 +1,465 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <unordered_map>
+#include <utility>
+#include "yourgame/log.h"
+#include "yourgame/gl/shader.h"
+#include "yourgame/util/assetloader.h"
+#include "yourgame_internal/worker.h"
+
+namespace yourgame
+{
+    namespace util
+    {
+        struct AssetLoader::State
+        {
+            struct Node
+            {
+                AssetId id;
+                std::string name;     // readable, for the log (AssetIds of literals have no name)
+                std::string filename; // of the typed assets, for the log
+                std::function<bool()> work;
+                std::function<bool(AssetManager &)> make;
+                std::function<size_t(yourgame::gl::ShaderBatch &)> submit; // instead of make, for shaders
+                std::vector<std::string> dependencies;
+                std::vector<size_t> dependents;
+                size_t numDependenciesPending = 0;
+                bool workDone = false;
+                bool workOk = false;
+                bool submitted = false;
+                bool done = false;
+
+                std::string label() const
+                {
+                    return filename.empty() ? name : name + " (" + filename + ")";
+                }
+            };
+
+            AssetManager *manager;
+            std::vector<Node> nodes;
+            Progress progress;
+            std::function<void(const Progress &)> onProgress;
+            std::unique_ptr<yourgame::gl::ShaderBatch> shaderBatch;
+            std::unordered_map<size_t, size_t> shaderNodes; // node per shader batch index
+            // queried on the main thread by start() (if there are textures), before any work stage runs
+            std::shared_ptr<std::vector<GLint>> compressedTextureFormats = std::make_shared<std::vector<GLint>>();
+            bool hasTextures = false;
+            bool started = false;
+            bool cancelled = false;
+            bool pollQueued = false;
+
+            /* adds a node, nullptr if already started */
+            Node *addNode(const std::string &name,
+                          std::function<bool()> work,
+                          std::function<bool(AssetManager &)> make,
+                          const std::vector<std::string> &dependencies)
+            {
+                if (started)
+                {
+                    yourgame::log::error("AssetLoader::add(): already started, %v is not loaded", name);
+                    return nullptr;
+                }
+
+                Node node;
+                node.id = AssetId(name);
+                node.name = name;
+                node.work = work;
+                node.make = make;
+                node.dependencies = dependencies;
+                nodes.push_back(std::move(node));
+                return &nodes.back();
+            }
+
+            /* marks node i as done, and its dependents as failed, if it failed */
+            void finish(size_t i, bool ok)
+            {
+                std::vector<std::pair<size_t, bool>> toFinish = {{i, ok}};
+                while (!toFinish.empty())
+                {
+                    size_t n = toFinish.back().first;
+                    bool nodeOk = toFinish.back().second;
+                    toFinish.pop_back();
+
+                    Node &node = nodes[n];
+                    if (node.done)
+                    {
+                        continue;
+                    }
+                    node.done = true;
+                    node.work = nullptr;
+                    node.make = nullptr;
+                    node.submit = nullptr;
+
+                    progress.numDone++;
+                    if (!nodeOk)
+                    {
+                        progress.numFailed++;
+                        yourgame::log::error("AssetLoader: failed to load %v", node.label());
+                    }
+
+                    for (auto d : node.dependents)
+                    {
+                        if (nodeOk)
+                        {
+                            nodes[d].numDependenciesPending--;
+                        }
+                        else
+                        {
+                            toFinish.push_back(std::make_pair(d, false));
+                        }
+                    }
+
+                    if (onProgress)
+                    {
+                        onProgress(progress);
+                    }
+                }
+            }
+
+            /* runs the make stages of the ready nodes and finishes compiled shaders, until nothing is left to do */
+            void update(const std::shared_ptr<State> &self)
+            {
+                bool changed = true;
+                while (changed && !cancelled)
+                {
+                    changed = false;
+                    for (size_t i = 0; i < nodes.size(); i++)
+                    {
+                        Node &node = nodes[i];
+                        if (node.done || node.submitted || !node.workDone || node.numDependenciesPending > 0)
+                        {
+                            continue;
+                        }
+
+                        if (!node.workOk)
+                        {
+                            finish(i, false);
+                        }
+                        else if (node.submit)
+                        {
+                            shaderNodes[node.submit(*shaderBatch)] = i;
+                            node.submitted = true;
+                        }
+                        else
+                        {
+                            finish(i, node.make(*manager));
+                        }
+                        changed = true;
+                    }
+
+                    if (shaderBatch->numPending() > 0)
+                    {
+                        shaderBatch->poll([this, &changed](size_t index, yourgame::gl::Shader *shader, const std::string &errorLog)
+                                          {
+                                              size_t i = shaderNodes[index];
+                                              if (!shader)
+                                              {
+                                                  yourgame::log::error("shader failed to make: %v", errorLog);
+                                              }
+                                              finish(i, manager->insert(nodes[i].id, shader));
+                                              changed = true; });
+                    }
+                }
+
+                // programs still compiling are polled again in the next tick
+                if (!cancelled && !pollQueued && shaderBatch->numPending() > 0)
+                {
+                    pollQueued = true;
+                    yourgame_internal::worker::postToMain([self]()
+                                                          {
+                                                              self->pollQueued = false;
+                                                              self->update(self); });
+                }
+            }
+        };
+
+        AssetLoader::AssetLoader(AssetManager &manager) : m_state(std::make_shared<State>())
+        {
+            m_state->manager = &manager;
+            m_state->shaderBatch.reset(new yourgame::gl::ShaderBatch());
+        }
+
+        AssetLoader::~AssetLoader()
+        {
+            // queued stages keep the state, but do not touch the manager anymore.
+            // unfinished programs are deleted here, on the main thread
+            m_state->cancelled = true;
+            m_state->onProgress = nullptr;
+            m_state->shaderBatch.reset();
+        }
+
+        void AssetLoader::add(const std::string &name,
+                              std::function<bool()> work,
+                              std::function<bool(AssetManager &)> make,
+                              const std::vector<std::string> &dependencies)
+        {
+            m_state->addNode(name, work, make, dependencies);
+        }
+
+        void AssetLoader::addGeometry(const std::string &name,
+                                      const std::string &objFilename,
+                                      const std::string &mtlFilename,
+                                      const yourgame::gl::MeshProcessing &processing,
+                                      const std::vector<std::string> &dependencies)
+        {
+            auto data = std::make_shared<yourgame::gl::MeshData>();
+            AssetId id(name);
+            State::Node *node = m_state->addNode(
+                name,
+                [data, objFilename, mtlFilename, processing]()
+                {
+                    if (yourgame::gl::loadMeshData(objFilename, mtlFilename, *data) != 0)
+                    {
+                        return false;
+                    }
+                    data->process(processing);
+                    return true;
+                },
+                [data, id](AssetManager &manager)
+                { return manager.insert(id, yourgame::gl::makeGeometry(*data)); },
+                dependencies);
+            if (node)
+            {
+                node->filename = objFilename;
+            }
+        }
+
+        void AssetLoader::addTexture(const std::string &name,
+                                     const std::string &imgFilename,
+                                     const std::string &atlasFilename,
+                                     const yourgame::gl::TextureConfig &cfg,
+                                     const std::vector<std::string> &dependencies)
+        {
+            struct TextureAndAtlas
+            {
+                yourgame::gl::TextureData texture;
+                yourgame::gl::AtlasData atlas;
+            };
+            auto data = std::make_shared<TextureAndAtlas>();
+            auto formats = m_state->compressedTextureFormats;
+            AssetId id(name);
+            State::Node *node = m_state->addNode(
+                name,
+                [data, formats, imgFilename, atlasFilename, cfg]()
+                {
+                    // decompressed here, if needed, not by makeTexture() on the main thread
+                    if (yourgame::gl::loadTextureData(imgFilename, data->texture, true, cfg.premultiplyAlpha) != 0 ||
+                        !yourgame::gl::makeUploadable(data->texture, *formats))
+                    {
+                        return false;
+                    }
+                    if (atlasFilename != "")
+                    {
+                        // frames read before a failure are inserted as well, like loadTexture() does
+                        yourgame::gl::loadAtlasData(imgFilename, atlasFilename, data->atlas);
+                    }
+                    return true;
+                },
+                [data, id, cfg](AssetManager &manager)
+                {
+                    yourgame::gl::Texture *texture = yourgame::gl::makeTexture(data->texture, cfg);
+                    if (texture)
+                    {
+                        texture->insertAtlas(data->atlas);
+                    }
+                    return manager.insert(id, texture);
+                },
+                dependencies);
+            if (node)
+            {
+                node->filename = imgFilename;
+                m_state->hasTextures = true;
+            }
+        }
+
+        void AssetLoader::addShader(const std::string &name,
+                                    const std::vector<std::pair<GLenum, std::string>> &shaderFilenames,
+                                    const std::vector<std::string> &defines,
+                                    const std::vector<std::pair<GLuint, std::string>> &attrLocs,
+                                    const std::vector<std::pair<GLuint, std::string>> &fragDataLocs,
+                                    const std::vector<std::string> &dependencies)
+        {
+            auto shaderCodes = std::make_shared<std::vector<std::pair<GLenum, std::string>>>();
+            State::Node *node = m_state->addNode(
+                name,
+                [shaderCodes, shaderFilenames, defines]()
+                {
+                    const std::string prologue = yourgame::gl::getShaderPrologue(defines);
+                    for (const auto &shdrFile : shaderFilenames)
+                    {
+                        std::string shdrStr;
+                        if (yourgame::gl::loadShaderSource(shdrFile.second, shdrStr) != 0)
+                        {
+                            return false;
+                        }
+                        shaderCodes->push_back(std::make_pair(shdrFile.first, prologue + shdrStr));
+                    }
+                    return true;
+                },
+                nullptr,
+                dependencies);
+            if (!node)
+            {
+                return;
+            }
+            node->submit = [shaderCodes, attrLocs, fragDataLocs](yourgame::gl::ShaderBatch &batch)
+            {
+                return batch.submit(*shaderCodes, attrLocs, fragDataLocs);
+            };
+            for (const auto &shdrFile : shaderFilenames)
+            {
+                node->filename += (node->filename.empty() ? "" : ", ") + shdrFile.second;
+            }
+        }
+
+        void AssetLoader::start(std::function<void(const Progress &)> onProgress, int priority)
+        {
+            auto &state = *m_state;
+            if (state.started)
+            {
+                return;
+            }
+            state.started = true;
+            state.onProgress = onProgress;
+            if (state.hasTextures)
+            {
+                *state.compressedTextureFormats = yourgame::gl::getCompressedTextureFormats();
+            }
+            state.progress.numAssets = state.nodes.size();
+
+            std::unordered_map<AssetId, std::vector<size_t>> nodesByName;
+            for (size_t i = 0; i < state.nodes.size(); i++)
+            {
+                nodesByName[state.nodes[i].id].push_back(i);
+            }
+
+            std::vector<size_t> unknown;
+            for (size_t i = 0; i < state.nodes.size(); i++)
+            {
+                for (const auto &dep : state.nodes[i].dependencies)
+                {
+                    auto found = nodesByName.find(AssetId(dep));
+                    if (found == nodesByName.end())
+                    {
+                        yourgame::log::error("AssetLoader: unknown dependency %v of %v", dep, state.nodes[i].label());
+                        unknown.push_back(i);
+                        continue;
+                    }
+                    for (auto d : found->second)
+                    {
+                        state.nodes[d].dependents.push_back(i);
+                        state.nodes[i].numDependenciesPending++;
+                    }
+                }
+            }
+
+            // nodes not reached by a topological sort are part of (or depend on) a cycle
+            {
+                std::vector<size_t> numPending(state.nodes.size());
+                std::vector<size_t> ready;
+                for (size_t i = 0; i < state.nodes.size(); i++)
+                {
+                    numPending[i] = state.nodes[i].numDependenciesPending;
+                    if (numPending[i] == 0)
+                    {
+                        ready.push_back(i);
+                    }
+                }
+                std::vector<bool> reached(state.nodes.size(), false);
+                while (!ready.empty())
+                {
+                    size_t i = ready.back();
+                    ready.pop_back();
+                    reached[i] = true;
+                    for (auto d : state.nodes[i].dependents)
+                    {
+                        if (--numPending[d] == 0)
+                        {
+                            ready.push_back(d);
+                        }
+                    }
+                }
+                for (size_t i = 0; i < state.nodes.size(); i++)
+                {
+                    if (!reached[i])
+                    {
+                        yourgame::log::error("AssetLoader: dependency cycle at %v", state.nodes[i].label());
+                        unknown.push_back(i);
+                    }
+                }
+            }
+
+            for (auto i : unknown)
+            {
+                state.finish(i, false);
+            }
+
+            std::shared_ptr<State> self = m_state;
+            for (size_t i = 0; i < state.nodes.size(); i++)
+            {
+                State::Node &node = state.nodes[i];
+                if (node.done)
+                {
+                    continue;
+                }
+                if (!node.work)
+                {
+                    node.workDone = true;
+                    node.workOk = true;
+                    continue;
+                }
+
+                // the job keeps its own copy of the work stage, the state is touched on the main thread only
+                auto work = node.work;
+                yourgame_internal::worker::post([self, i, work]()
+                                                {
+                                                    bool ok = work();
+                                                    yourgame_internal::worker::postToMain([self, i, ok]()
+                                                                                          {
+                                                                                              if (self->cancelled)
+                                                                                              {
+                                                                                                  return;
+                                                                                              }
+                                                                                              self->nodes[i].workDone = true;
+                                                                                              self->nodes[i].workOk = ok;
+                                                                                              self->update(self); }); },
+                                                priority);
+            }
+
+            state.update(self);
+        }
+
+        AssetLoader::Progress AssetLoader::wait()
+        {
+            start();
+            while (!m_state->progress.finished())
+            {
+                yourgame_internal::worker::waitForMain();
+                yourgame_internal::worker::tick();
+            }
+            return m_state->progress;
+        }
+
+        AssetLoader::Progress AssetLoader::getProgress() const
+        {
+            return m_state->progress;
+        }
+    } // namespace util
+} // namespace yourgame
@@ -17,6 +17,7 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include "yourgame/util/assetloader.h"
 #include "yourgame/util/assetmanager.h"
 #include "yourgame/gl/loading.h"
 
@@ -30,31 +31,30 @@ namespace yourgame_internal
 
             bool loadStockAssets()
             {
-                bool ret = true;
+                // file I/O and decoding in parallel, GL objects on this thread
+                yourgame::util::AssetLoader loader(manager);
 
                 // Geometry
-                ret = ret && manager.insert("geoQuad", yourgame::gl::loadGeometry("a//yg_quad.obj"));
-                ret = ret && manager.insert("geoGrid", yourgame::gl::loadGeometry("a//yg_grid.obj"));
+                loader.addGeometry("geoQuad", "a//yg_quad.obj");
+                loader.addGeometry("geoGrid", "a//yg_grid.obj");
 
-                ret = ret && manager.insert("sphereInside", yourgame::gl::loadGeometry("a//yg_sphere_inside.obj"));
-                ret = ret && manager.insert("cubeInside", yourgame::gl::loadGeometry("a//yg_cube_inside.obj"));
+                loader.addGeometry("sphereInside", "a//yg_sphere_inside.obj");
+                loader.addGeometry("cubeInside", "a//yg_cube_inside.obj");
 
                 // Shaders
-                ret = ret && manager.insert("shaderPostNull", yourgame::gl::loadShader(
-                                                                  {{GL_VERTEX_SHADER, "a//yg_post.vert"},
-                                                                   {GL_FRAGMENT_SHADER, "a//yg_post_null.frag"}}));
+                loader.addShader("shaderPostNull", {{GL_VERTEX_SHADER, "a//yg_post.vert"},
+                                                    {GL_FRAGMENT_SHADER, "a//yg_post_null.frag"}});
 
-                ret = ret && manager.insert("shaderSprite", yourgame::gl::loadShader(
-                                                                {{GL_VERTEX_SHADER, "a//yg_sprite.vert"},
-                                                                 {GL_FRAGMENT_SHADER, "a//yg_sprite.frag"}}));
+                loader.addShader("shaderSprite", {{GL_VERTEX_SHADER, "a//yg_sprite.vert"},
+                                                  {GL_FRAGMENT_SHADER, "a//yg_sprite.frag"}});
 
-                ret = ret && manager.insert("ambientTexture", yourgame::gl::loadShader(
-                                                                  {{GL_VERTEX_SHADER, "a//yg_tex.vert"},
-                                                                   {GL_FRAGMENT_SHADER, "a//yg_ambienttex.frag"}}));
+                loader.addShader("ambientTexture", {{GL_VERTEX_SHADER, "a//yg_tex.vert"},
+                                                    {GL_FRAGMENT_SHADER, "a//yg_ambienttex.frag"}});
 
-                ret = ret && manager.insert("ambientCubemap", yourgame::gl::loadShader(
-                                                                  {{GL_VERTEX_SHADER, "a//yg_pos.vert"},
-                                                                   {GL_FRAGMENT_SHADER, "a//yg_ambientcube.frag"}}));
+                loader.addShader("ambientCubemap", {{GL_VERTEX_SHADER, "a//yg_pos.vert"},
+                                                    {GL_FRAGMENT_SHADER, "a//yg_ambientcube.frag"}});
+
+                bool ret = (loader.wait().numFailed == 0);
 
                 if (!ret)
                 {
@@ -31,7 +31,8 @@ namespace yourgame
                                         bool flipVertically,
                                         Layout layoutDst)
         {
-            stbi_set_flip_vertically_on_load(flipVertically);
+            // per thread, as images are decoded on worker threads as well
+            stbi_set_flip_vertically_on_load_thread(flipVertically);
 
             int width;
             int height;
@@ -43,7 +44,7 @@ namespace yourgame
                                              &numChannels,
                                              Image::getNumChannelsFromLayout(layoutDst));
 
-            stbi_set_flip_vertically_on_load(false);
+            stbi_set_flip_vertically_on_load_thread(false);
 
             if (img)
             {
@@ -130,17 +131,17 @@ namespace yourgame
                 return;
             }
 
-            unsigned int numPixels = m_width * m_height;
+            size_t numPixels = (size_t)m_width * (size_t)m_height;
+            uint8_t *px = m_data.data();
 
-            for (unsigned int i = 0; i < numPixels; i++)
+            // (c * alpha) / 255 without division: for t <= 255 * 255,
+            // t / 255 == ((t + 1) * 257) >> 16. branch-free, to be vectorized by the compiler
+            for (size_t i = 0; i < numPixels; i++, px += 4)
             {
-                auto rIdx = i * 4;
-                auto gIdx = i * 4 + 1;
-                auto bIdx = i * 4 + 2;
-                auto alpha = m_data.data()[rIdx + 3];
-                m_data.data()[rIdx] = (m_data.data()[rIdx] * alpha) / 255;
-                m_data.data()[gIdx] = (m_data.data()[gIdx] * alpha) / 255;
-                m_data.data()[bIdx] = (m_data.data()[bIdx] * alpha) / 255;
+                uint32_t alpha = px[3];
+                px[0] = (uint8_t)(((px[0] * alpha + 1U) * 257U) >> 16);
+                px[1] = (uint8_t)(((px[1] * alpha + 1U) * 257U) >> 16);
+                px[2] = (uint8_t)(((px[2] * alpha + 1U) * 257U) >> 16);
             }
         }
 
@@ -0,0 +1,301 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm> // std::push_heap(), std::pop_heap()
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "yourgame/log.h"
+#include "yourgame_internal/worker.h"
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define YOURGAME_WORKER_THREADS
+#endif
+
+namespace yourgame_internal
+{
+    namespace worker
+    {
+        namespace
+        {
+            struct Job
+            {
+                std::function<void()> fn;
+                int priority;
+                uint64_t seq;
+            };
+
+            // heap order: highest priority first, then lowest sequence number (FIFO)
+            bool jobLess(const Job &a, const Job &b)
+            {
+                return (a.priority < b.priority) || (a.priority == b.priority && a.seq > b.seq);
+            }
+
+            std::mutex jobMutex;
+            std::condition_variable jobCv;
+            std::condition_variable idleCv;
+            std::vector<Job> jobs; // heap, see jobLess()
+            uint64_t jobSeq = 0;
+            size_t jobsRunning = 0;
+            bool stopping = false;
+            std::vector<std::thread> threads;
+
+            std::mutex mainMutex;
+            std::condition_variable mainCv;
+            std::deque<std::function<void()>> mainQueue;
+
+            // pops the next job. requires jobMutex to be locked
+            std::function<void()> popJob()
+            {
+                std::pop_heap(jobs.begin(), jobs.end(), jobLess);
+                std::function<void()> fn = std::move(jobs.back().fn);
+                jobs.pop_back();
+                return fn;
+            }
+
+#ifdef YOURGAME_WORKER_THREADS
+            /* jobs of runAndWait(), claimed one by one by the caller and by helper jobs */
+            struct Batch
+            {
+                std::vector<std::function<void()>> *jobs;
+                size_t size;
+                std::atomic<size_t> next{0};
+                size_t numDone = 0;
+                std::mutex doneMutex;
+                std::condition_variable doneCv;
+            };
+
+            // runs unclaimed jobs of batch, until there are none left. jobs is only accessed
+            // for claimed jobs: the caller of runAndWait() waits for them, keeping jobs alive
+            void runBatch(const std::shared_ptr<Batch> &batch)
+            {
+                size_t i;
+                while ((i = batch->next++) < batch->size)
+                {
+                    (*batch->jobs)[i]();
+
+                    std::lock_guard<std::mutex> lock(batch->doneMutex);
+                    batch->numDone++;
+                    batch->doneCv.notify_all();
+                }
+            }
+
+            void workerLoop()
+            {
+                while (true)
+                {
+                    std::function<void()> fn;
+                    {
+                        std::unique_lock<std::mutex> lock(jobMutex);
+                        jobCv.wait(lock, []
+                                   { return stopping || !jobs.empty(); });
+                        // remaining jobs are finished before stopping
+                        if (jobs.empty())
+                        {
+                            return;
+                        }
+                        fn = popJob();
+                        jobsRunning++;
+                    }
+
+                    fn();
+
+                    {
+                        std::lock_guard<std::mutex> lock(jobMutex);
+                        jobsRunning--;
+                    }
+                    idleCv.notify_all();
+                }
+            }
+
+            // requires jobMutex to be locked
+            void startThreads()
+            {
+                if (!threads.empty())
+                {
+                    return;
+                }
+
+                // leave one core to the main thread
+                unsigned int numThreads = std::thread::hardware_concurrency();
+                numThreads = (numThreads > 1) ? (numThreads - 1) : 1;
+                numThreads = std::min(numThreads, 8U);
+
+                stopping = false;
+                for (unsigned int i = 0; i < numThreads; i++)
+                {
+                    threads.emplace_back(workerLoop);
+                }
+
+                yourgame::log::debug("worker: started %v thread(s)", numThreads);
+            }
+#else
+            // runs the next pending job on the calling (main) thread
+            bool runOneJob()
+            {
+                if (jobs.empty())
+                {
+                    return false;
+                }
+                std::function<void()> fn = popJob();
+                fn();
+                return true;
+            }
+#endif
+        } // namespace
+
+        void post(std::function<void()> job, int priority)
+        {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+#ifdef YOURGAME_WORKER_THREADS
+                startThreads();
+#endif
+                jobs.push_back({std::move(job), priority, jobSeq++});
+                std::push_heap(jobs.begin(), jobs.end(), jobLess);
+            }
+            jobCv.notify_one();
+        }
+
+        void runAndWait(std::vector<std::function<void()>> &jobs, int priority)
+        {
+#ifdef YOURGAME_WORKER_THREADS
+            if (jobs.empty())
+            {
+                return;
+            }
+
+            // the calling thread runs jobs as well: even if all worker threads are blocked in
+            // runAndWait() (nested, from within worker jobs), every batch makes progress
+            auto batch = std::make_shared<Batch>();
+            batch->jobs = &jobs;
+            batch->size = jobs.size();
+            for (size_t i = 1; i < jobs.size(); i++)
+            {
+                post([batch]()
+                     { runBatch(batch); },
+                     priority);
+            }
+            runBatch(batch);
+
+            // jobs claimed by helpers might still be running
+            std::unique_lock<std::mutex> lock(batch->doneMutex);
+            batch->doneCv.wait(lock, [&batch]
+                               { return batch->numDone == batch->size; });
+#else
+            for (auto &job : jobs)
+            {
+                job();
+            }
+#endif
+        }
+
+        void postToMain(std::function<void()> fn)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mainMutex);
+                mainQueue.push_back(std::move(fn));
+            }
+            mainCv.notify_all();
+        }
+
+        void tick()
+        {
+#ifndef YOURGAME_WORKER_THREADS
+            while (runOneJob())
+            {
+            }
+#endif
+
+            // functions queued while running these are run in the next tick()
+            std::deque<std::function<void()>> fns;
+            {
+                std::lock_guard<std::mutex> lock(mainMutex);
+                fns.swap(mainQueue);
+            }
+
+            for (auto &fn : fns)
+            {
+                fn();
+            }
+        }
+
+        void waitForMain()
+        {
+#ifdef YOURGAME_WORKER_THREADS
+            std::unique_lock<std::mutex> lock(mainMutex);
+            mainCv.wait_for(lock, std::chrono::milliseconds(10), []
+                            { return !mainQueue.empty(); });
+#else
+            runOneJob();
+#endif
+        }
+
+        void waitIdle()
+        {
+#ifdef YOURGAME_WORKER_THREADS
+            std::unique_lock<std::mutex> lock(jobMutex);
+            idleCv.wait(lock, []
+                        { return jobs.empty() && jobsRunning == 0; });
+#else
+            while (runOneJob())
+            {
+            }
+#endif
+        }
+
+        size_t getNumThreads()
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            return threads.size();
+        }
+
+        void shutdown()
+        {
+#ifdef YOURGAME_WORKER_THREADS
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                stopping = true;
+            }
+            jobCv.notify_all();
+
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+            threads.clear();
+#else
+            while (runOneJob())
+            {
+            }
+#endif
+
+            std::lock_guard<std::mutex> lock(mainMutex);
+            mainQueue.clear();
+        }
+    } // namespace worker
+} // namespace yourgame_internal
@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <string>
+#include <unordered_map>
+#include "doctest.h"
+#include "yourgame/assetid.h"
+
+using yourgame::AssetId;
+using namespace yourgame::literals;
+
+// evaluated at compile time
+static_assert("ship"_id == AssetId("ship"), "AssetId literal mismatch");
+static_assert(AssetId("ship") != AssetId("shi"), "AssetId collision");
+static_assert(AssetId("").value() == 14695981039346656037ULL, "AssetId of empty string is not the FNV offset");
+
+TEST_CASE("AssetId")
+{
+    SUBCASE("compile_time_vs_run_time")
+    {
+        std::string name = "sprites/ship_01";
+        CHECK(AssetId(name) == "sprites/ship_01"_id);
+        CHECK(AssetId(name) == AssetId(name.c_str()));
+        CHECK(AssetId(name) != AssetId(std::string("sprites/ship_02")));
+
+        // FNV-1a reference value
+        CHECK(AssetId("a").value() == 0xaf63dc4c8601ec8cULL);
+    }
+
+    SUBCASE("hash_map_key")
+    {
+        std::unordered_map<AssetId, int> map;
+        map[std::string("ship")] = 1;
+        map["rock"_id] = 2;
+        CHECK(map.at("ship"_id) == 1);
+        CHECK(map.at(std::string("rock")) == 2);
+        CHECK(map.find("tree"_id) == map.end());
+    }
+
+    SUBCASE("name")
+    {
+        // names are recorded in debug builds only
+        AssetId id(std::string("recorded_name"));
+#ifndef NDEBUG
+        CHECK(id.name() == "recorded_name");
+#endif
+        CHECK(AssetId::fromValue(0x1234).name() == "#0000000000001234");
+    }
+}
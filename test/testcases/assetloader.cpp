@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <atomic>
+#include <string>
+#include <vector>
+#include "doctest.h"
+#include "yourgame/file.h"
+#include "yourgame/util/assetloader.h"
+
+namespace
+{
+    struct Part
+    {
+        int value;
+        Part(int v) : value(v) {}
+    };
+
+    // make stage of an asset named name, valued by the sum of its dependencies (+1)
+    std::function<bool(yourgame::util::AssetManager &)> makePart(std::string name,
+                                                                 std::vector<std::string> deps,
+                                                                 std::vector<std::string> &order)
+    {
+        return [name, deps, &order](yourgame::util::AssetManager &manager)
+        {
+            int value = 1;
+            for (const auto &dep : deps)
+            {
+                Part *part = manager.get<Part>(dep);
+                if (!part)
+                {
+                    return false;
+                }
+                value += part->value;
+            }
+            order.push_back(name);
+            return manager.insert(name, new Part(value));
+        };
+    }
+} // namespace
+
+TEST_CASE("AssetLoader")
+{
+    yourgame::util::AssetManager manager;
+    std::vector<std::string> order;
+    std::atomic<int> numWorked(0);
+    auto work = [&numWorked]()
+    {
+        numWorked++;
+        return true;
+    };
+
+    SUBCASE("dependencies")
+    {
+        yourgame::util::AssetLoader loader(manager);
+        // added before their dependencies
+        loader.add("material", work, makePart("material", {"texture", "shader"}, order), {"texture", "shader"});
+        loader.add("texture", work, makePart("texture", {}, order));
+        loader.add("shader", nullptr, makePart("shader", {"common"}, order), {"common"});
+        loader.add("common", work, makePart("common", {}, order));
+
+        size_t numProgressCalls = 0;
+        loader.start([&numProgressCalls](const yourgame::util::AssetLoader::Progress &)
+                     { numProgressCalls++; });
+        auto progress = loader.wait();
+        CHECK(progress.finished());
+        CHECK(progress.numAssets == 4);
+        CHECK(progress.numDone == 4);
+        CHECK(progress.numFailed == 0);
+        CHECK(numProgressCalls == 4);
+        CHECK(numWorked == 3);
+
+        CHECK(order.size() == 4);
+        CHECK(order.back() == "material");
+        CHECK(manager.get<Part>("shader")->value == 2);
+        CHECK(manager.get<Part>("material")->value == 4);
+    }
+
+    SUBCASE("failures")
+    {
+        yourgame::util::AssetLoader loader(manager);
+        loader.add("broken", []()
+                   { return false; },
+                   makePart("broken", {}, order));
+        loader.add("user", work, makePart("user", {"broken"}, order), {"broken"});
+        loader.add("orphan", work, makePart("orphan", {"missing"}, order), {"missing"});
+        loader.add("cycleA", work, makePart("cycleA", {"cycleB"}, order), {"cycleB"});
+        loader.add("cycleB", work, makePart("cycleB", {"cycleA"}, order), {"cycleA"});
+        loader.add("fine", work, makePart("fine", {}, order));
+
+        auto progress = loader.wait();
+        CHECK(progress.finished());
+        CHECK(progress.numAssets == 6);
+        CHECK(progress.numFailed == 5);
+        CHECK(order.size() == 1);
+        CHECK(manager.numOf<Part>() == 1);
+        CHECK(manager.get<Part>("fine") != nullptr);
+    }
+
+    SUBCASE("readFiles_in_work_stages")
+    {
+        // more blocking work stages than worker threads: readFiles() must not wait for idle workers
+        std::atomic<int> numRead(0);
+        auto readWork = [&numRead]()
+        {
+            std::vector<std::vector<uint8_t>> data;
+            bool ok = yourgame::file::readFiles({"a//img_32_16_3.png", "a//img_32_16_4.png"}, data) == 0;
+            numRead += ok ? 1 : 0;
+            return ok;
+        };
+
+        yourgame::util::AssetLoader loader(manager);
+        const int numAssets = 32;
+        for (int i = 0; i < numAssets; i++)
+        {
+            std::string name = "read" + std::to_string(i);
+            loader.add(name, readWork, makePart(name, {}, order));
+        }
+
+        auto progress = loader.wait();
+        CHECK(progress.finished());
+        CHECK(progress.numDone == numAssets);
+        CHECK(progress.numFailed == 0);
+        CHECK(numRead == numAssets);
+    }
+}
@@ -17,6 +17,7 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <string>
 #include "doctest.h"
 #include "yourgame/util/assetmanager.h"
 
@@ -110,6 +111,17 @@ TEST_CASE("AssetManager")
         CHECK(assman.numOf<A>() == 0);
     }
 
+    SUBCASE("get() by AssetId")
+    {
+        using namespace yourgame::literals;
+        CHECK(assman.get<A>("A1"_id)->m_a == 1);
+        CHECK(assman.get<A>(std::string("A2"))->m_a == 2);
+        CHECK(assman.get<A>(yourgame::AssetId("A3"))->m_a == 3);
+        assman.destroy<A>("A3"_id);
+        CHECK(assman.get<A>("A3") == nullptr);
+        CHECK(A::numObj == 2);
+    }
+
     SUBCASE("same name")
     {
         CHECK(assman.insert<A>("Object", new A(1)));
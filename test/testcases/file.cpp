@@ -17,7 +17,12 @@ freely, subject to the following restrictions:
    misrepresented as being the original software.
 3. This notice may not be removed or altered from any source distribution.
 */
+#include <algorithm>
+#include <cstdio>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 #include "doctest.h"
 #include "yourgame/yourgame.h"
@@ -44,4 +49,383 @@ TEST_CASE("File")
         // make sure the file content is identical
         CHECK(data_zip == data_dir);
     }
+
+    SUBCASE("path_helpers")
+    {
+        CHECK(yg::file::getFileLocation("file1.bin") == "");
+        CHECK(yg::file::getFileLocation("a//file2.bin") == "a//");
+        CHECK(yg::file::getFileLocation("/home/user/file3.bin") == "/home/user/");
+
+        CHECK(yg::file::getFileName("file1.bin") == "file1.bin");
+        CHECK(yg::file::getFileName("a//file2.bin") == "file2.bin");
+        CHECK(yg::file::getFileName("/home/user/file3.bin") == "file3.bin");
+
+        CHECK(yg::file::getFileNameWithoutExtension("file1.bin") == "file1");
+        CHECK(yg::file::getFileNameWithoutExtension("a//file2.bin") == "file2");
+        CHECK(yg::file::getFileNameWithoutExtension("/home/user/file3.bin") == "file3");
+        CHECK(yg::file::getFileNameWithoutExtension("file4") == "file4");
+        CHECK(yg::file::getFileNameWithoutExtension(".file5") == ".file5");
+        CHECK(yg::file::getFileNameWithoutExtension("a//file6.tar.gz") == "file6");
+        CHECK(yg::file::getFileNameWithoutExtension("a//file7") == "file7");
+        CHECK(yg::file::getFileNameWithoutExtension("/home/user.a/file8.txt") == "file8");
+
+        CHECK(yg::file::getFileExtension("file1.bin") == "bin");
+        CHECK(yg::file::getFileExtension("a//texture.png") == "png");
+        CHECK(yg::file::getFileExtension(".gitignore") == "gitignore");
+        CHECK(yg::file::getFileExtension("Makefile") == "");
+    }
+
+    SUBCASE("readProjectFile_zip_opened_once")
+    {
+        std::vector<uint8_t> data;
+
+        yg::file::resetArchiveStats();
+        yg::file::setProjectPath(yg::file::getAssetFilePath("img.zip"));
+
+        CHECK(yg::file::getArchiveStats().opens == 1);
+
+        CHECK(yg::file::readFile("p//img_32_16_3.png", data) == 0);
+        CHECK(yg::file::readFile("p//img_32_16_4.png", data) == 0);
+        CHECK(yg::file::readFile("p//does_not_exist.png", data) != 0);
+
+        // all reads are served from the archive opened by setProjectPath()
+        auto stats = yg::file::getArchiveStats();
+        CHECK(stats.opens == 1);
+        CHECK(stats.lookups == 3);
+        CHECK(stats.misses == 1);
+
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+    }
+
+    SUBCASE("mapFile_vs_readFile")
+    {
+        // map and read the same file, from directory and from .zip
+        for (const auto &projectPath : {yg::file::getAssetFilePath(), yg::file::getAssetFilePath("img.zip")})
+        {
+            yg::file::setProjectPath(projectPath);
+
+            std::vector<uint8_t> data;
+            yg::file::FileView view;
+
+            CHECK(yg::file::readFile("p//img_32_16_4.png", data) == 0);
+            CHECK(yg::file::mapFile("p//img_32_16_4.png", view) == 0);
+
+            REQUIRE(view.size() == data.size());
+            CHECK(std::equal(data.begin(), data.end(), view.data()));
+
+            // moving transfers the content
+            yg::file::FileView moved = std::move(view);
+            CHECK(view.empty());
+            CHECK(moved.size() == data.size());
+        }
+
+        yg::file::FileView view;
+        CHECK(yg::file::mapFile("a//does_not_exist.png", view) != 0);
+
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+    }
+
+    SUBCASE("Stream_vs_readFile")
+    {
+        // stream and read the same file, from directory, .zip and bundle (deflated)
+        CHECK(yg::file::writeBundle("stream.ygb", {{"img_32_16_3.png", "a//img_32_16_3.png", true}}) == 0);
+        for (const auto &projectPath : {yg::file::getAssetFilePath(), yg::file::getAssetFilePath("img.zip"), std::string("stream.ygb")})
+        {
+            yg::file::setProjectPath(projectPath);
+
+            std::vector<uint8_t> data;
+            CHECK(yg::file::readFile("p//img_32_16_3.png", data) == 0);
+
+            std::unique_ptr<yg::file::Stream> stream(yg::file::Stream::open("p//img_32_16_3.png"));
+            REQUIRE(stream);
+            CHECK(stream->size() == data.size());
+
+            // read in small chunks
+            std::vector<uint8_t> streamed;
+            uint8_t chunk[7];
+            size_t numRead;
+            while ((numRead = stream->read(chunk, sizeof(chunk))) > 0)
+            {
+                streamed.insert(streamed.end(), chunk, chunk + numRead);
+            }
+            CHECK(stream->eof());
+            CHECK(streamed == data);
+
+            // seek backwards and forwards
+            REQUIRE(data.size() > 20);
+            CHECK(stream->seek(10) == 0);
+            CHECK(stream->tell() == 10);
+            CHECK(stream->read(chunk, sizeof(chunk)) == sizeof(chunk));
+            CHECK(std::equal(chunk, chunk + sizeof(chunk), data.begin() + 10));
+            CHECK(stream->seek(data.size() - 3) == 0);
+            CHECK(stream->read(chunk, sizeof(chunk)) == 3);
+            CHECK(stream->seek(data.size() + 1) != 0);
+        }
+
+        CHECK(yg::file::Stream::open("p//does_not_exist.png") == nullptr);
+
+        // deflated bundle entries larger than the inflate buffer
+        std::vector<uint8_t> big(200000);
+        for (size_t i = 0; i < big.size(); i++)
+        {
+            big[i] = static_cast<uint8_t>((i * i) >> 7);
+        }
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+        CHECK(yg::file::writeFile("p//stream_big.bin", big.data(), big.size()) == 0);
+        CHECK(yg::file::writeBundle("stream.ygb", {{"big.bin", "p//stream_big.bin", true}}) == 0);
+        std::remove(yg::file::getProjectFilePath("stream_big.bin").c_str());
+        yg::file::setProjectPath("stream.ygb");
+        {
+            std::unique_ptr<yg::file::Stream> stream(yg::file::Stream::open("p//big.bin"));
+            REQUIRE(stream);
+            std::vector<uint8_t> streamed;
+            std::vector<uint8_t> chunk(1000);
+            size_t numRead;
+            while ((numRead = stream->read(chunk.data(), chunk.size())) > 0)
+            {
+                streamed.insert(streamed.end(), chunk.begin(), chunk.begin() + numRead);
+            }
+            CHECK(streamed == big);
+            CHECK(stream->seek(100000) == 0);
+            CHECK(stream->read(chunk.data(), chunk.size()) == chunk.size());
+            CHECK(std::equal(chunk.begin(), chunk.end(), big.begin() + 100000));
+        }
+
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+        std::remove("stream.ygb");
+    }
+
+    SUBCASE("writeBundle_vs_dir")
+    {
+        std::vector<uint8_t> data_3;
+        std::vector<uint8_t> data_4;
+        CHECK(yg::file::readFile("a//img_32_16_3.png", data_3) == 0);
+        CHECK(yg::file::readFile("a//img_32_16_4.png", data_4) == 0);
+
+        // one stored, one deflated file
+        CHECK(yg::file::writeBundle("test.ygb", {{"img_32_16_3.png", "a//img_32_16_3.png", false},
+                                                 {"sub/img_32_16_4.png", "a//img_32_16_4.png", true}}) == 0);
+        CHECK(yg::file::writeBundle("test_dup.ygb", {{"a.png", "a//img_32_16_3.png"},
+                                                     {"A.png", "a//img_32_16_4.png"}}) != 0);
+
+        yg::file::setProjectPath("test.ygb");
+
+        std::vector<uint8_t> data;
+        CHECK(yg::file::readFile("p//img_32_16_3.png", data) == 0);
+        CHECK(data == data_3);
+        CHECK(yg::file::readFile("p//SUB/img_32_16_4.png", data) == 0);
+        CHECK(data == data_4);
+        CHECK(yg::file::readFile("p//img_32_16_4.png", data) != 0);
+
+        // directories are derived from the names
+        CHECK(yg::file::ls("p//", true) == std::vector<std::string>({"img_32_16_3.png", "sub/", "sub/img_32_16_4.png"}));
+        CHECK(yg::file::ls("p//sub/*.png") == std::vector<std::string>({"img_32_16_4.png"}));
+
+        // mapped views stay valid after the bundle is closed
+        yg::file::FileView view;
+        CHECK(yg::file::mapFile("p//img_32_16_3.png", view) == 0);
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+        REQUIRE(view.size() == data_3.size());
+        CHECK(std::equal(data_3.begin(), data_3.end(), view.data()));
+
+        // bundles can be mounted as overlays as well
+        CHECK(yg::file::mount("test.ygb", "a//") == 0);
+        std::unique_ptr<yg::file::Stream> stream(yg::file::Stream::open("a//sub/img_32_16_4.png"));
+        REQUIRE(stream);
+        CHECK(stream->size() == data_4.size());
+
+        stream.reset();
+        CHECK(yg::file::unmount("test.ygb", "a//") == 0);
+
+        // directories provided by several mounts are listed once
+        CHECK(yg::file::writeBundle("test_sub.ygb", {{"sub/deeper/img_32_16_3.png", "a//img_32_16_3.png"}}) == 0);
+        yg::file::setProjectPath("test.ygb");
+        CHECK(yg::file::mount("test.ygb", "p//") == 0);
+        CHECK(yg::file::mount("test_sub.ygb", "p//") == 0);
+        CHECK(yg::file::ls("p//sub/", true) == std::vector<std::string>({"deeper/", "deeper/img_32_16_3.png", "img_32_16_4.png"}));
+        CHECK(yg::file::unmount("test_sub.ygb", "p//") == 0);
+        CHECK(yg::file::unmount("test.ygb", "p//") == 0);
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+
+        std::remove("test_sub.ygb");
+        std::remove("test.ygb");
+    }
+
+    SUBCASE("writeFileAsync_coalesce")
+    {
+        yg::file::resetWriteStats();
+
+        std::vector<int> results;
+        auto cb = [&results](int result)
+        { results.push_back(result); };
+
+        // the first write may be started right away, the following ones are coalesced
+        for (uint8_t i = 0; i < 10; i++)
+        {
+            yg::file::writeFileAsync("p//write_async.bin", std::vector<uint8_t>(100, i), cb);
+        }
+        CHECK(yg::file::getWriteStats().pending >= 1);
+
+        yg::file::flushWrites();
+
+        auto stats = yg::file::getWriteStats();
+        CHECK(stats.pending == 0);
+        CHECK(stats.failed == 0);
+        CHECK(stats.written >= 1);
+        CHECK(stats.written + stats.coalesced == 10);
+        CHECK(stats.maxLatency >= stats.lastLatency);
+        CHECK(results.size() == 10);
+        CHECK(std::count(results.begin(), results.end(), 0) == 10);
+
+        // the latest data is written, without leftovers of the temporary file
+        std::vector<uint8_t> data;
+        CHECK(yg::file::readFile("p//write_async.bin", data) == 0);
+        CHECK(data == std::vector<uint8_t>(100, 9));
+        CHECK(yg::file::ls("p//write_async.bin.*").empty());
+
+        // a synchronous write racing an asynchronous one uses its own temporary file
+        yg::file::writeFileAsync("p//write_async.bin", std::vector<uint8_t>(100, 1));
+        CHECK(yg::file::writeFile("p//write_async.bin", std::vector<uint8_t>(200, 2).data(), 200) == 0);
+        yg::file::flushWrites();
+        CHECK(yg::file::readFile("p//write_async.bin", data) == 0);
+        CHECK((data == std::vector<uint8_t>(100, 1) || data == std::vector<uint8_t>(200, 2)));
+        CHECK(yg::file::ls("p//write_async.bin.*").empty());
+
+        std::remove(yg::file::getProjectFilePath("write_async.bin").c_str());
+    }
+
+    SUBCASE("ls_dir_vs_zip")
+    {
+        std::vector<std::string> pngs = {"img_32_16_3.png", "img_32_16_4.png"};
+        for (const auto &projectPath : {yg::file::getAssetFilePath(), yg::file::getAssetFilePath("img.zip")})
+        {
+            yg::file::setProjectPath(projectPath);
+            CHECK(yg::file::ls("p//*.png") == pngs);
+            CHECK(yg::file::ls("p//img_32_16_?.png") == pngs);
+            CHECK(yg::file::ls("p//*_4.*") == std::vector<std::string>({"img_32_16_4.png"}));
+            CHECK(yg::file::ls("p//*.jpg").empty());
+        }
+
+        // overlays are listed as well
+        CHECK(yg::file::mount(yg::file::getAssetFilePath(), "p//") == 0);
+        CHECK(yg::file::ls("p//*.zip") == std::vector<std::string>({"img.zip"}));
+        CHECK(yg::file::ls("p//*.png") == pngs);
+        CHECK(yg::file::unmount(yg::file::getAssetFilePath(), "p//") == 0);
+
+        // changes of directories are picked up
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+        CHECK(yg::file::ls("p//*.png") == pngs);
+        CHECK(yg::file::writeFile("p//ls_new.png", "x", 1) == 0);
+        CHECK(yg::file::ls("p//*.png").size() == 3);
+        std::remove(yg::file::getProjectFilePath("ls_new.png").c_str());
+        CHECK(yg::file::ls("p//*.png") == pngs);
+    }
+
+    SUBCASE("readFileAsync_priority")
+    {
+        std::vector<uint8_t> data;
+        CHECK(yg::file::readFile("a//img_32_16_4.png", data) == 0);
+
+        // with one read in flight at a time, queued reads are started by priority
+        yg::file::setAsyncReadLimit(1);
+
+        std::vector<std::string> order;
+        auto cb = [&order](yg::file::AsyncRead &read)
+        { order.push_back(read.filename); };
+
+        auto first = yg::file::readFileAsync("a//img_32_16_4.png", cb, 0);
+        auto low = yg::file::readFileAsync("a//img_32_16_3.png", cb, 0);
+        auto high = yg::file::readFileAsync("a//does_not_exist.png", cb, 10);
+
+        CHECK(yg::file::getNumAsyncReadsPending() == 3);
+
+        yg::file::waitAsyncReads();
+
+        CHECK(yg::file::getNumAsyncReadsPending() == 0);
+        REQUIRE(order.size() == 3);
+        CHECK(order[0] == "a//img_32_16_4.png");
+        CHECK(order[1] == "a//does_not_exist.png");
+        CHECK(order[2] == "a//img_32_16_3.png");
+
+        CHECK(first->done);
+        CHECK(first->result == 0);
+        CHECK(first->data == data);
+        CHECK(high->result != 0);
+
+        yg::file::setAsyncReadLimit(16);
+    }
+
+    SUBCASE("readFiles_vs_readFile")
+    {
+        std::vector<std::string> filenames = {"p//img_32_16_4.png",
+                                              "a//img_32_16_3.png",
+                                              "p//does_not_exist.png",
+                                              "p//img_32_16_3.png"};
+
+        // read the same files in a batch, from .zip and from directory
+        for (const auto &projectPath : {yg::file::getAssetFilePath("img.zip"), yg::file::getAssetFilePath()})
+        {
+            yg::file::setProjectPath(projectPath);
+
+            std::vector<std::vector<uint8_t>> data;
+            std::vector<int> results;
+            CHECK(yg::file::readFiles(filenames, data, &results) == 1);
+
+            REQUIRE(data.size() == filenames.size());
+            REQUIRE(results.size() == filenames.size());
+            for (size_t i = 0; i < filenames.size(); i++)
+            {
+                std::vector<uint8_t> single;
+                int ret = yg::file::readFile(filenames[i], single);
+                CHECK((ret == 0) == (results[i] == 0));
+                CHECK(data[i] == single);
+            }
+        }
+    }
+
+    SUBCASE("mount_overlay")
+    {
+        std::vector<uint8_t> data_3;
+        std::vector<uint8_t> data_4;
+        std::vector<uint8_t> data;
+        CHECK(yg::file::readFile("a//img_32_16_3.png", data_3) == 0);
+        CHECK(yg::file::readFile("a//img_32_16_4.png", data_4) == 0);
+
+        // the project directory is empty (no such files)
+        yg::file::setProjectPath(yg::file::getAssetFilePath("does_not_exist"));
+        CHECK(yg::file::readFile("p//img_32_16_3.png", data) != 0);
+
+        // overlays provide files not present in the base location
+        CHECK(yg::file::mount(yg::file::getAssetFilePath("img.zip"), "p//") == 0);
+        CHECK(yg::file::readFile("p//img_32_16_3.png", data) == 0);
+        CHECK(data == data_3);
+
+        CHECK(yg::file::mount(yg::file::getAssetFilePath(), "p//") == 0);
+        CHECK(yg::file::readFile("p//img_32_16_4.png", data) == 0);
+        CHECK(data == data_4);
+
+        // files added to a directory overlay later are found
+        const std::string newPath = yg::file::getAssetFilePath("overlay_new.bin");
+        CHECK(yg::file::readFile("p//overlay_new.bin", data) != 0);
+        std::FILE *f = std::fopen(newPath.c_str(), "wb");
+        REQUIRE(f != nullptr);
+        std::fwrite(data_3.data(), 1, data_3.size(), f);
+        std::fclose(f);
+        CHECK(yg::file::readFile("p//overlay_new.bin", data) == 0);
+        CHECK(data == data_3);
+        std::remove(newPath.c_str());
+
+        // overlays are kept when the project path changes
+        yg::file::setProjectPath(yg::file::getAssetFilePath("does_not_exist/"));
+        CHECK(yg::file::readFile("p//img_32_16_4.png", data) == 0);
+
+        CHECK(yg::file::unmount(yg::file::getAssetFilePath(), "p//") == 0);
+        CHECK(yg::file::unmount(yg::file::getAssetFilePath("img.zip"), "p//") == 0);
+        CHECK(yg::file::unmount(yg::file::getAssetFilePath("img.zip"), "p//") != 0);
+        CHECK(yg::file::readFile("p//img_32_16_3.png", data) != 0);
+
+        CHECK(yg::file::mount(yg::file::getAssetFilePath(), "x//") != 0);
+
+        yg::file::setProjectPath(yg::file::getAssetFilePath());
+    }
 }
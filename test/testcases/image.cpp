@@ -151,6 +151,33 @@ TEST_CASE("Image")
         CHECK(img->getData()[15] == imageDataAlpha[15]);
     }
 
+    SUBCASE("premultiplyAlpha_allValues")
+    {
+        // every color value with every alpha value, like the reference (c * alpha) / 255
+        std::vector<uint8_t> data(256 * 256 * 4);
+        for (int a = 0; a < 256; a++)
+        {
+            for (int c = 0; c < 256; c++)
+            {
+                uint8_t *px = &data[(a * 256 + c) * 4];
+                px[0] = (uint8_t)c;
+                px[1] = (uint8_t)(255 - c);
+                px[2] = (uint8_t)c;
+                px[3] = (uint8_t)a;
+            }
+        }
+
+        yg::util::Image *img = yg::util::Image::fromMemoryRaw(data.data(), 256, 256);
+        img->premultiplyAlpha();
+
+        for (size_t i = 0; i < data.size(); i += 4)
+        {
+            CHECK(img->getData()[i] == data[i] * data[i + 3] / 255);
+            CHECK(img->getData()[i + 1] == data[i + 1] * data[i + 3] / 255);
+            CHECK(img->getData()[i + 3] == data[i + 3]);
+        }
+    }
+
     SUBCASE("updateRaw")
     {
         yg::util::Image *img = yg::util::Image::fromEmpty(4, 8);
@@ -0,0 +1,516 @@
+/*
+Copyright (c) 2019-2024 Alexander Scholz
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "doctest.h"
+#include "yourgame/yourgame.h"
+#include "yourgame/gl/loading.h"
+
+namespace yg = yourgame; // convenience
+
+TEST_CASE("loading")
+{
+    // quad of two triangles, sharing two vertices
+    const std::string quadObj = "v 0 0 0\nv 1 0 0\nv 1 2 0\nv 0 2 -1\n"
+                                "vn 0 0 1\n"
+                                "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+                                "f 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n";
+
+    yg::file::setProjectPath(yg::file::getAssetFilePath());
+    CHECK(yg::file::writeFile("p//quad.obj", quadObj.data(), quadObj.size()) == 0);
+
+    SUBCASE("loadMeshData_obj")
+    {
+        yg::gl::MeshData mesh;
+        CHECK(yg::gl::loadMeshData("p//quad.obj", "", mesh) == 0);
+
+        // interleaved position, color, normal, texcoords
+        int vertBuf = mesh.findBuffer("vertices");
+        int idxBuf = mesh.findBuffer("idx");
+        CHECK(vertBuf >= 0);
+        CHECK(idxBuf >= 0);
+        CHECK(mesh.buffers[vertBuf].data.size() == 4 * 11 * sizeof(float));
+        CHECK(mesh.buffers[idxBuf].data.size() == 6 * sizeof(uint32_t));
+
+        CHECK(mesh.shapes.size() == 2);
+        CHECK(mesh.shapes[0].name == "main");
+        CHECK(mesh.shapes[0].indexBuffer == (size_t)idxBuf);
+        CHECK(mesh.shapes[0].elArDescr.numElements == 6);
+        CHECK(mesh.shapes[0].attribs.size() == 4);
+        for (const auto &attr : mesh.shapes[0].attribs)
+        {
+            CHECK(attr.buffer == (size_t)vertBuf);
+            CHECK(attr.descr.stride == 11 * sizeof(float));
+        }
+
+        CHECK(mesh.boundsMin[0] == 0.0f);
+        CHECK(mesh.boundsMin[2] == -1.0f);
+        CHECK(mesh.boundsMax[1] == 2.0f);
+
+        CHECK(yg::gl::loadMeshData("p//missing.obj", "", mesh) == -1);
+    }
+
+    SUBCASE("loadMeshData_cache_vs_obj")
+    {
+        CHECK(yg::gl::saveGeometryCache("p//quad.obj", "", "p//quad.ygmesh") == 0);
+
+        yg::gl::MeshData meshObj;
+        yg::gl::MeshData meshCache;
+        CHECK(yg::gl::loadMeshData("p//quad.obj", "", meshObj) == 0);
+        CHECK(yg::gl::loadMeshData("p//quad.ygmesh", "", meshCache) == 0);
+
+        CHECK(meshCache.buffers.size() == meshObj.buffers.size());
+        for (size_t i = 0; i < meshObj.buffers.size(); i++)
+        {
+            CHECK(meshCache.buffers[i].name == meshObj.buffers[i].name);
+            CHECK(meshCache.buffers[i].target == meshObj.buffers[i].target);
+            CHECK(meshCache.buffers[i].data == meshObj.buffers[i].data);
+        }
+
+        CHECK(meshCache.shapes.size() == meshObj.shapes.size());
+        for (size_t i = 0; i < meshObj.shapes.size(); i++)
+        {
+            CHECK(meshCache.shapes[i].name == meshObj.shapes[i].name);
+            CHECK(meshCache.shapes[i].indexBuffer == meshObj.shapes[i].indexBuffer);
+            CHECK(meshCache.shapes[i].elArDescr.numElements == meshObj.shapes[i].elArDescr.numElements);
+            CHECK(meshCache.shapes[i].attribs.size() == meshObj.shapes[i].attribs.size());
+            for (size_t a = 0; a < meshObj.shapes[i].attribs.size(); a++)
+            {
+                CHECK(meshCache.shapes[i].attribs[a].descr.index == meshObj.shapes[i].attribs[a].descr.index);
+                CHECK(meshCache.shapes[i].attribs[a].descr.pointer == meshObj.shapes[i].attribs[a].descr.pointer);
+            }
+        }
+        CHECK(std::memcmp(meshCache.boundsMax, meshObj.boundsMax, sizeof(meshObj.boundsMax)) == 0);
+
+        // truncated cache
+        std::vector<uint8_t> cacheData;
+        CHECK(yg::file::readFile("p//quad.ygmesh", cacheData) == 0);
+        CHECK(yg::file::writeFile("p//quad.ygmesh", cacheData.data(), 64) == 0);
+        CHECK(yg::gl::loadMeshData("p//quad.ygmesh", "", meshCache) == -2);
+
+        std::remove(yg::file::getProjectFilePath("quad.ygmesh").c_str());
+    }
+
+    SUBCASE("quantize")
+    {
+        yg::gl::MeshData mesh;
+        CHECK(yg::gl::loadMeshData("p//quad.obj", "", mesh) == 0);
+
+        yg::gl::MeshQuantization cfg;
+        cfg.positions = yg::gl::MeshQuantization::Positions::SNORM16;
+        cfg.normals = true;
+        cfg.colors = true;
+        cfg.texcoords = true;
+        cfg.indices = true;
+
+        // 44 -> 20 bytes per vertex (8 position, 4 color, 4 normal, 4 texcoords), 4 -> 2 bytes per index
+        CHECK(mesh.quantize(cfg) == 4 * (44 - 20) + 6 * (4 - 2));
+        CHECK(mesh.buffers[mesh.findBuffer("vertices")].data.size() == 4 * 20);
+        CHECK(mesh.buffers[mesh.findBuffer("idx")].data.size() == 6 * 2);
+        CHECK(mesh.shapes[0].elArDescr.type == GL_UNSIGNED_SHORT);
+        for (const auto &attr : mesh.shapes[0].attribs)
+        {
+            CHECK(attr.descr.stride == 20);
+            CHECK(attr.descr.normalized == GL_TRUE || attr.descr.type == GL_HALF_FLOAT);
+        }
+
+        // positions are mapped to [-1, 1] within the bounds
+        CHECK(mesh.positionOffset[0] == 0.5f);
+        CHECK(mesh.positionScale[1] == 1.0f);
+        CHECK(mesh.positionOffset[2] == -0.5f);
+        int16_t firstPos[3];
+        std::memcpy(firstPos, mesh.buffers[mesh.findBuffer("vertices")].data.data(), sizeof(firstPos));
+        CHECK(firstPos[0] == -32767);
+        CHECK(firstPos[1] == -32767);
+        CHECK(firstPos[2] == 32767);
+
+        // quantizing again does not change anything
+        CHECK(mesh.quantize(cfg) == 0);
+
+        // the dequantization is kept in the cache
+        CHECK(yg::gl::saveMeshData(mesh, "p//quad.ygmesh") == 0);
+        yg::gl::MeshData meshCache;
+        CHECK(yg::gl::loadMeshData("p//quad.ygmesh", "", meshCache) == 0);
+        CHECK(std::memcmp(meshCache.positionOffset, mesh.positionOffset, sizeof(mesh.positionOffset)) == 0);
+        CHECK(std::memcmp(meshCache.positionScale, mesh.positionScale, sizeof(mesh.positionScale)) == 0);
+        CHECK(meshCache.shapes[0].attribs[0].descr.type == GL_SHORT);
+        std::remove(yg::file::getProjectFilePath("quad.ygmesh").c_str());
+
+        // positions of a buffer skipped for its layout stay float, without dequantization
+        yg::gl::MeshData meshSkipped;
+        CHECK(yg::gl::loadMeshData("p//quad.obj", "", meshSkipped) == 0);
+        meshSkipped.buffers[meshSkipped.findBuffer("vertices")].data.push_back(0);
+        meshSkipped.quantize(cfg);
+        CHECK(meshSkipped.shapes[0].attribs[0].descr.type == GL_FLOAT);
+        CHECK(meshSkipped.positionOffset[0] == 0.0f);
+        CHECK(meshSkipped.positionScale[1] == 1.0f);
+    }
+
+    SUBCASE("optimize")
+    {
+        // grid of n x n quads, with the faces in a scrambled order
+        const int n = 32;
+        std::string gridObj;
+        for (int y = 0; y <= n; y++)
+        {
+            for (int x = 0; x <= n; x++)
+            {
+                gridObj += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+            }
+        }
+        for (int i = 0; i < n * n; i++)
+        {
+            int q = (i * 389) % (n * n); // 389 and n * n are coprime
+            int v0 = (q / n) * (n + 1) + (q % n) + 1;
+            gridObj += "f " + std::to_string(v0) + " " + std::to_string(v0 + 1) + " " + std::to_string(v0 + n + 2) + " " + std::to_string(v0 + n + 1) + "\n";
+        }
+        CHECK(yg::file::writeFile("p//grid.obj", gridObj.data(), gridObj.size()) == 0);
+
+        yg::gl::MeshData mesh;
+        CHECK(yg::gl::loadMeshData("p//grid.obj", "", mesh) == 0);
+        std::remove(yg::file::getProjectFilePath("grid.obj").c_str());
+
+        // triangles as position triples, to compare the geometry independent of the order
+        auto getTriangles = [](const yg::gl::MeshData &m)
+        {
+            const auto &vert = m.buffers[m.findBuffer("vertices")].data;
+            const auto &idx = m.buffers[m.findBuffer("idx")].data;
+            size_t stride = m.shapes[0].attribs[0].descr.stride;
+            std::vector<std::vector<float>> tris;
+            for (size_t i = 0; i + 12 <= idx.size(); i += 12)
+            {
+                std::vector<float> tri;
+                for (size_t c = 0; c < 3; c++)
+                {
+                    uint32_t v;
+                    std::memcpy(&v, idx.data() + i + c * 4, 4);
+                    float p[3];
+                    std::memcpy(p, vert.data() + v * stride, sizeof(p));
+                    tri.insert(tri.end(), p, p + 3);
+                }
+                tris.push_back(tri);
+            }
+            std::sort(tris.begin(), tris.end());
+            return tris;
+        };
+        auto trianglesBefore = getTriangles(mesh);
+
+        yg::gl::MeshOptimization cfg;
+        cfg.vertexCache = true;
+        cfg.vertexFetch = true;
+        auto stats = mesh.optimize(cfg);
+
+        CHECK(stats.numTriangles == 2 * n * n);
+        CHECK(stats.acmrBefore > 1.5f);
+        CHECK(stats.acmrAfter < 0.85f);
+        CHECK(getTriangles(mesh) == trianglesBefore);
+
+        // vertices are in order of first use
+        const auto &idx = mesh.buffers[mesh.findBuffer("idx")].data;
+        uint32_t maxIdx = 0;
+        for (size_t i = 0; i < idx.size(); i += 4)
+        {
+            uint32_t v;
+            std::memcpy(&v, idx.data() + i, 4);
+            CHECK(v <= maxIdx + 1);
+            maxIdx = std::max(maxIdx, v);
+        }
+
+        // overdraw sorting keeps most of the cache efficiency
+        cfg.overdraw = true;
+        auto statsOverdraw = mesh.optimize(cfg);
+        CHECK(statsOverdraw.acmrAfter < 1.0f);
+        CHECK(getTriangles(mesh) == trianglesBefore);
+    }
+
+    SUBCASE("generateLods")
+    {
+        // gently curved grid of n x n quads
+        const int n = 16;
+        std::string gridObj;
+        for (int y = 0; y <= n; y++)
+        {
+            for (int x = 0; x <= n; x++)
+            {
+                float z = 0.01f * (float)((x - n / 2) * (x - n / 2) + (y - n / 2) * (y - n / 2));
+                gridObj += "v " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z) + "\n";
+            }
+        }
+        for (int q = 0; q < n * n; q++)
+        {
+            int v0 = (q / n) * (n + 1) + (q % n) + 1;
+            gridObj += "f " + std::to_string(v0) + " " + std::to_string(v0 + 1) + " " + std::to_string(v0 + n + 2) + " " + std::to_string(v0 + n + 1) + "\n";
+        }
+        CHECK(yg::file::writeFile("p//grid.obj", gridObj.data(), gridObj.size()) == 0);
+
+        yg::gl::MeshData mesh;
+        CHECK(yg::gl::loadMeshData("p//grid.obj", "", mesh) == 0);
+        std::remove(yg::file::getProjectFilePath("grid.obj").c_str());
+
+        // the same mesh, scaled by 4 (exactly, power of two)
+        const float scale = 4.0f;
+        yg::gl::MeshData meshScaled = mesh;
+        for (const auto &attr : meshScaled.shapes[0].attribs)
+        {
+            if (attr.descr.index == yg::gl::attrLocPosition)
+            {
+                auto &data = meshScaled.buffers[attr.buffer].data;
+                size_t stride = attr.descr.stride ? (size_t)attr.descr.stride : 3 * sizeof(float);
+                for (size_t o = (size_t)attr.descr.pointer; o + 3 * sizeof(float) <= data.size(); o += stride)
+                {
+                    float p[3];
+                    std::memcpy(p, data.data() + o, sizeof(p));
+                    for (auto &c : p)
+                    {
+                        c *= scale;
+                    }
+                    std::memcpy(data.data() + o, p, sizeof(p));
+                }
+            }
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            meshScaled.boundsMin[c] *= scale;
+            meshScaled.boundsMax[c] *= scale;
+        }
+
+        yg::gl::MeshLodConfig cfg;
+        cfg.numLods = 3;
+        cfg.maxError = 0.1f;
+        mesh.generateLods(cfg, 32);
+        meshScaled.generateLods(cfg, 32);
+
+        const auto &shape = mesh.shapes[0];
+        CHECK(shape.lods.size() > 0);
+        CHECK(shape.lods.size() <= cfg.numLods);
+        CHECK(mesh.lodErrors.size() == shape.lods.size() + 1);
+        CHECK(mesh.lodErrors[0] == 0.0f);
+
+        // each level is smaller than the previous one, with a larger error within the limit
+        GLsizei prevNumElements = shape.elArDescr.numElements;
+        size_t numIndices = mesh.buffers[shape.indexBuffer].data.size() / 4;
+        for (size_t l = 0; l < shape.lods.size(); l++)
+        {
+            CHECK(shape.lods[l].numElements < prevNumElements);
+            CHECK(shape.lods[l].numElements % 3 == 0);
+            CHECK((size_t)(shape.lods[l].firstElement + shape.lods[l].numElements) <= numIndices);
+            CHECK(mesh.lodErrors[l + 1] >= mesh.lodErrors[l]);
+            CHECK(mesh.lodErrors[l + 1] <= cfg.maxError * 0.5f * std::sqrt(2.0f * n * n + 1.0f));
+            prevNumElements = shape.lods[l].numElements;
+        }
+
+        // the errors are distances: they scale linearly with the mesh
+        CHECK(meshScaled.shapes[0].lods.size() == shape.lods.size());
+        CHECK(meshScaled.lodErrors.size() == mesh.lodErrors.size());
+        for (size_t l = 0; l < std::min(meshScaled.lodErrors.size(), mesh.lodErrors.size()); l++)
+        {
+            CHECK(meshScaled.lodErrors[l] == doctest::Approx(scale * mesh.lodErrors[l]).epsilon(0.001));
+        }
+
+        // the levels are kept in the cache
+        CHECK(yg::gl::saveMeshData(mesh, "p//grid.ygmesh") == 0);
+        yg::gl::MeshData meshCache;
+        CHECK(yg::gl::loadMeshData("p//grid.ygmesh", "", meshCache) == 0);
+        CHECK(meshCache.lodErrors == mesh.lodErrors);
+        CHECK(meshCache.shapes[0].lods.size() == shape.lods.size());
+        for (size_t l = 0; l < shape.lods.size(); l++)
+        {
+            CHECK(meshCache.shapes[0].lods[l].firstElement == shape.lods[l].firstElement);
+            CHECK(meshCache.shapes[0].lods[l].numElements == shape.lods[l].numElements);
+        }
+        std::remove(yg::file::getProjectFilePath("grid.ygmesh").c_str());
+    }
+
+    SUBCASE("loadTextureData_ktx")
+    {
+        // KTX file: 8x4 ETC2 RGBA8, 2 levels (8x4: 2 blocks, 4x2: 1 block)
+        auto put32 = [](std::vector<uint8_t> &v, uint32_t x)
+        {
+            v.insert(v.end(), (uint8_t *)&x, (uint8_t *)&x + 4);
+        };
+        std::vector<uint8_t> ktx = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        for (uint32_t h : {0x04030201U, 0U, 1U, 0U, 0x9278U, 0x1908U, 8U, 4U, 0U, 0U, 1U, 2U, 4U})
+        {
+            put32(ktx, h);
+        }
+        put32(ktx, 0xFFFFFFFFU); // key/value data, skipped
+
+        // alpha: base 200, multiplier 0. color: individual mode, base colors (0x88, 0x44, 0x22)
+        // and (0xFF, 0x00, 0xFF), codeword 0. pixel indices 0 (+2) and 3 (-8)
+        const uint8_t block0[16] = {200, 0x00, 0, 0, 0, 0, 0, 0, 0x8F, 0x40, 0x2F, 0x00, 0x00, 0x00, 0x00, 0x00};
+        const uint8_t block1[16] = {200, 0x00, 0, 0, 0, 0, 0, 0, 0x8F, 0x40, 0x2F, 0x00, 0xFF, 0xFF, 0xFF, 0xFF};
+        put32(ktx, 32);
+        ktx.insert(ktx.end(), block0, block0 + 16);
+        ktx.insert(ktx.end(), block1, block1 + 16);
+        put32(ktx, 16);
+        ktx.insert(ktx.end(), block0, block0 + 16);
+        CHECK(yg::file::writeFile("p//tex.ktx", ktx.data(), ktx.size()) == 0);
+
+        yg::gl::TextureData data;
+        CHECK(yg::gl::loadTextureData("p//tex.ktx", data) == 0);
+        CHECK(data.target == GL_TEXTURE_2D);
+        CHECK(data.isCompressed());
+        CHECK(data.canDecompress());
+        CHECK(data.levels.size() == 2);
+        CHECK(data.levels[1].width == 4);
+        CHECK(data.levels[1].height == 2);
+        CHECK(data.getNumBytes() == 48);
+
+        // cpu fallback
+        CHECK(data.decompress());
+        CHECK(!data.isCompressed());
+        CHECK(data.internalFormat == GL_RGBA8);
+        CHECK(data.levels[0].faces[0].size() == 8 * 4 * 4);
+        CHECK(data.levels[1].faces[0].size() == 4 * 2 * 4);
+        const uint8_t *px = data.levels[0].faces[0].data();
+        CHECK(px[0] == 0x88 + 2);
+        CHECK(px[1] == 0x44 + 2);
+        CHECK(px[2] == 0x22 + 2);
+        CHECK(px[3] == 200);
+        px += 2 * 4; // right sub-block of block 0
+        CHECK(px[0] == 0xFF);
+        CHECK(px[1] == 0x00 + 2);
+        CHECK(px[2] == 0xFF);
+        px = data.levels[0].faces[0].data() + (8 * 3 + 4) * 4; // block 1, bottom left pixel
+        CHECK(px[0] == 0x88 - 8);
+        CHECK(px[1] == 0x44 - 8);
+        CHECK(px[3] == 200);
+
+        // truncated file
+        CHECK(yg::file::writeFile("p//tex.ktx", ktx.data(), ktx.size() - 1) == 0);
+        CHECK(yg::gl::loadTextureData("p//tex.ktx", data) == -2);
+        std::remove(yg::file::getProjectFilePath("tex.ktx").c_str());
+    }
+
+    SUBCASE("TextureData_decompress_bc")
+    {
+        // 4x4 DXT5: alpha 255 -> 0 (8 values), colors red and blue (4 colors)
+        yg::gl::TextureData data;
+        data.internalFormat = 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        data.format = 0;
+        data.type = 0;
+        data.levels.push_back({4, 4, {{255, 0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x04, 0x00, 0x00, 0x00}}});
+        data.levels[0].faces[0][2] = 0x01; // pixel 0: alpha index 1
+
+        CHECK(data.decompress());
+        const uint8_t *px = data.levels[0].faces[0].data();
+        CHECK(px[0] == 255); // red: index 0
+        CHECK(px[2] == 0);
+        CHECK(px[3] == 0); // alpha index 1
+        CHECK(px[4] == 0); // blue: index 1
+        CHECK(px[6] == 255);
+        CHECK(px[7] == 255); // alpha index 0
+        CHECK(px[4 * 4 + 0] == 255); // second row: index 0
+
+        // unknown formats are not decompressed
+        data = yg::gl::TextureData();
+        data.internalFormat = 0x93B0; // astc
+        data.type = 0;
+        CHECK(!data.canDecompress());
+        CHECK(!data.decompress());
+    }
+
+    SUBCASE("loadAtlasData_cache_vs_json")
+    {
+        // FTP "hash": a sequence (frames out of order, one rotated, one empty) and a single sprite
+        const std::string atlasJson = R"({"frames": {
+            "walk_2": {"frame": {"x": 20, "y": 0, "w": 10, "h": 12}, "rotated": false},
+            "walk_1": {"frame": {"x": 10, "y": 0, "w": 10, "h": 12}, "rotated": true},
+            "ship": {"frame": {"x": 0, "y": 16, "w": 32, "h": 16}, "rotated": false},
+            "walk_3": {"frame": {"x": 0, "y": 0, "w": 0, "h": 0}, "rotated": false},
+            "walk_0": {"frame": {"x": 0, "y": 0, "w": 10, "h": 12}, "rotated": false}}})";
+        CHECK(yg::file::writeFile("p//atlas.json", atlasJson.data(), atlasJson.size()) == 0);
+
+        yg::gl::AtlasData atlasJsonData;
+        CHECK(yg::gl::loadAtlasData("p//atlas.png", "p//atlas.json", atlasJsonData) == 0);
+        CHECK(atlasJsonData.frames.size() == 4);
+        CHECK(atlasJsonData.sequences.size() == 1);
+        const auto &seq = atlasJsonData.sequences[0];
+        CHECK(seq.name == "walk");
+        CHECK(seq.id == yg::AssetId("walk"));
+        CHECK(seq.frames.size() == 3);
+        for (int i = 0; i < 3; i++)
+        {
+            CHECK(seq.frames[i].first == i);
+            CHECK(atlasJsonData.frames[seq.frames[i].second].x == 10 * i);
+        }
+
+        CHECK(yg::gl::saveAtlasCache("p//atlas.png", "p//atlas.json", "p//atlas.ygatlas") == 0);
+        yg::gl::AtlasData atlasCache;
+        CHECK(yg::gl::loadAtlasData("p//atlas.png", "p//atlas.ygatlas", atlasCache) == 0);
+        CHECK(atlasCache.frames.size() == atlasJsonData.frames.size());
+        for (size_t i = 0; i < atlasJsonData.frames.size(); i++)
+        {
+            const auto &a = atlasCache.frames[i];
+            const auto &b = atlasJsonData.frames[i];
+            CHECK(a.id == b.id);
+            CHECK(a.x == b.x);
+            CHECK(a.y == b.y);
+            CHECK(a.width == b.width);
+            CHECK(a.height == b.height);
+            CHECK(a.cwRot == b.cwRot);
+        }
+        CHECK(atlasCache.sequences.size() == 1);
+        CHECK(atlasCache.sequences[0].name == "walk");
+        CHECK(atlasCache.sequences[0].id == yg::AssetId("walk"));
+        CHECK(atlasCache.sequences[0].frames == seq.frames);
+
+        // truncated cache
+        std::vector<uint8_t> cacheData;
+        CHECK(yg::file::readFile("p//atlas.ygatlas", cacheData) == 0);
+        CHECK(yg::file::writeFile("p//atlas.ygatlas", cacheData.data(), cacheData.size() - 1) == 0);
+        CHECK(yg::gl::loadAtlasData("p//atlas.png", "p//atlas.ygatlas", atlasCache) == -2);
+
+        CHECK(yg::gl::loadAtlasData("p//atlas.png", "p//missing.json", atlasCache) == -1);
+
+        std::remove(yg::file::getProjectFilePath("atlas.json").c_str());
+        std::remove(yg::file::getProjectFilePath("atlas.ygatlas").c_str());
+    }
+
+    SUBCASE("loadShaderSource_include")
+    {
+        const std::string common = "float f();";  // no trailing newline
+        const std::string lib = "#include \"shd_common.glsl\"\nfloat g();\n";
+        const std::string main = "  #  include <shd_lib.glsl>\n#include \"p//shd_common.glsl\"\nvoid main() {}\n";
+        CHECK(yg::file::writeFile("p//shd_common.glsl", common.data(), common.size()) == 0);
+        CHECK(yg::file::writeFile("p//shd_lib.glsl", lib.data(), lib.size()) == 0);
+        CHECK(yg::file::writeFile("p//shd_main.frag", main.data(), main.size()) == 0);
+
+        // nested include, relative and prefixed path, common.glsl inserted once
+        std::string source;
+        CHECK(yg::gl::loadShaderSource("p//shd_main.frag", source) == 0);
+        CHECK(source == "float f();\nfloat g();\nvoid main() {}\n");
+
+        const std::string broken = "#include \"shd_missing.glsl\"\n";
+        CHECK(yg::file::writeFile("p//shd_main.frag", broken.data(), broken.size()) == 0);
+        CHECK(yg::gl::loadShaderSource("p//shd_main.frag", source) == -1);
+        CHECK(yg::gl::loadShaderSource("p//shd_missing.frag", source) == -1);
+
+        std::remove(yg::file::getProjectFilePath("shd_common.glsl").c_str());
+        std::remove(yg::file::getProjectFilePath("shd_lib.glsl").c_str());
+        std::remove(yg::file::getProjectFilePath("shd_main.frag").c_str());
+    }
+
+    std::remove(yg::file::getProjectFilePath("quad.obj").c_str());
+}